@@ -0,0 +1,76 @@
+# cmake -P script run by RENDER_BASICS_EMBED_SHADERS
+# ENTRIES is a | separated list of name:profile:entrypoint:path
+# writes OUTPUT, which includes HEADER, with the source and any BLOB_DIR/<name>.spv/.dxil as byte arrays
+
+function(EMBED_FILE varName path outContents)
+	file(READ ${path} Hex HEX)
+	string(LENGTH "${Hex}" HexLength)
+	math(EXPR Size "${HexLength} / 2")
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," Bytes "${Hex}")
+	# cmake regex has no {n}, build 16 bytes per line by hand
+	set(Line)
+	foreach (I RANGE 15)
+		string(APPEND Line "0x[0-9a-f][0-9a-f],")
+	endforeach ()
+	string(REGEX REPLACE "(${Line})" "\\1\n\t" Bytes "${Bytes}")
+	set(${outContents} "static uint8_t const ${varName}[] = {\n\t${Bytes}0x00\n};\nstatic size_t const ${varName}Size = ${Size};\n\n" PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "|" ";" Entries "${ENTRIES}")
+
+set(Arrays)
+set(Table)
+set(Count 0)
+foreach (Entry ${Entries})
+	# the path may contain : (windows drive letters) so only split the first three
+	string(REGEX MATCH "^([^:]+):([^:]+):([^:]+):(.*)$" Unused "${Entry}")
+	set(Name ${CMAKE_MATCH_1})
+	set(Profile ${CMAKE_MATCH_2})
+	set(EntryPoint ${CMAKE_MATCH_3})
+	set(Path ${CMAKE_MATCH_4})
+
+	if (Profile MATCHES "^vs_")
+		set(Type Render_ST_VERTEXSHADER)
+	elseif (Profile MATCHES "^ps_")
+		set(Type Render_ST_FRAGMENTSHADER)
+	else ()
+		set(Type Render_ST_COMPUTESHADER)
+	endif ()
+
+	EMBED_FILE(${Name}Source ${Path} Contents)
+	string(APPEND Arrays "${Contents}")
+	set(Spirv "nullptr, 0")
+	if (EXISTS ${BLOB_DIR}/${Name}.spv)
+		EMBED_FILE(${Name}Spirv ${BLOB_DIR}/${Name}.spv Contents)
+		string(APPEND Arrays "${Contents}")
+		set(Spirv "${Name}Spirv, ${Name}SpirvSize")
+	endif ()
+	set(Dxil "nullptr, 0")
+	if (EXISTS ${BLOB_DIR}/${Name}.dxil)
+		EMBED_FILE(${Name}Dxil ${BLOB_DIR}/${Name}.dxil Contents)
+		string(APPEND Arrays "${Contents}")
+		set(Dxil "${Name}Dxil, ${Name}DxilSize")
+	endif ()
+
+	string(APPEND Table "\t\t{\"${Name}\", \"${EntryPoint}\", ${Type},\n\t\t (char const *) ${Name}Source, ${Name}SourceSize,\n\t\t ${Spirv},\n\t\t ${Dxil}},\n")
+	math(EXPR Count "${Count} + 1")
+endforeach ()
+
+if (Count EQUAL 0)
+	set(Table "\t\t{nullptr, nullptr, Render_ST_VERTEXSHADER, nullptr, 0, nullptr, 0, nullptr, 0},\n")
+endif ()
+
+file(WRITE ${OUTPUT}.tmp
+"// generated by cmake/embedshaders.cmake, do not edit\n\
+#include \"al2o3_platform/platform.h\"\n\
+#include \"render_basics/theforge/api.h\"\n\
+#include \"${HEADER}\"\n\n\
+${Arrays}\
+RenderTF_EmbeddedShader const RenderTF_EmbeddedShaders[] = {\n\
+${Table}\
+};\n\
+uint32_t const RenderTF_EmbeddedShaderCount = ${Count};\n")
+
+# only touch the output if it changed to avoid needless rebuilds
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,75 @@
+# Build time shader compilation
+# every resources/*.hlsl is compiled with dxc to SPIR-V (and DXIL on Windows) and
+# embedded with its source in a generated cpp, which the runtime loads directly
+# instead of running the shader compiler.
+# Stage and entry point come from the file name:
+#   *_vertex.hlsl VS_main, *_fragment.hlsl FS_main, *_compute.hlsl CS_main
+# Without dxc (or on Apple, where shaders go through the source path) only the
+# source is embedded and is compiled at runtime as before.
+
+find_program(DXC_EXECUTABLE dxc HINTS $ENV{VULKAN_SDK}/bin)
+set(RENDER_BASICS_CMAKE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# outSrc is set to the generated cpp, which includes header (the runtime's declarations)
+function(RENDER_BASICS_EMBED_SHADERS outSrc resourceDir header)
+	file(GLOB Shaders CONFIGURE_DEPENDS ${resourceDir}/*.hlsl)
+	set(OutDir ${CMAKE_CURRENT_BINARY_DIR}/shaders)
+	set(Generated ${OutDir}/embeddedshaders.cpp)
+	file(MAKE_DIRECTORY ${OutDir})
+
+	set(UseDxc FALSE)
+	if (DXC_EXECUTABLE AND NOT APPLE)
+		set(UseDxc TRUE)
+	endif ()
+
+	set(Blobs)
+	set(Entries)
+	foreach (Shader ${Shaders})
+		get_filename_component(Name ${Shader} NAME_WE)
+		if (Name MATCHES "_vertex$")
+			set(Profile vs_6_0)
+			set(EntryPoint VS_main)
+		elseif (Name MATCHES "_fragment$")
+			set(Profile ps_6_0)
+			set(EntryPoint FS_main)
+		elseif (Name MATCHES "_compute$")
+			set(Profile cs_6_0)
+			set(EntryPoint CS_main)
+		else ()
+			message(WARNING "${Shader} doesn't end with _vertex, _fragment or _compute, skipped")
+			continue()
+		endif ()
+		list(APPEND Entries "${Name}:${Profile}:${EntryPoint}:${Shader}")
+
+		if (UseDxc)
+			add_custom_command(OUTPUT ${OutDir}/${Name}.spv
+					COMMAND ${DXC_EXECUTABLE} -nologo -spirv -fspv-target-env=vulkan1.1 -O3
+					-T ${Profile} -E ${EntryPoint} -Fo ${OutDir}/${Name}.spv ${Shader}
+					DEPENDS ${Shader}
+					COMMENT "Compiling ${Name} to SPIR-V"
+					VERBATIM)
+			list(APPEND Blobs ${OutDir}/${Name}.spv)
+			if (WIN32)
+				add_custom_command(OUTPUT ${OutDir}/${Name}.dxil
+						COMMAND ${DXC_EXECUTABLE} -nologo -O3
+						-T ${Profile} -E ${EntryPoint} -Fo ${OutDir}/${Name}.dxil ${Shader}
+						DEPENDS ${Shader}
+						COMMENT "Compiling ${Name} to DXIL"
+						VERBATIM)
+				list(APPEND Blobs ${OutDir}/${Name}.dxil)
+			endif ()
+		endif ()
+	endforeach ()
+
+	# lists can't pass through a custom command, use | instead of ;
+	string(REPLACE ";" "|" EntryArg "${Entries}")
+	add_custom_command(OUTPUT ${Generated}
+			COMMAND ${CMAKE_COMMAND} -DENTRIES=${EntryArg} -DBLOB_DIR=${OutDir} -DOUTPUT=${Generated} -DHEADER=${header}
+			-P ${RENDER_BASICS_CMAKE_DIR}/embedshaders.cmake
+			DEPENDS ${Shaders} ${Blobs} ${header} ${RENDER_BASICS_CMAKE_DIR}/embedshaders.cmake
+			COMMENT "Embedding shaders"
+			VERBATIM)
+	add_custom_target(${PROJECT_NAME}_shaders DEPENDS ${Generated})
+
+	set(${outSrc} ${Generated} PARENT_SCOPE)
+endfunction()
@@ -3,26 +3,38 @@
 #include "al2o3_platform/platform.h"
 #include "gfx_theforge/theforge.h"
 #include "gfx_shadercompiler/compiler.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_cadt/dictu64.h"
+#include "al2o3_cadt/vector.h"
 
 #define Render_VertexLayout TheForge_VertexLayout
 #include "render_basics/api.h"
 #include "render_basics/shader.h"
 #include "render_basics/view.h"
+#include "render_basics/theforge/shader.h"
+#include "render_basics/theforge/framepacing.h"
+#include "render_basics/theforge/throttle.h"
 
 typedef struct Render_FrameBuffer {
 	Render_RendererHandle renderer;
 
-	void *platformHandle;                ///< platform specific for the window/display (HWND etc.)
+	void *platformHandle;                ///< platform specific for the window/display (HWND etc.), null if headless
 	TheForge_CmdPoolHandle commandPool;
 	Render_QueueHandle presentQueue;
-	uint32_t frameBufferCount;
+	uint32_t frameBufferCount;           ///< frames in flight, per frame objects below are this many
+	uint64_t rendererFrame;              ///< renderer frame count when this frame buffer last started a frame
+	uint32_t swapChainImageCount;
+	uint32_t imageIndex;                 ///< current swap chain image
 	TinyImageFormat colourBufferFormat;
 
 	TheForge_SwapChainHandle swapChain;
 	TheForge_FenceHandle *renderCompleteFences;
-	TheForge_SemaphoreHandle imageAcquiredSemaphore;
+	TheForge_FenceHandle *slotFences;    ///< what the last submit of each slot signalled, own or the renderers batch fence
+	TheForge_SemaphoreHandle *imageAcquiredSemaphores;
 	TheForge_SemaphoreHandle *renderCompleteSemaphores;
 	TheForge_CmdHandle *frameCmds;
+	struct RenderTF_GpuTimer **frameTimers;
+	struct RenderTF_Headless *headless;  ///< offscreen targets and readback, replaces the swap chain
 
 	Math_Vec4F entireViewport;
 	Math_Vec4U32 entireScissor;
@@ -30,22 +42,74 @@ typedef struct Render_FrameBuffer {
 	struct ImguiBindings_Context *imguiBindings;
 
 	struct RenderTF_VisualDebug *visualDebug;
-	struct Render_GpuView *debugGpuView;
+
+	// late latched view, copied into this frames slot of the mapped buffer just before submit
+	struct Render_GpuView *latchedView;
+	Render_BufferHandle viewConstants;
+	uint8_t *viewConstantsData;
+
+	struct RenderTF_DynamicResolution *dynamicResolution;
+	struct RenderTF_Recorder *recorder;
 
 	// current (this frame) data
 	Render_TextureHandle currentColourTarget;
+	TheForge_RenderTargetHandle outputRenderTarget;  ///< swap chain image or headless target
+	bool scaledRendering;                            ///< currentColourTarget is the dynamic resolution target
+	bool imageAcquirePending;                        ///< output not acquired yet, see RenderTF_FrameBufferAcquireImage
 	Render_GraphicsEncoderHandle graphicsEncoder;
 
+	// async compute dependencies
+	TheForge_SemaphoreHandle computeSignalSemaphore; ///< signalled by Present for a compute submit to wait on
+	bool signalCompute;                              ///< next Present signals computeSignalSemaphore
+	bool computeSignalPending;                       ///< signalled and not yet waited on
+	uint32_t computeWaitCount;
+	TheForge_SemaphoreHandle computeWaits[8];        ///< compute submits the next Present waits for
+
+	// resizes are coalesced and applied by the next NewFrame
+	bool resizePending;
+	uint32_t pendingWidth;
+	uint32_t pendingHeight;
+	CADT_VectorHandle retiredHeadlessTargets; ///< replaced headless targets, removed once in flight frames finish
+	Render_TextureHandle *standInTargets;     ///< drawn to while a window has no swap chain, never presented
+
+	// throttling
+	Render_FrameBufferThrottleDesc throttle;
+	bool focused;
+	bool minimised;
+	bool dirty;                          ///< marked by the app, cleared by NewFrame
+	bool vsync;                          ///< the swap chain presents with vsync
+	bool pendingVsync;                   ///< applied with the next resize
+	uint64_t seenResourceUpdateCount;    ///< the renderers count as of the last Present
+	double lastRenderMs;
+
+	// cpu frame timing
+	double frameStartMs;
+	Render_FrameTimingStats timing;
+	Render_FrameTimingStats averageTiming;
+
 } Render_FrameBuffer;
 
 typedef struct Render_BlendState {
 	TheForge_BlendStateHandle state;
+	uint64_t hash;
+	uint32_t refCount;
+	TheForge_BlendStateDesc desc; ///< interning key
 } Render_BlendState;
 
 typedef struct Render_BlitEncoder {
+	Render_RendererHandle renderer;
 	TheForge_CmdPoolHandle cmdPool;
 
 	TheForge_CmdHandle cmd;
+	TheForge_FenceHandle completeFence;
+	bool submitted;
+	struct RenderTF_GpuTimer *timer;
+
+	// cpu written source data for fills
+	TheForge_BufferHandle scratch;
+	uint8_t *scratchData;
+	uint64_t scratchUsed;
+	CADT_VectorHandle retiredScratch; ///< full scratch buffers, released once the fence passes
 } Render_BlitEncoder;
 
 typedef struct Render_Buffer {
@@ -57,17 +121,26 @@ typedef struct Render_Buffer {
 } Render_Buffer;
 
 typedef struct Render_ComputeEncoder {
+	Render_RendererHandle renderer;
 	TheForge_CmdPoolHandle cmdPool;
 
 	TheForge_CmdHandle cmd;
+	TheForge_FenceHandle completeFence;
+	TheForge_SemaphoreHandle completeSemaphore; ///< only signalled when a frame buffer waits on it
+	bool submitted;
+	struct RenderTF_GpuTimer *timer;
 } Render_ComputeEncoder;
 
 typedef struct Render_DepthState {
 	TheForge_DepthStateHandle state;
+	uint64_t hash;
+	uint32_t refCount;
+	TheForge_DepthStateDesc desc; ///< interning key
 } Render_DepthState;
 
 typedef struct Render_DescriptorSet {
 	Render_RendererHandle renderer;
+	Render_RootSignatureHandle rootSignature;
 	TheForge_DescriptorSetHandle descriptorSet;
 	TheForge_DescriptorUpdateFrequency frequency;
 	uint32_t maxSetsPerFrame;
@@ -75,8 +148,17 @@ typedef struct Render_DescriptorSet {
 } Render_DescriptorSet;
 
 typedef struct Render_GraphicsEncoder {
+	Render_RendererHandle renderer;
 	TheForge_CmdHandle cmd;
 	Render_View view;
+	bool skipDraws; ///< bound pipeline isn't ready and has no fallback
+	struct RenderTF_GpuTimer *timer; ///< the frame buffers swaps per frame
+
+	// open render pass, binding the same targets again without a clear keeps it open
+	uint32_t boundColourCount;
+	TheForge_RenderTargetHandle boundColour[16];
+	TheForge_RenderTargetHandle boundDepth;
+	TheForge_RenderTargetHandle pendingClear; ///< cleared by the first bind that includes it
 } Render_GraphicsEncoder;
 
 typedef struct Render_Queue {
@@ -85,18 +167,33 @@ typedef struct Render_Queue {
 
 typedef struct Render_Pipeline {
 	TheForge_PipelineHandle pipeline;
+
+	// async creation, job is null once the pipeline has been compiled
+	struct RenderTF_PipelineJob *job;
+	Render_PipelineHandle fallback;
 } Render_Pipeline;
 
 typedef struct Render_RasteriserState {
 	TheForge_RasterizerStateHandle state;
+	uint64_t hash;
+	uint32_t refCount;
+	TheForge_RasterizerStateDesc desc; ///< interning key
 } Render_RasteriserState;
 
 typedef struct Render_RootSignature {
 	TheForge_RootSignatureHandle signature;
+	uint64_t hash;
+
+	Render_ShaderReflection reflection;
+	// resolved at creation, parallel to reflection.bindings
+	uint32_t descriptorIndices[RENDER_SHADER_REFLECTION_MAX_BINDINGS];
 } Render_RootSignature;
 
 typedef struct Render_Sampler {
 	TheForge_SamplerHandle sampler;
+	uint64_t hash;
+	uint32_t refCount;
+	TheForge_SamplerDesc desc; ///< interning key
 } Render_Sampler;
 
 typedef struct Render_ShaderObject {
@@ -104,15 +201,40 @@ typedef struct Render_ShaderObject {
 	ShaderCompiler_Output output;
 	char name[64];
 	char entryPoint[64];
+	uint64_t hash;
 } Render_ShaderObject;
 
 typedef struct Render_Shader {
 	TheForge_ShaderHandle shader;
+	uint64_t hash;
+	Render_ShaderReflection reflection;
 } Render_Shader;
 
+typedef struct Render_ShaderPermutationSet {
+	Render_RendererHandle renderer;
+	Render_ShaderObjectDesc objectDesc;
+	char name[64];
+	char entryPoint[64];
+
+	char *source;
+	size_t sourceSize;
+	uint64_t sourceHash;
+
+	uint32_t defineCount;
+	struct {
+		char name[64];
+		uint32_t shift;
+		uint64_t mask;
+	} defines[32];
+
+	CADT_DictU64Handle permutations; ///< key -> shader object this set holds a reference to
+} Render_ShaderPermutationSet;
+
 typedef struct Render_Texture {
+	Render_RendererHandle renderer;
 	TheForge_TextureHandle texture;
 	TheForge_RenderTargetHandle	renderTarget;
+	Render_FrameBufferHandle frameBuffer; ///< set on a frame buffers colour target, null until its image is acquired
 } Render_Texture;
 
 typedef struct Render_Renderer {
@@ -128,7 +250,10 @@ typedef struct Render_Renderer {
 	TheForge_CmdPoolHandle computeCmdPool;
 	TheForge_CmdPoolHandle blitCmdPool;
 
+	TheForge_CommandSignatureHandle dispatchCommandSignature;
+
 	ShaderCompiler_ContextHandle shaderCompiler;
+	Thread_Mutex shaderCompilerMutex; ///< the compiler isn't thread safe, held for each compile
 
 	Render_BlendStateHandle stockBlendState[Render_SBS_COUNT];
 	Render_DepthStateHandle stockDepthState[Render_SDS_COUNT];
@@ -136,8 +261,23 @@ typedef struct Render_Renderer {
 	Render_SamplerHandle stockSamplers[Render_SST_COUNT];
 	Render_VertexLayout const *stockVertexLayouts[Render_SVL_COUNT];
 
-	uint32_t maxFramesAhead;
-	uint32_t frameIndex;
+	struct RenderTF_PipelineCache *pipelineCache;
+	struct RenderTF_StateCache *stateCache;
+	struct RenderTF_PipelineCompiler *pipelineCompiler; ///< created on first async pipeline
+	struct RenderTF_ShaderPermutationCache *shaderPermutationCache;
+	struct RenderTF_Readback *readback;
+	struct RenderTF_TexturePool *texturePool;
+	struct RenderTF_GpuProfiler *gpuProfiler;
+
+	uint32_t maxFramesAhead;       ///< frames in flight, sizes every per frame resource
+	uint32_t swapChainImageCount;  ///< default for frame buffers
+	bool lowLatency;               ///< NewFrame waits for the previous frame
+	uint32_t frameIndex;           ///< frame in flight slot, < maxFramesAhead
+	uint64_t frameCount; ///< incremented every frame index change, once per renderer frame
+	uint64_t resourceUpdateCount; ///< texture and non frequently updated buffer uploads, for throttling
+	TheForge_FenceHandle frameFences[RENDER_MAX_FRAMES_IN_FLIGHT]; ///< batched frame buffer submits
+	TheForge_FenceHandle frameIndexFences[RENDER_MAX_FRAMES_IN_FLIGHT]; ///< last frame submit of each frame index, any frame buffer
+	struct Render_Fence *submitFence; ///< signalled by Render_QueueSubmit when the caller doesn't signal anything
 
 } Render_Renderer;
 
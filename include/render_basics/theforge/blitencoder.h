@@ -0,0 +1,74 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Blit encoder
+// copies recorded on the renderers copy command pool and submitted to the copy queue
+// so streaming and defragmentation don't occupy the graphics queue.
+// Usage: Begin, record copies, Submit then poll/wait for completion before reading
+// the destination on another queue. Begin waits if the previous submit is still running.
+// Buffer offsets are relative to the current frame for frequently updated buffers
+
+// a single mip level of a single array slice, TheForge copies whole subresources
+typedef struct Render_TextureSubresource {
+	uint32_t mipLevel;
+	uint32_t slice;
+} Render_TextureSubresource;
+
+// layout of texel data in a buffer, pitches of 0 mean tightly packed
+typedef struct Render_BufferTexelLayout {
+	uint64_t offset;
+	uint32_t rowPitch;
+	uint32_t slicePitch;
+} Render_BufferTexelLayout;
+
+AL2O3_EXTERN_C void Render_BlitEncoderBegin(Render_BlitEncoderHandle handle);
+
+AL2O3_EXTERN_C void Render_BlitEncoderCopyBuffer(Render_BlitEncoderHandle handle,
+																								 Render_BufferHandle dst,
+																								 uint64_t dstOffset,
+																								 Render_BufferHandle src,
+																								 uint64_t srcOffset,
+																								 uint64_t size);
+AL2O3_EXTERN_C void Render_BlitEncoderCopyBufferToTexture(Render_BlitEncoderHandle handle,
+																													Render_TextureHandle dst,
+																													Render_TextureSubresource dstSubresource,
+																													Render_BufferHandle src,
+																													Render_BufferTexelLayout srcLayout);
+AL2O3_EXTERN_C void Render_BlitEncoderCopyTextureToBuffer(Render_BlitEncoderHandle handle,
+																													Render_BufferHandle dst,
+																													Render_BufferTexelLayout dstLayout,
+																													Render_TextureHandle src,
+																													Render_TextureSubresource srcSubresource);
+// source and destination must have the same format and subresource dimensions
+AL2O3_EXTERN_C void Render_BlitEncoderCopyTexture(Render_BlitEncoderHandle handle,
+																									Render_TextureHandle dst,
+																									Render_TextureSubresource dstSubresource,
+																									Render_TextureHandle src,
+																									Render_TextureSubresource srcSubresource);
+
+// fills size bytes (a multiple of 4) with the repeated 32 bit value
+AL2O3_EXTERN_C void Render_BlitEncoderFillBuffer(Render_BlitEncoderHandle handle,
+																								 Render_BufferHandle dst,
+																								 uint64_t dstOffset,
+																								 uint64_t size,
+																								 uint32_t value);
+AL2O3_EXTERN_C void Render_BlitEncoderClearBuffer(Render_BlitEncoderHandle handle,
+																									Render_BufferHandle dst,
+																									uint64_t dstOffset,
+																									uint64_t size);
+
+AL2O3_EXTERN_C void Render_BlitEncoderTransition(Render_BlitEncoderHandle handle,
+																								 uint32_t numBuffers,
+																								 Render_BufferHandle const *buffers,
+																								 Render_BufferTransitionType const *bufferTransitions,
+																								 uint32_t numTextures,
+																								 Render_TextureHandle const *textures,
+																								 Render_TextureTransitionType const *textureTransitions);
+
+// ends recording and submits to the copy queue with the encoders fence
+AL2O3_EXTERN_C void Render_BlitEncoderSubmit(Render_BlitEncoderHandle handle);
+// true once the last submit has finished on the gpu (or nothing was submitted)
+AL2O3_EXTERN_C bool Render_BlitEncoderIsComplete(Render_BlitEncoderHandle handle);
+AL2O3_EXTERN_C void Render_BlitEncoderWait(Render_BlitEncoderHandle handle);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Compute encoder
+// records on the renderers compute command pool and submits to the compute queue,
+// so work submitted here can overlap the graphics queue (async compute).
+// Usage per frame: Begin, record, Submit. Begin waits if the previous submit of this
+// encoder is still executing, use one encoder per frame in flight to avoid stalling.
+// Cross queue dependencies are against a frame buffers graphics submit (Present)
+
+// waits for this encoders previous submit then starts recording
+AL2O3_EXTERN_C void Render_ComputeEncoderBegin(Render_ComputeEncoderHandle handle);
+
+AL2O3_EXTERN_C void Render_ComputeEncoderBindPipeline(Render_ComputeEncoderHandle handle,
+																											Render_PipelineHandle pipeline);
+AL2O3_EXTERN_C void Render_ComputeEncoderBindDescriptorSet(Render_ComputeEncoderHandle handle,
+																													 Render_DescriptorSetHandle set,
+																													 uint32_t setIndex);
+// name is the push/root constant block name in the shader
+AL2O3_EXTERN_C void Render_ComputeEncoderPushConstants(Render_ComputeEncoderHandle handle,
+																											 Render_RootSignatureHandle rootSignature,
+																											 char const *name,
+																											 void const *data);
+
+// group counts, not thread counts
+AL2O3_EXTERN_C void Render_ComputeEncoderDispatch(Render_ComputeEncoderHandle handle,
+																									uint32_t groupCountX,
+																									uint32_t groupCountY,
+																									uint32_t groupCountZ);
+// buffer holds 3 uint32_t group counts at offset, transition it to Render_BTT_INDIRECT_ARGUMENT first
+AL2O3_EXTERN_C void Render_ComputeEncoderDispatchIndirect(Render_ComputeEncoderHandle handle,
+																													Render_BufferHandle buffer,
+																													uint64_t offset);
+
+AL2O3_EXTERN_C void Render_ComputeEncoderTransition(Render_ComputeEncoderHandle handle,
+																										uint32_t numBuffers,
+																										Render_BufferHandle const *buffers,
+																										Render_BufferTransitionType const *bufferTransitions,
+																										uint32_t numTextures,
+																										Render_TextureHandle const *textures,
+																										Render_TextureTransitionType const *textureTransitions);
+
+// ends recording and submits to the compute queue.
+// waitFor (if valid) makes this work wait for the frame buffers last graphics submit,
+// Render_FrameBufferSignalCompute must have been called before that Present.
+// signal (if valid) makes the frame buffers next graphics submit wait for this work
+AL2O3_EXTERN_C void Render_ComputeEncoderSubmit(Render_ComputeEncoderHandle handle,
+																								Render_FrameBufferHandle waitFor,
+																								Render_FrameBufferHandle signal);
+
+// the next Present of the frame buffer also signals the semaphore a compute submit
+// waiting for it consumes, call before Present when compute reads the frames results
+AL2O3_EXTERN_C void Render_FrameBufferSignalCompute(Render_FrameBufferHandle handle);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Dynamic resolution
+// when enabled the frame buffers colour target is an internal target and scene passes
+// render into its top left, scaled by the controller to keep the frame buffers gpu
+// time near the budget. Present upscales it to the swap chain image before visual
+// debug and imgui draw at full size. Until then the entire viewport and scissor are
+// the scaled rect, so passes that use them need no changes.
+// Enable and disable between frames, disable waits for the frames in flight
+
+typedef struct Render_DynamicResolutionDesc {
+	double targetGpuMs;   ///< gpu time budget for the frame buffers command buffer
+	float minScale;       ///< 0 = 0.5
+	float maxScale;       ///< 0 = 1, can't be above 1
+} Render_DynamicResolutionDesc;
+
+// enabling again just changes the desc
+AL2O3_EXTERN_C bool Render_FrameBufferEnableDynamicResolution(Render_FrameBufferHandle handle,
+																															Render_DynamicResolutionDesc const *desc);
+AL2O3_EXTERN_C void Render_FrameBufferDisableDynamicResolution(Render_FrameBufferHandle handle);
+// 1 when disabled
+AL2O3_EXTERN_C float Render_FrameBufferGetResolutionScale(Render_FrameBufferHandle handle);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/texture.h"
+
+// Frame graph
+// rebuilt every frame: declare resources and passes with the textures/buffers each
+// pass reads and writes, then Compile and Execute. Compile orders the passes by their
+// dependencies, culls passes whose results are never used (by a later pass, an output
+// or a pass with side effects), batches the transitions each pass needs before it and
+// lets transient textures with non overlapping lifetimes share one render target.
+// Transients only share with an identical desc (TheForge has no placed resources),
+// they are taken from the renderers transient texture pool (texturepool.h).
+// A write is assumed to replace the contents, declare a read as well to load them
+
+#define RENDER_FRAMEGRAPH_INVALID (~0u)
+
+typedef struct Render_FrameGraph *Render_FrameGraphHandle;
+typedef uint32_t Render_FrameGraphResource;
+typedef uint32_t Render_FrameGraphPass;
+
+typedef void (*Render_FrameGraphExecuteFunc)(Render_FrameGraphHandle graph,
+																						 Render_GraphicsEncoderHandle encoder,
+																						 void *userData);
+
+typedef enum Render_FrameGraphPassFlags {
+	Render_FGPF_NONE = 0,
+	Render_FGPF_SIDE_EFFECTS = 0x1, ///< never culled
+} Render_FrameGraphPassFlags;
+
+AL2O3_EXTERN_C Render_FrameGraphHandle Render_FrameGraphCreate(Render_RendererHandle renderer);
+AL2O3_EXTERN_C void Render_FrameGraphDestroy(Render_RendererHandle renderer, Render_FrameGraphHandle graph);
+
+// clears the passes and resources for a new frame, transient textures are kept for reuse
+AL2O3_EXTERN_C void Render_FrameGraphReset(Render_FrameGraphHandle graph);
+
+// currentState is what the resource is in now, output if the contents are used after the graph
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphImportTexture(Render_FrameGraphHandle graph,
+																																				Render_TextureHandle texture,
+																																				Render_TextureTransitionType currentState,
+																																				bool output);
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphImportBuffer(Render_FrameGraphHandle graph,
+																																			 Render_BufferHandle buffer,
+																																			 Render_BufferTransitionType currentState,
+																																			 bool output);
+// a texture that only lives for the graph, created (or reused) at compile
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphCreateTexture(Render_FrameGraphHandle graph,
+																																				Render_TextureCreateDesc const *desc);
+
+AL2O3_EXTERN_C Render_FrameGraphPass Render_FrameGraphAddPass(Render_FrameGraphHandle graph,
+																															char const *name,
+																															Render_FrameGraphExecuteFunc execute,
+																															void *userData,
+																															Render_FrameGraphPassFlags flags);
+AL2O3_EXTERN_C void Render_FrameGraphPassReadTexture(Render_FrameGraphHandle graph,
+																										 Render_FrameGraphPass pass,
+																										 Render_FrameGraphResource resource,
+																										 Render_TextureTransitionType state);
+AL2O3_EXTERN_C void Render_FrameGraphPassWriteTexture(Render_FrameGraphHandle graph,
+																											Render_FrameGraphPass pass,
+																											Render_FrameGraphResource resource,
+																											Render_TextureTransitionType state);
+AL2O3_EXTERN_C void Render_FrameGraphPassReadBuffer(Render_FrameGraphHandle graph,
+																										Render_FrameGraphPass pass,
+																										Render_FrameGraphResource resource,
+																										Render_BufferTransitionType state);
+AL2O3_EXTERN_C void Render_FrameGraphPassWriteBuffer(Render_FrameGraphHandle graph,
+																										 Render_FrameGraphPass pass,
+																										 Render_FrameGraphResource resource,
+																										 Render_BufferTransitionType state);
+
+// false if the graph can't be scheduled or a read/write named an invalid pass or resource
+AL2O3_EXTERN_C bool Render_FrameGraphCompile(Render_FrameGraphHandle graph);
+// records every live pass in order with its transitions onto the encoder
+AL2O3_EXTERN_C void Render_FrameGraphExecute(Render_FrameGraphHandle graph, Render_GraphicsEncoderHandle encoder);
+
+// valid after Compile, the transients texture changes between frames
+AL2O3_EXTERN_C Render_TextureHandle Render_FrameGraphGetTexture(Render_FrameGraphHandle graph,
+																																Render_FrameGraphResource resource);
+AL2O3_EXTERN_C Render_BufferHandle Render_FrameGraphGetBuffer(Render_FrameGraphHandle graph,
+																															Render_FrameGraphResource resource);
+AL2O3_EXTERN_C bool Render_FrameGraphIsPassCulled(Render_FrameGraphHandle graph, Render_FrameGraphPass pass);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Frame pacing
+// frames in flight is how many frames the cpu can record before waiting for the gpu,
+// it sizes every per frame resource (fences, command buffers, frequently updated
+// buffers, descriptor sets, readback slots). It's independent of the swap chain image
+// count. More frames favours throughput, fewer favours latency.
+// Low latency mode additionally waits in NewFrame for the previous frame to finish on
+// the gpu, so input sampled after NewFrame is at most a frame old when displayed
+
+#define RENDER_MAX_FRAMES_IN_FLIGHT 6
+
+typedef struct Render_RendererCreateDesc {
+	uint32_t framesInFlight;      ///< 0 = 2, max RENDER_MAX_FRAMES_IN_FLIGHT
+	uint32_t swapChainImageCount; ///< 0 = framesInFlight
+	bool lowLatency;
+} Render_RendererCreateDesc;
+
+// cpu time in milliseconds spent in the frame buffer per frame
+typedef struct Render_FrameTimingStats {
+	double waitMs;     ///< NewFrame waiting for the gpu (frames in flight or low latency)
+	double acquireMs;  ///< NewFrame acquiring the swap chain image
+	double submitMs;   ///< Present submitting the frame
+	double presentMs;  ///< Present queueing the image
+	double frameMs;    ///< NewFrame to NewFrame
+} Render_FrameTimingStats;
+
+// Render_RendererCreate is this with a null (default) desc
+AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreateWithDesc(InputBasic_ContextHandle input,
+																																	 Render_RendererCreateDesc const *desc);
+
+AL2O3_EXTERN_C uint32_t Render_RendererGetFramesInFlight(Render_RendererHandle renderer);
+AL2O3_EXTERN_C void Render_RendererSetLowLatency(Render_RendererHandle renderer, bool enable);
+AL2O3_EXTERN_C bool Render_RendererGetLowLatency(Render_RendererHandle renderer);
+
+// last is the most recent complete frame, average is smoothed over roughly 30 frames
+AL2O3_EXTERN_C void Render_FrameBufferGetTimingStats(Render_FrameBufferHandle handle,
+																										 Render_FrameTimingStats *last,
+																										 Render_FrameTimingStats *average);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// GPU profiler
+// timed regions are pairs of timestamp queries written into the encoders command
+// buffer, they nest and work on graphics, compute and blit encoders. Each command
+// buffer has its own query pool, reset when the encoder begins and resolved into a
+// mapped buffer when it's submitted. Results are collected when the command buffer
+// is next begun (so never stall) and are available a few frames later.
+// Regions on the graphics encoder shouldn't span a Submit/Present.
+// Copy queues without timestamp support report 0 for their regions.
+// Statistics scopes count the work the graphics pipeline does between Begin and End
+// (per pass vertex, primitive and fragment counts). They are resolved the same way
+// but can't nest and must begin and end with the same render targets bound
+
+#define RENDER_GPU_TIMED_REGION_NO_PARENT (~0u)
+
+typedef struct Render_GpuTimedRegion {
+	char name[32];
+	uint32_t parent;      ///< index in the same frames region array or NO_PARENT
+	uint32_t depth;
+	Render_QueueType queue;
+	double milliseconds;
+} Render_GpuTimedRegion;
+
+typedef struct Render_GpuPipelineStatistics {
+	char name[32];
+	uint64_t inputVertices;
+	uint64_t inputPrimitives;
+	uint64_t vertexShaderInvocations;
+	uint64_t clippingInvocations;    ///< primitives sent to the clipper
+	uint64_t clippingPrimitives;     ///< primitives that came out of it
+	uint64_t fragmentShaderInvocations;
+} Render_GpuPipelineStatistics;
+
+// name is copied (and truncated to 31 characters)
+AL2O3_EXTERN_C void Render_GraphicsEncoderBeginTimedRegion(Render_GraphicsEncoderHandle handle, char const *name);
+AL2O3_EXTERN_C void Render_GraphicsEncoderEndTimedRegion(Render_GraphicsEncoderHandle handle);
+AL2O3_EXTERN_C void Render_GraphicsEncoderBeginStatisticsScope(Render_GraphicsEncoderHandle handle, char const *name);
+AL2O3_EXTERN_C void Render_GraphicsEncoderEndStatisticsScope(Render_GraphicsEncoderHandle handle);
+AL2O3_EXTERN_C void Render_ComputeEncoderBeginTimedRegion(Render_ComputeEncoderHandle handle, char const *name);
+AL2O3_EXTERN_C void Render_ComputeEncoderEndTimedRegion(Render_ComputeEncoderHandle handle);
+AL2O3_EXTERN_C void Render_BlitEncoderBeginTimedRegion(Render_BlitEncoderHandle handle, char const *name);
+AL2O3_EXTERN_C void Render_BlitEncoderEndTimedRegion(Render_BlitEncoderHandle handle);
+
+// the regions of the most recent frame the gpu has finished (maxFramesAhead behind
+// the current one) in recording order, children after their parent. Valid until the
+// next frame. frame is the renderer frame count they were recorded in
+AL2O3_EXTERN_C uint32_t Render_RendererGetGpuTimings(Render_RendererHandle renderer,
+																										 uint64_t *frame,
+																										 Render_GpuTimedRegion const **regions);
+// the statistics scopes of the same frame as Render_RendererGetGpuTimings
+AL2O3_EXTERN_C uint32_t Render_RendererGetGpuPipelineStatistics(Render_RendererHandle renderer,
+																																uint64_t *frame,
+																																Render_GpuPipelineStatistics const **scopes);
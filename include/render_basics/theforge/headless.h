@@ -0,0 +1,25 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/theforge/readback.h"
+
+// Headless frame buffers
+// a frame buffer created with a null platformHandle has no window or swap chain, it
+// renders into a ring of swapChainImageCount offscreen colour targets instead. The
+// frame loop (NewFrame, encoders, Present) is unchanged, Present just submits.
+// With a readback callback set, Present also copies the colour target back to the
+// cpu and the callback is called from a later NewFrame once the copy has finished,
+// so rendering never waits for the readback. The data is only valid during the call
+
+typedef void (*Render_FrameBufferReadbackFunc)(Render_FrameBufferHandle handle,
+																							 uint64_t frame,
+																							 Render_ReadbackData const *data,
+																							 void *userData);
+
+AL2O3_EXTERN_C bool Render_FrameBufferIsHeadless(Render_FrameBufferHandle handle);
+
+// func may be null to stop reading back, frames already requested are dropped
+AL2O3_EXTERN_C void Render_FrameBufferSetReadbackCallback(Render_FrameBufferHandle handle,
+																													Render_FrameBufferReadbackFunc func,
+																													void *userData);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/view.h"
+
+// Late latched view constants
+// each frame buffer owns a small persistently mapped uniform buffer holding a
+// Render_GpuView per frame in flight. The latest view set (by Render_FrameBufferLatchView
+// or Render_SetFrameBufferDebugView) is copied into this frames slot as Present submits,
+// so a camera updated after the passes were recorded is still what the gpu sees and
+// nothing needs recording again. Visual debug reads its view from here.
+
+AL2O3_EXTERN_C void Render_FrameBufferLatchView(Render_FrameBufferHandle handle, Render_GpuView const *view);
+
+// a frequently updated uniform buffer, bind it to per frame descriptor sets with
+// Render_DescriptorPresetFrequencyUpdated (offset 0, size sizeof(Render_GpuView))
+AL2O3_EXTERN_C Render_BufferHandle Render_FrameBufferViewConstants(Render_FrameBufferHandle handle);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Multiple frame buffers
+// renders several windows (and/or headless frame buffers) from one renderer as a single
+// frame. NewFrame advances the frame index once, waits for that slot and acquires every
+// frame buffers image. Present records each frame buffers overlays, submits all the
+// command buffers in one queue submit and then presents each swap chain.
+// The frame buffers must share a present queue, and a frame buffer shouldn't mix these
+// with Render_FrameBufferNewFrame/Present in the same frame.
+// Frame buffers using Render_FrameBufferNewFrame on their own still share one renderer
+// frame, the first of them to start a second frame advances the frame index
+
+AL2O3_EXTERN_C void Render_FrameBuffersNewFrame(Render_RendererHandle renderer,
+																								uint32_t count,
+																								Render_FrameBufferHandle const *frameBuffers);
+AL2O3_EXTERN_C void Render_FrameBuffersPresent(Render_RendererHandle renderer,
+																							 uint32_t count,
+																							 Render_FrameBufferHandle const *frameBuffers);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "al2o3_vfile/vfile.h"
+#include "render_basics/api.h"
+#include "render_basics/pipeline.h"
+
+// Pipeline usage manifest
+// every graphics and compute pipeline created is recorded by the hashes of the
+// shader and state objects it was built from. Saving the manifest and prewarming
+// it at the next startup (or a loading screen) moves the driver compile out of the
+// first frame that uses the pipeline.
+// Prewarming can only rebuild pipelines whose shaders, root signatures, states and
+// vertex layouts are alive at the time, entries that can't be resolved are skipped
+
+AL2O3_EXTERN_C bool Render_RendererSavePipelineManifest(Render_RendererHandle renderer, VFile_Handle file);
+
+// builds every resolvable pipeline in the manifest across worker threads, blocking the
+// caller until they are all done. The next Render_GraphicsPipelineCreate/
+// Render_ComputePipelineCreate with a matching desc returns the prewarmed pipeline
+// instead of compiling.
+// Entries are resolved to TheForge shaders, root signatures and states up front and
+// the workers use them without holding any lock, so no other thread may destroy a
+// shader, root signature or state until this returns.
+// returns the number of pipelines prewarmed
+AL2O3_EXTERN_C uint32_t Render_RendererPrewarmPipelines(Render_RendererHandle renderer, VFile_Handle manifest);
+
+// stock vertex layouts are registered automatically, custom static layouts need
+// registering before prewarming to be found
+AL2O3_EXTERN_C void Render_RendererRegisterVertexLayout(Render_RendererHandle renderer,
+																												Render_VertexLayoutHandle layout);
+
+// Asynchronous pipeline creation
+// returns immediately and compiles the pipeline on a background thread. Until it is
+// ready, binding it on a graphics encoder binds the fallback pipeline instead (if
+// valid and ready) else draws are skipped until a ready pipeline is bound.
+// The desc is copied, the vertex layout must outlive the compile as with the sync path.
+// The compile uses the TheForge objects behind the shader and root signature directly,
+// so they mustn't be destroyed until Render_PipelineIsReady has returned true (or the
+// pipeline has been destroyed, which cancels or waits for its compile)
+AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreateAsync(Render_RendererHandle renderer,
+																																				Render_GraphicsPipelineDesc const *desc,
+																																				Render_PipelineHandle fallback);
+
+// poll from the render thread, a pipeline that failed to compile never becomes ready
+AL2O3_EXTERN_C bool Render_PipelineIsReady(Render_PipelineHandle handle);
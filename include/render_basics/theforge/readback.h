@@ -0,0 +1,49 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/theforge/blitencoder.h"
+
+// Asynchronous GPU readback
+// a request records a copy into the current frames readback buffer (a ring with one
+// slot per frame in flight) on the given graphics encoder and returns a ticket.
+// The data becomes readable once the submit that carried it (frame buffer Present or
+// Render_QueueSubmit) has finished on the gpu, Poll never blocks. Data stays valid
+// until the frame slot is reused (maxFramesAhead renderer frames later), after which
+// the ticket is expired. A request whose submit hadn't finished by then is kept until
+// it has and for another maxFramesAhead frames, so it doesn't expire before it's ready.
+// Sources must be in the copy source state (Render_*_COPY_SOURCE) when recorded
+
+typedef struct Render_ReadbackTicket {
+	uint64_t frame;
+	uint32_t slot;
+	uint32_t index;
+} Render_ReadbackTicket;
+
+typedef enum Render_ReadbackStatus {
+	Render_RS_PENDING,
+	Render_RS_READY,
+	Render_RS_EXPIRED, ///< slot reused or invalid ticket, data is gone
+} Render_ReadbackStatus;
+
+typedef struct Render_ReadbackData {
+	void const *data;
+	uint64_t size;
+	uint32_t rowPitch;      ///< textures only, rows are padded to the copy alignment
+	uint32_t slicePitch;    ///< textures only
+} Render_ReadbackData;
+
+AL2O3_EXTERN_C Render_ReadbackTicket Render_ReadbackRequestBuffer(Render_RendererHandle renderer,
+																																	Render_GraphicsEncoderHandle encoder,
+																																	Render_BufferHandle buffer,
+																																	uint64_t offset,
+																																	uint64_t size);
+AL2O3_EXTERN_C Render_ReadbackTicket Render_ReadbackRequestTexture(Render_RendererHandle renderer,
+																																	 Render_GraphicsEncoderHandle encoder,
+																																	 Render_TextureHandle texture,
+																																	 Render_TextureSubresource subresource);
+
+// out is only filled in when Render_RS_READY is returned
+AL2O3_EXTERN_C Render_ReadbackStatus Render_ReadbackPoll(Render_RendererHandle renderer,
+																												 Render_ReadbackTicket ticket,
+																												 Render_ReadbackData *out);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Frame recorder
+// keeps the last N presented frames of a frame buffer in a fixed size memory mapped
+// ring file, cheap enough to leave running and look at after an incident. Recorded
+// frames are read back asynchronously (the same path as Render_ReadbackRequestTexture)
+// and, once the gpu is done with them, a worker thread downscales and writes them
+// to the ring straight from the readback buffer. The render thread never waits or
+// copies. If the worker falls behind frames are dropped rather than queued.
+// The ring file is always readable, a dump writes a copy with the frames oldest first
+
+#define RENDER_FRAMEBUFFER_RECORDER_MAGIC 0x46524252 // RBRF
+#define RENDER_FRAMEBUFFER_RECORDER_VERSION 1
+
+typedef struct Render_FrameBufferRecorderDesc {
+	char const *path;         ///< ring file, created or overwritten
+	uint64_t fileSize;        ///< the whole file, header and index included
+	uint32_t frameInterval;   ///< record every nth frame, 0 = every frame
+	uint32_t downscale;       ///< 0 or 1 = full size, n = 1/n width and height (nearest)
+} Render_FrameBufferRecorderDesc;
+
+// file layout: header, slotCount index entries, slotCount frames of frameSize bytes at
+// framesOffset. The newest frame is in slot (writeCount - 1) % slotCount. Rows are tightly
+// packed in the frame buffers colour format. A size change restarts the ring
+typedef struct Render_FrameBufferRecorderFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t formatCode;      ///< TinyImageFormat_Code
+	uint32_t width;
+	uint32_t height;
+	uint32_t slotCount;
+	uint32_t padding;
+	uint64_t frameSize;
+	uint64_t framesOffset;
+	uint64_t writeCount;      ///< frames written since the ring (re)started
+} Render_FrameBufferRecorderFileHeader;
+
+typedef struct Render_FrameBufferRecorderIndexEntry {
+	uint64_t frame;           ///< renderer frame count when it was presented
+	uint64_t timeMs;          ///< wall clock, milliseconds since the unix epoch
+} Render_FrameBufferRecorderIndexEntry;
+
+// starting again replaces the current recording
+AL2O3_EXTERN_C bool Render_FrameBufferRecorderStart(Render_FrameBufferHandle handle,
+																										Render_FrameBufferRecorderDesc const *desc);
+// frames not yet written are dropped, the ring file is left on disk
+AL2O3_EXTERN_C void Render_FrameBufferRecorderStop(Render_FrameBufferHandle handle);
+// the worker writes the dump between frames, false if not recording or a dump is in progress
+AL2O3_EXTERN_C bool Render_FrameBufferRecorderDump(Render_FrameBufferHandle handle, char const *path);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/shader.h"
+#include "render_basics/descriptorset.h"
+
+// Shader permutations
+// A permutation set is one shader source + entry point with a list of defines. Each
+// define owns bitCount bits of a 64 bit key (1 bit for a boolean, more for an integer)
+// packed in declaration order from bit 0. Render_ShaderPermutationGet compiles the
+// permutation for a key the first time it is asked for, with every define prepended
+// to the source as '#define NAME value'.
+// Compiled permutations are shared across all sets by (source hash, key)
+
+#define RENDER_SHADER_PERMUTATION_MAX_DEFINES 32
+
+typedef struct Render_ShaderPermutationDefine {
+	char const *name;
+	uint32_t bitCount; ///< 1 for a boolean define
+} Render_ShaderPermutationDefine;
+
+typedef struct Render_ShaderPermutationSetDesc {
+	Render_ShaderObjectDesc shader; ///< file is read once at creation and can be closed after
+	uint32_t defineCount;
+	Render_ShaderPermutationDefine const *defines;
+} Render_ShaderPermutationSetDesc;
+
+typedef struct Render_ShaderPermutationSet *Render_ShaderPermutationSetHandle;
+
+AL2O3_EXTERN_C Render_ShaderPermutationSetHandle Render_ShaderPermutationSetCreate(Render_RendererHandle renderer,
+																																									 Render_ShaderPermutationSetDesc const *desc);
+// releases the sets reference on every permutation it asked for
+AL2O3_EXTERN_C void Render_ShaderPermutationSetDestroy(Render_RendererHandle renderer,
+																											 Render_ShaderPermutationSetHandle set);
+
+// returns key with the define at defineIndex set to value
+AL2O3_EXTERN_C uint64_t Render_ShaderPermutationSetKeyValue(Render_ShaderPermutationSetHandle set,
+																														uint64_t key,
+																														uint32_t defineIndex,
+																														uint32_t value);
+
+// the returned shader object is owned by the set, don't destroy it
+AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderPermutationGet(Render_ShaderPermutationSetHandle set, uint64_t key);
+
+// Shader reflection
+// taken from TheForge's reflection of the compiled shader when it is created, so only
+// resources the compiled permutation actually uses are present. Shader objects have
+// none, a shader reflects all its stages together. A root signature merges its shaders,
+// which lets bindings be validated and resolved to descriptor indices once at creation
+
+#define RENDER_SHADER_REFLECTION_MAX_BINDINGS 32
+#define RENDER_SHADER_REFLECTION_MAX_VERTEX_INPUTS 16
+
+typedef enum Render_ShaderBindingType {
+	Render_SBT_CONSTANT_BUFFER,
+	Render_SBT_TEXTURE,
+	Render_SBT_RW_TEXTURE,
+	Render_SBT_BUFFER,
+	Render_SBT_RW_BUFFER,
+	Render_SBT_SAMPLER,
+} Render_ShaderBindingType;
+
+typedef struct Render_ShaderBinding {
+	char name[64];
+	Render_ShaderBindingType type;
+	uint32_t set;           ///< register space
+	uint32_t binding;       ///< register index, ~0 if not explicitly bound
+	uint32_t count;         ///< array size, 1 if not an array
+	uint32_t size;          ///< constant buffer size in bytes (HLSL packing), 0 for others
+} Render_ShaderBinding;
+
+typedef struct Render_ShaderVertexInput {
+	char semantic[32];      ///< without the trailing index
+	uint32_t semanticIndex;
+} Render_ShaderVertexInput;
+
+typedef struct Render_ShaderReflection {
+	uint32_t bindingCount;
+	Render_ShaderBinding bindings[RENDER_SHADER_REFLECTION_MAX_BINDINGS];
+	uint32_t vertexInputCount;
+	Render_ShaderVertexInput vertexInputs[RENDER_SHADER_REFLECTION_MAX_VERTEX_INPUTS];
+} Render_ShaderReflection;
+
+AL2O3_EXTERN_C Render_ShaderReflection const *Render_ShaderGetReflection(Render_ShaderHandle handle);
+// every binding used by the root signatures shaders (vertex inputs are empty)
+AL2O3_EXTERN_C Render_ShaderReflection const *Render_RootSignatureGetReflection(Render_RootSignatureHandle handle);
+// the descriptor index of a binding, ~0 if the root signature doesn't use it. Look it up
+// once and pass it to Render_DescriptorUpdateIndexed
+AL2O3_EXTERN_C uint32_t Render_RootSignatureGetDescriptorIndex(Render_RootSignatureHandle handle, char const *name);
+// Render_DescriptorUpdate with indices[i] (from Render_RootSignatureGetDescriptorIndex)
+// used for desc[i] instead of its name
+AL2O3_EXTERN_C void Render_DescriptorUpdateIndexed(Render_DescriptorSetHandle handle,
+																									 uint32_t setIndex,
+																									 uint32_t numDescriptors,
+																									 Render_DescriptorDesc const *desc,
+																									 uint32_t const *indices);
+
+// checks every vertex input of the shader is supplied by the layout
+AL2O3_EXTERN_C bool Render_ShaderValidateVertexLayout(Render_ShaderHandle handle, Render_VertexLayoutHandle layout);
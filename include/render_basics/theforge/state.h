@@ -0,0 +1,37 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "gfx_theforge/theforge.h"
+#include "render_basics/api.h"
+
+// State objects from full descriptors
+// equal descriptors share one refcounted state object, every Create must be paired
+// with a Destroy. Descriptors are compared as bytes so zero initialise them ({})
+// before filling in, else padding can stop equal descriptors matching.
+// The stock states come from the same cache so asking for a descriptor equal to a
+// stock state returns the stock object (with its own reference)
+
+typedef TheForge_BlendStateDesc Render_BlendStateDesc;
+typedef TheForge_DepthStateDesc Render_DepthStateDesc;
+typedef TheForge_RasterizerStateDesc Render_RasteriserStateDesc;
+typedef TheForge_SamplerDesc Render_SamplerDesc;
+
+AL2O3_EXTERN_C Render_BlendStateHandle Render_BlendStateCreate(Render_RendererHandle renderer,
+																															 Render_BlendStateDesc const *desc);
+AL2O3_EXTERN_C void Render_BlendStateDestroy(Render_RendererHandle renderer, Render_BlendStateHandle handle);
+
+AL2O3_EXTERN_C Render_DepthStateHandle Render_DepthStateCreate(Render_RendererHandle renderer,
+																															 Render_DepthStateDesc const *desc);
+AL2O3_EXTERN_C void Render_DepthStateDestroy(Render_RendererHandle renderer, Render_DepthStateHandle handle);
+
+AL2O3_EXTERN_C Render_RasteriserStateHandle Render_RasteriserStateCreate(Render_RendererHandle renderer,
+																																				 Render_RasteriserStateDesc const *desc);
+AL2O3_EXTERN_C void Render_RasteriserStateDestroy(Render_RendererHandle renderer, Render_RasteriserStateHandle handle);
+
+AL2O3_EXTERN_C Render_SamplerHandle Render_SamplerCreate(Render_RendererHandle renderer, Render_SamplerDesc const *desc);
+AL2O3_EXTERN_C void Render_SamplerDestroy(Render_RendererHandle renderer, Render_SamplerHandle handle);
+
+// creates every stock state and registers every stock vertex layout now, instead of
+// on first use in whatever happens to ask first. Afterwards the Render_GetStock*
+// calls are just an array lookup
+AL2O3_EXTERN_C void Render_RendererPrewarmStock(Render_RendererHandle renderer);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Explicit queue submission
+// Render_Fence is a timeline: a monotonically increasing 64 bit value that queue
+// submits signal and that other submits (gpu) or the cpu can wait on reaching.
+// TheForge has no timeline semaphores so each signalled value is backed by a binary
+// fence + semaphore pair from a pool. The fence is recycled once the value has passed,
+// the semaphore once the submit that waited on it has finished.
+// Limits of the emulation: a wait must be for a value already signalled by an earlier
+// submit and a signalled value can be waited on by one other submit, a second
+// gpu wait on the same value falls back to a cpu wait before submitting
+
+typedef struct Render_Fence *Render_FenceHandle;
+
+typedef struct Render_FencePoint {
+	Render_FenceHandle fence;
+	uint64_t value;
+} Render_FencePoint;
+
+AL2O3_EXTERN_C Render_FenceHandle Render_FenceCreate(Render_RendererHandle renderer);
+// waits for everything signalled on the fence to finish
+AL2O3_EXTERN_C void Render_FenceDestroy(Render_RendererHandle renderer, Render_FenceHandle fence);
+
+// the last value passed to a submit signal, the next signal must be greater
+AL2O3_EXTERN_C uint64_t Render_FenceGetSignalledValue(Render_FenceHandle fence);
+// highest value the gpu has completed, never blocks
+AL2O3_EXTERN_C uint64_t Render_FencePoll(Render_FenceHandle fence);
+// blocks until the gpu has reached value
+AL2O3_EXTERN_C void Render_FenceWait(Render_FenceHandle fence, uint64_t value);
+
+// Encoders recorded since their Begin. They are all ended and submitted in a single
+// queue submit, which is much cheaper than one submit each. Encoders submitted this
+// way don't track completion themselves, wait on the signal point before beginning
+// them again
+typedef struct Render_QueueSubmitDesc {
+	uint32_t graphicsEncoderCount;
+	Render_GraphicsEncoderHandle const *graphicsEncoders;
+	uint32_t computeEncoderCount;
+	Render_ComputeEncoderHandle const *computeEncoders;
+	uint32_t blitEncoderCount;
+	Render_BlitEncoderHandle const *blitEncoders;
+
+	uint32_t waitCount;
+	Render_FencePoint const *waits;
+	Render_FencePoint signal; ///< fence can be null if nothing waits on this submit
+} Render_QueueSubmitDesc;
+
+AL2O3_EXTERN_C void Render_QueueSubmit(Render_QueueHandle queue, Render_QueueSubmitDesc const *desc);
+
+// starts recording on a standalone graphics encoder (frame buffer encoders are begun by NewFrame)
+AL2O3_EXTERN_C void Render_GraphicsEncoderBegin(Render_GraphicsEncoderHandle handle);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+#include "render_basics/texture.h"
+
+// Transient texture pool
+// short lived targets (post effect intermediates, resized offscreen targets etc.)
+// are recycled instead of created and destroyed. Textures are matched on format,
+// size, mips, samples, usage and clear value. A released texture can be acquired
+// again once the frame it was released in has finished on the gpu and is destroyed
+// if it isn't acquired again for a while.
+// Pooled textures must be released, never Render_TextureDestroy'd. Contents are
+// undefined when acquired and initialData isn't supported
+
+AL2O3_EXTERN_C Render_TextureHandle Render_TextureAcquireTransient(Render_RendererHandle renderer,
+																																	 Render_TextureCreateDesc const *desc);
+AL2O3_EXTERN_C void Render_TextureReleaseTransient(Render_RendererHandle renderer, Render_TextureHandle handle);
+
+// frames a released texture is kept before being destroyed, default 60
+AL2O3_EXTERN_C void Render_TexturePoolSetEvictionAge(Render_RendererHandle renderer, uint32_t frames);
+// destroys every released texture that the gpu has finished with
+AL2O3_EXTERN_C void Render_TexturePoolTrim(Render_RendererHandle renderer);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// Frame throttling
+// stops mostly static tool windows redrawing identical frames. Each loop the app asks
+// Render_FrameBufferShouldRender and only runs NewFrame ... Present when it says so,
+// sleeping or waiting for events otherwise.
+// On demand frame buffers only render when dirty: marked by the app (input or anything
+// else it knows has changed), a pending resize, texture or non frequently updated buffer
+// uploads since the last frame, waiting visual debug primitives or headless readbacks
+// still to deliver. Unfocused frame buffers are capped to backgroundFps and/or present
+// with vsync. Minimised frame buffers never render, otherwise a zeroed desc (the
+// default) renders every frame
+
+typedef struct Render_FrameBufferThrottleDesc {
+	bool onDemand;          ///< skip frames when nothing is dirty
+	double backgroundFps;   ///< unfocused rate cap, 0 = uncapped
+	bool backgroundVsync;   ///< unfocused swap chains present with vsync
+} Render_FrameBufferThrottleDesc;
+
+AL2O3_EXTERN_C void Render_FrameBufferSetThrottle(Render_FrameBufferHandle handle,
+																									Render_FrameBufferThrottleDesc const *desc);
+// focus and minimised state of the window, frame buffers start focused
+AL2O3_EXTERN_C void Render_FrameBufferSetWindowState(Render_FrameBufferHandle handle, bool focused, bool minimised);
+AL2O3_EXTERN_C void Render_FrameBufferMarkDirty(Render_FrameBufferHandle handle);
+AL2O3_EXTERN_C bool Render_FrameBufferShouldRender(Render_FrameBufferHandle handle);
@@ -0,0 +1,40 @@
+cbuffer uniformBlock : register(b0, space1)
+{
+	float4x4 worldToViewMatrix;
+	float4x4 viewToNDCMatrix;
+	float4x4 worldToNDCMatrix;
+};
+struct VSInput
+{
+	float4 Position : POSITION;
+	float3 Normal   : NORMAL;
+	float4 Colour   : COLOR;
+};
+
+struct InstanceInput
+{
+	float4 localToWorldMatrixRow0 : INSTANCEROW0;
+	float4 localToWorldMatrixRow1 : INSTANCEROW1;
+	float4 localToWorldMatrixRow2 : INSTANCEROW2;
+};
+
+struct VSOutput {
+	float4 Position : SV_POSITION;
+	float4 Colour   : COLOR;
+};
+
+VSOutput VS_main(VSInput input, InstanceInput instance)
+{
+    VSOutput result;
+
+	float4x4 localToWorldMatrix;
+	localToWorldMatrix[0] = instance.localToWorldMatrixRow0;
+	localToWorldMatrix[1] = instance.localToWorldMatrixRow1;
+	localToWorldMatrix[2] = instance.localToWorldMatrixRow2;
+	localToWorldMatrix[3] = float4(0,0,0,1);
+	float4 pos = mul(localToWorldMatrix, input.Position);
+	result.Position = mul(worldToNDCMatrix, pos);
+	result.Colour = float4((input.Normal*0.5)+float3(0.5,0.5,0.5),1);
+//input.Colour;
+	return result;
+}
@@ -0,0 +1,12 @@
+Texture2D sourceTexture : register(t1, space1);
+SamplerState linearSampler : register(s0, space0);
+
+struct FSInput {
+	float4 Position : SV_POSITION;
+	float2 UV       : TEXCOORD0;
+};
+
+float4 FS_main(FSInput input) : SV_Target
+{
+	return sourceTexture.Sample(linearSampler, input.UV);
+}
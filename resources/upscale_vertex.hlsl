@@ -0,0 +1,20 @@
+cbuffer uniformBlock : register(b0, space1)
+{
+	float2 uvScale;
+};
+
+struct VSOutput {
+	float4 Position : SV_POSITION;
+	float2 UV       : TEXCOORD0;
+};
+
+// a single triangle covering the render target, no vertex buffer
+VSOutput VS_main(uint vertexId : SV_VertexID)
+{
+	VSOutput result;
+
+	float2 uv = float2((vertexId << 1) & 2, vertexId & 2);
+	result.Position = float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+	result.UV = uv * uvScale;
+	return result;
+}
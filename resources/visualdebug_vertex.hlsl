@@ -0,0 +1,25 @@
+cbuffer uniformBlock : register(b0, space1)
+{
+	float4x4 worldToViewMatrix;
+	float4x4 viewToNDCMatrix;
+	float4x4 worldToNDCMatrix;
+};
+struct VSInput
+{
+	float4 Position : POSITION;
+	float4 Colour   : COLOR;
+};
+
+struct VSOutput {
+	float4 Position : SV_POSITION;
+	float4 Colour   : COLOR;
+};
+
+VSOutput VS_main(VSInput input)
+{
+    VSOutput result;
+
+	result.Position = mul(worldToNDCMatrix, input.Position);
+	result.Colour = input.Colour;
+	return result;
+}
@@ -5,6 +5,16 @@
 #include "render_basics/theforge/api.h"
 #include "render_basics/api.h"
 #include "render_basics/theforge/handlemanager.h"
+#include "pipelinecache.hpp"
+#include "pipelinecompiler.hpp"
+#include "shader.hpp"
+#include "statecache.hpp"
+#include "readback.hpp"
+#include "texturepool.hpp"
+#include "gpuprofiler.hpp"
+#include "render_basics/theforge/state.h"
+#include "render_basics/theforge/framepacing.h"
+#include "render_basics/theforge/submit.h"
 
 AL2O3_EXTERN_C Render_HandleManagerTheForge* g_Render_HandleManagerTheForge = nullptr;
 static uint32_t g_RendererCount = 0;
@@ -69,6 +79,17 @@ static void DestroyHandleManager() {
 }
 
 AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreate(InputBasic_ContextHandle input) {
+	return Render_RendererCreateWithDesc(input, nullptr);
+}
+
+// Render_RendererDestroy copes with a partially created renderer
+static Render_RendererHandle CreateFailed(Render_RendererHandle renderer) {
+	Render_RendererDestroy(renderer);
+	return nullptr;
+}
+
+AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreateWithDesc(InputBasic_ContextHandle input,
+																																	 Render_RendererCreateDesc const *createDesc) {
 	if(g_Render_HandleManagerTheForge == nullptr) {
 		ASSERT(g_RendererCount == 0);
 		CreateHandleManager();
@@ -76,11 +97,38 @@ AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreate(InputBasic_ContextHan
 
 	auto renderer = (Render_Renderer *) MEMORY_CALLOC(1, sizeof(Render_Renderer));
 	if (!renderer) {
+		if (g_RendererCount == 0) {
+			DestroyHandleManager();
+		}
 		return nullptr;
 	}
+	// counted straight away so a failed create can go through Render_RendererDestroy
+	g_RendererCount++;
+	Thread_MutexCreate(&renderer->shaderCompilerMutex);
 
 	renderer->input = input;
-	renderer->maxFramesAhead = 2; // TODO fix MacOs bug if 3
+	renderer->maxFramesAhead = 2;
+	if (createDesc) {
+		if (createDesc->framesInFlight) {
+			renderer->maxFramesAhead = createDesc->framesInFlight;
+		}
+		if (renderer->maxFramesAhead > RENDER_MAX_FRAMES_IN_FLIGHT) {
+			LOGWARNING("%u frames in flight requested, max is %u", renderer->maxFramesAhead, RENDER_MAX_FRAMES_IN_FLIGHT);
+			renderer->maxFramesAhead = RENDER_MAX_FRAMES_IN_FLIGHT;
+		}
+		renderer->swapChainImageCount = createDesc->swapChainImageCount;
+		renderer->lowLatency = createDesc->lowLatency;
+	}
+	if (renderer->swapChainImageCount == 0) {
+		renderer->swapChainImageCount = renderer->maxFramesAhead;
+	}
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_APPLE_MAC
+	// presenting with 3 drawables is broken on macOS, frames in flight don't need the images
+	if (renderer->swapChainImageCount > 2) {
+		LOGWARNING("%u swap chain images requested, macOS is limited to 2", renderer->swapChainImageCount);
+		renderer->swapChainImageCount = 2;
+	}
+#endif
 
 	// window and renderer setup
 	TheForge_RendererDesc desc{
@@ -92,13 +140,12 @@ AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreate(InputBasic_ContextHan
 	renderer->renderer = TheForge_RendererCreate("TMP", &desc);
 	if (!renderer->renderer) {
 		LOGERROR("TheForge_RendererCreate failed");
-
-		return nullptr;
+		return CreateFailed(renderer);
 	}
 	renderer->shaderCompiler = ShaderCompiler_Create();
 	if (!renderer->shaderCompiler) {
 		LOGERROR("ShaderCompiler_Create failed");
-		return nullptr;
+		return CreateFailed(renderer);
 	}
 #ifndef NDEBUG
 	ShaderCompiler_SetOptimizationLevel(renderer->shaderCompiler, ShaderCompiler_OPT_None);
@@ -136,10 +183,57 @@ AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreate(InputBasic_ContextHan
 	Render_QueueHandleToPtr(renderer->computeQueue)->queue = computeQ;
 	Render_QueueHandleToPtr(renderer->blitQueue)->queue = blitQ;
 
+	// DispatchIndirect args don't change root constants so one signature covers every root signature
+	TheForge_IndirectArgumentDescriptor dispatchArg{};
+	dispatchArg.type = TheForge_IAT_DISPATCH;
+	TheForge_CommandSignatureDesc dispatchSignatureDesc{};
+	dispatchSignatureDesc.cmdPool = renderer->computeCmdPool;
+	dispatchSignatureDesc.indirectArgCount = 1;
+	dispatchSignatureDesc.pArgDescs = &dispatchArg;
+	TheForge_AddIndirectCommandSignature(renderer->renderer, &dispatchSignatureDesc, &renderer->dispatchCommandSignature);
+
 	// init TheForge resourceloader
 	TheForge_InitResourceLoaderInterface(renderer->renderer, nullptr);
 
-	g_RendererCount++;
+	renderer->pipelineCache = RenderTF_PipelineCacheCreate();
+	if (!renderer->pipelineCache) {
+		LOGERROR("RenderTF_PipelineCacheCreate failed");
+		return CreateFailed(renderer);
+	}
+	renderer->stateCache = RenderTF_StateCacheCreate();
+	if (!renderer->stateCache) {
+		LOGERROR("RenderTF_StateCacheCreate failed");
+		return CreateFailed(renderer);
+	}
+	renderer->shaderPermutationCache = RenderTF_ShaderPermutationCacheCreate();
+	if (!renderer->shaderPermutationCache) {
+		LOGERROR("RenderTF_ShaderPermutationCacheCreate failed");
+		return CreateFailed(renderer);
+	}
+
+	renderer->readback = RenderTF_ReadbackCreate(renderer);
+	if (!renderer->readback) {
+		LOGERROR("RenderTF_ReadbackCreate failed");
+		return CreateFailed(renderer);
+	}
+	renderer->texturePool = RenderTF_TexturePoolCreate(renderer);
+	if (!renderer->texturePool) {
+		LOGERROR("RenderTF_TexturePoolCreate failed");
+		return CreateFailed(renderer);
+	}
+	renderer->gpuProfiler = RenderTF_GpuProfilerCreate(renderer);
+	if (!renderer->gpuProfiler) {
+		LOGERROR("RenderTF_GpuProfilerCreate failed");
+		return CreateFailed(renderer);
+	}
+	for (uint32_t i = 0; i < renderer->maxFramesAhead; ++i) {
+		TheForge_AddFence(renderer->renderer, &renderer->frameFences[i]);
+	}
+	renderer->submitFence = Render_FenceCreate(renderer);
+	if (!renderer->submitFence) {
+		LOGERROR("Render_FenceCreate failed");
+		return CreateFailed(renderer);
+	}
 
 	return renderer;
 }
@@ -147,59 +241,81 @@ AL2O3_EXTERN_C Render_RendererHandle Render_RendererCreate(InputBasic_ContextHan
 AL2O3_EXTERN_C void Render_RendererDestroy(Render_RendererHandle renderer) {
 	if(!renderer) return;
 
+	// a failed create ends up here too, anything it didn't get to is still null. The
+	// queues, command pools and resource loader are created together after the compiler
+	bool const queuesCreated = renderer->graphicsCmdPool != nullptr;
+
 	// idle everything
-	TheForge_FlushResourceUpdates();
-	TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->graphicsQueue)->queue);
-	TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->computeQueue)->queue);
-	TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->blitQueue)->queue);
-
-	// remove any stocks that have been allocator
-	for (auto i = 0u; i < Render_SBS_COUNT; ++i) {
-		if (Render_BlendStateHandleIsValid(renderer->stockBlendState[i])) {
-			Render_BlendState* bs = Render_BlendStateHandleToPtr(renderer->stockBlendState[i]);
-			TheForge_RemoveBlendState(renderer->renderer, bs->state);
-			Render_BlendStateHandleRelease(renderer->stockBlendState[i]);
-		}
+	if (queuesCreated) {
+		TheForge_FlushResourceUpdates();
+		TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->graphicsQueue)->queue);
+		TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->computeQueue)->queue);
+		TheForge_WaitQueueIdle(Render_QueueHandleToPtr(renderer->blitQueue)->queue);
 	}
-	for (auto i = 0u; i < Render_SDS_COUNT; ++i) {
-		if (Render_DepthStateHandleIsValid(renderer->stockDepthState[i])) {
-			Render_DepthState* ds = Render_DepthStateHandleToPtr(renderer->stockDepthState[i]);
-			TheForge_RemoveDepthState(renderer->renderer, ds->state);
-			Render_DepthStateHandleRelease(renderer->stockDepthState[i]);
+
+	RenderTF_PipelineCompilerDestroy(renderer->pipelineCompiler);
+	RenderTF_ReadbackDestroy(renderer, renderer->readback);
+	RenderTF_TexturePoolDestroy(renderer, renderer->texturePool);
+	RenderTF_GpuProfilerDestroy(renderer, renderer->gpuProfiler);
+	for (uint32_t i = 0; i < renderer->maxFramesAhead; ++i) {
+		if (renderer->frameFences[i]) {
+			TheForge_RemoveFence(renderer->renderer, renderer->frameFences[i]);
 		}
 	}
-	for (auto i = 0u; i < Render_SRS_COUNT; ++i) {
-		if (Render_RasteriserStateHandleIsValid(renderer->stockRasteriserState[i])) {
-			Render_RasteriserState* rs = Render_RasteriserStateHandleToPtr(renderer->stockRasteriserState[i]);
-			TheForge_RemoveRasterizerState(renderer->renderer, rs->state);
-			Render_RasteriserStateHandleRelease(renderer->stockRasteriserState[i]);
+	// after readback and the texture pool, which may reference its fences
+	Render_FenceDestroy(renderer, renderer->submitFence);
+	renderer->submitFence = nullptr;
+
+	// unclaimed prewarmed pipelines reference the stock states so go first
+	RenderTF_PipelineCacheDestroy(renderer, renderer->pipelineCache);
+	renderer->pipelineCache = nullptr;
+
+	// release the stock references, anything else left is removed by the state cache
+	if (renderer->stateCache) {
+		for (auto i = 0u; i < Render_SBS_COUNT; ++i) {
+			Render_BlendStateDestroy(renderer, renderer->stockBlendState[i]);
 		}
-	}
-	for (size_t i = 0; i < Render_SST_COUNT; ++i) {
-		if (Render_SamplerHandleIsValid(renderer->stockSamplers[i])) {
-			Render_Sampler* s = Render_SamplerHandleToPtr(renderer->stockSamplers[i]);
-			TheForge_RemoveSampler(renderer->renderer, s->sampler);
-			Render_SamplerHandleRelease(renderer->stockSamplers[i]);
+		for (auto i = 0u; i < Render_SDS_COUNT; ++i) {
+			Render_DepthStateDestroy(renderer, renderer->stockDepthState[i]);
+		}
+		for (auto i = 0u; i < Render_SRS_COUNT; ++i) {
+			Render_RasteriserStateDestroy(renderer, renderer->stockRasteriserState[i]);
+		}
+		for (size_t i = 0; i < Render_SST_COUNT; ++i) {
+			Render_SamplerDestroy(renderer, renderer->stockSamplers[i]);
 		}
 	}
+	RenderTF_StateCacheDestroy(renderer, renderer->stateCache);
 
 	// stock vertex layouts are static and don't need releasing
 
-	TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->graphicsQueue)->queue);
-	TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->computeQueue)->queue);
-	TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->blitQueue)->queue);
-	Render_QueueHandleRelease(renderer->graphicsQueue);
-	Render_QueueHandleRelease(renderer->computeQueue);
-	Render_QueueHandleRelease(renderer->blitQueue);
+	if (queuesCreated) {
+		TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->graphicsQueue)->queue);
+		TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->computeQueue)->queue);
+		TheForge_RemoveQueue(Render_QueueHandleToPtr(renderer->blitQueue)->queue);
+		Render_QueueHandleRelease(renderer->graphicsQueue);
+		Render_QueueHandleRelease(renderer->computeQueue);
+		Render_QueueHandleRelease(renderer->blitQueue);
 
-	TheForge_RemoveCmdPool(renderer->renderer, renderer->blitCmdPool);
-	TheForge_RemoveCmdPool(renderer->renderer, renderer->computeCmdPool);
-	TheForge_RemoveCmdPool(renderer->renderer, renderer->graphicsCmdPool);
+		TheForge_RemoveIndirectCommandSignature(renderer->renderer, renderer->dispatchCommandSignature);
 
-	ShaderCompiler_Destroy(renderer->shaderCompiler);
+		TheForge_RemoveCmdPool(renderer->renderer, renderer->blitCmdPool);
+		TheForge_RemoveCmdPool(renderer->renderer, renderer->computeCmdPool);
+		TheForge_RemoveCmdPool(renderer->renderer, renderer->graphicsCmdPool);
+	}
 
-	TheForge_RemoveResourceLoaderInterface(renderer->renderer);
-	TheForge_RendererDestroy(renderer->renderer);
+	RenderTF_ShaderPermutationCacheDestroy(renderer, renderer->shaderPermutationCache);
+	if (renderer->shaderCompiler) {
+		ShaderCompiler_Destroy(renderer->shaderCompiler);
+	}
+	Thread_MutexDestroy(&renderer->shaderCompilerMutex);
+
+	if (queuesCreated) {
+		TheForge_RemoveResourceLoaderInterface(renderer->renderer);
+	}
+	if (renderer->renderer) {
+		TheForge_RendererDestroy(renderer->renderer);
+	}
 
 	MEMORY_FREE(renderer);
 	g_RendererCount--;
@@ -244,11 +360,25 @@ AL2O3_EXTERN_C void Render_QueueWaitIdle(Render_QueueHandle handle) {
 
 AL2O3_EXTERN_C void Render_RendererSetFrameIndex(Render_RendererHandle renderer, uint32_t newFrameIndex) {
 	renderer->frameIndex = newFrameIndex;
+	renderer->frameCount++;
+	RenderTF_TexturePoolNewFrame(renderer);
 }
 
 AL2O3_EXTERN_C uint32_t Render_RendererGetFrameIndex(Render_RendererHandle renderer) {
 	return renderer->frameIndex;
 }
+
+AL2O3_EXTERN_C uint32_t Render_RendererGetFramesInFlight(Render_RendererHandle renderer) {
+	return renderer->maxFramesAhead;
+}
+
+AL2O3_EXTERN_C void Render_RendererSetLowLatency(Render_RendererHandle renderer, bool enable) {
+	renderer->lowLatency = enable;
+}
+
+AL2O3_EXTERN_C bool Render_RendererGetLowLatency(Render_RendererHandle renderer) {
+	return renderer->lowLatency;
+}
 AL2O3_EXTERN_C void Render_RendererStartGpuCapture(Render_RendererHandle renderer, char const* filename) {
 	TheForge_CaptureTraceStart(renderer->renderer, filename);
 }
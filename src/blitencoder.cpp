@@ -1,17 +1,91 @@
 #include "al2o3_platform/platform.h"
 #include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
 
 #include "render_basics/theforge/api.h"
 #include "render_basics/theforge/handlemanager.h"
 #include "render_basics/api.h"
+#include "render_basics/theforge/blitencoder.h"
+#include "encoder.hpp"
+#include "framebuffer.hpp"
+#include "gpuprofiler.hpp"
 
+namespace {
+
+// fills copy from a pattern written into a cpu visible scratch buffer, the largest
+// pattern is FillChunkSize and bigger fills repeat the copy
+uint64_t const FillChunkSize = 64 * 1024;
+uint64_t const ScratchSize = 4 * FillChunkSize;
+
+uint64_t BufferOffset(Render_Buffer const *buffer, uint64_t offset) {
+	if (buffer->frequentlyUpdated) {
+		uint32_t const frameIndex = Render_RendererGetFrameIndex(buffer->renderer);
+		offset += (frameIndex * buffer->size);
+	}
+	return offset;
+}
+
+void ScratchCreate(Render_BlitEncoder *encoder) {
+	TheForge_BufferDesc scratchDesc{};
+	scratchDesc.size = ScratchSize;
+	scratchDesc.memoryUsage = TheForge_RMU_CPU_TO_GPU;
+	scratchDesc.flags = TheForge_BCF_PERSISTENT_MAP_BIT;
+	scratchDesc.startState = TheForge_RS_COPY_SOURCE;
+	TheForge_AddBuffer(encoder->renderer->renderer, &scratchDesc, &encoder->scratch);
+	encoder->scratchData = encoder->scratch ? (uint8_t *) TheForge_BufferGetCpuMappedAddress(encoder->scratch) : nullptr;
+	encoder->scratchUsed = 0;
+}
+
+// returns offset into the scratch buffer, retires a full scratch buffer until the fence passes
+uint64_t ScratchAlloc(Render_BlitEncoder *encoder, uint64_t size) {
+	ASSERT(size <= ScratchSize);
+	if (!encoder->scratch || encoder->scratchUsed + size > ScratchSize) {
+		if (encoder->scratch) {
+			CADT_VectorPushElement(encoder->retiredScratch, &encoder->scratch);
+		}
+		ScratchCreate(encoder);
+	}
+	uint64_t const offset = encoder->scratchUsed;
+	encoder->scratchUsed += (size + 255) & ~255ull;
+	return offset;
+}
+
+void ReleaseRetiredScratch(Render_BlitEncoder *encoder) {
+	auto retired = (TheForge_BufferHandle *) CADT_VectorData(encoder->retiredScratch);
+	for (size_t i = 0; i < CADT_VectorSize(encoder->retiredScratch); ++i) {
+		TheForge_RemoveBuffer(encoder->renderer->renderer, retired[i]);
+	}
+	CADT_VectorResize(encoder->retiredScratch, 0);
+}
+
+TheForge_SubresourceDataDesc SubresourceDataDesc(Render_TextureSubresource subresource,
+																								 Render_BufferTexelLayout layout,
+																								 uint64_t bufferOffset) {
+	TheForge_SubresourceDataDesc desc{};
+	desc.bufferOffset = bufferOffset;
+	desc.mipLevel = subresource.mipLevel;
+	desc.arrayLayer = subresource.slice;
+	desc.rowPitch = layout.rowPitch;
+	desc.slicePitch = layout.slicePitch;
+	return desc;
+}
+
+} // end anon namespace
 
 AL2O3_EXTERN_C Render_BlitEncoderHandle Render_BlitEncoderCreate(Render_RendererHandle renderer) {
 
 	Render_BlitEncoderHandle handle = Render_BlitEncoderHandleAlloc();
 	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	encoder->renderer = renderer;
 	encoder->cmdPool = renderer->blitCmdPool;
 	TheForge_AddCmd(encoder->cmdPool, false, &encoder->cmd);
+	TheForge_AddFence(renderer->renderer, &encoder->completeFence);
+	encoder->submitted = false;
+	encoder->scratch = nullptr;
+	encoder->scratchData = nullptr;
+	encoder->scratchUsed = 0;
+	encoder->retiredScratch = CADT_VectorCreate(sizeof(TheForge_BufferHandle));
+	encoder->timer = RenderTF_GpuTimerCreate(renderer, Render_QT_BLITTER);
 
 	return handle;
 }
@@ -19,9 +93,184 @@ AL2O3_EXTERN_C Render_BlitEncoderHandle Render_BlitEncoderCreate(Render_Renderer
 AL2O3_EXTERN_C void Render_BlitEncoderDestroy(Render_RendererHandle renderer, Render_BlitEncoderHandle handle) {
 
 	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	if (encoder->submitted) {
+		TheForge_WaitForFences(renderer->renderer, 1, &encoder->completeFence);
+	}
+	ReleaseRetiredScratch(encoder);
+	CADT_VectorDestroy(encoder->retiredScratch);
+	RenderTF_GpuTimerDestroy(renderer, encoder->timer);
+	if (encoder->scratch) {
+		TheForge_RemoveBuffer(renderer->renderer, encoder->scratch);
+	}
+	TheForge_RemoveFence(renderer->renderer, encoder->completeFence);
 	TheForge_RemoveCmd(encoder->cmdPool, encoder->cmd);
 	Render_BlitEncoderHandleRelease(handle);
 
 }
 
+AL2O3_EXTERN_C void Render_BlitEncoderBegin(Render_BlitEncoderHandle handle) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+
+	// the cmd and scratch can't be reused while the gpu is still reading them
+	Render_BlitEncoderWait(handle);
+	encoder->submitted = false;
+	ReleaseRetiredScratch(encoder);
+	encoder->scratchUsed = 0;
 
+	TheForge_BeginCmd(encoder->cmd);
+	RenderTF_GpuTimerBegin(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderCopyBuffer(Render_BlitEncoderHandle handle,
+																								 Render_BufferHandle dstHandle,
+																								 uint64_t dstOffset,
+																								 Render_BufferHandle srcHandle,
+																								 uint64_t srcOffset,
+																								 uint64_t size) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	Render_Buffer* dst = Render_BufferHandleToPtr(dstHandle);
+	Render_Buffer* src = Render_BufferHandleToPtr(srcHandle);
+	ASSERT(dstOffset + size <= dst->size);
+	ASSERT(srcOffset + size <= src->size);
+
+	TheForge_CmdUpdateBuffer(encoder->cmd,
+													 dst->buffer, BufferOffset(dst, dstOffset),
+													 src->buffer, BufferOffset(src, srcOffset),
+													 size);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderCopyBufferToTexture(Render_BlitEncoderHandle handle,
+																													Render_TextureHandle dstHandle,
+																													Render_TextureSubresource dstSubresource,
+																													Render_BufferHandle srcHandle,
+																													Render_BufferTexelLayout srcLayout) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	Render_Texture* dst = RenderTF_TextureAcquire(dstHandle);
+	Render_Buffer* src = Render_BufferHandleToPtr(srcHandle);
+
+	TheForge_SubresourceDataDesc const desc = SubresourceDataDesc(dstSubresource,
+																																 srcLayout,
+																																 BufferOffset(src, srcLayout.offset));
+	TheForge_CmdUpdateSubresource(encoder->cmd, dst->texture, src->buffer, &desc);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderCopyTextureToBuffer(Render_BlitEncoderHandle handle,
+																													Render_BufferHandle dstHandle,
+																													Render_BufferTexelLayout dstLayout,
+																													Render_TextureHandle srcHandle,
+																													Render_TextureSubresource srcSubresource) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	Render_Buffer* dst = Render_BufferHandleToPtr(dstHandle);
+	Render_Texture* src = RenderTF_TextureAcquire(srcHandle);
+
+	TheForge_SubresourceDataDesc const desc = SubresourceDataDesc(srcSubresource,
+																																 dstLayout,
+																																 BufferOffset(dst, dstLayout.offset));
+	TheForge_CmdCopySubresource(encoder->cmd, dst->buffer, src->texture, &desc);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderCopyTexture(Render_BlitEncoderHandle handle,
+																									Render_TextureHandle dstHandle,
+																									Render_TextureSubresource dstSubresource,
+																									Render_TextureHandle srcHandle,
+																									Render_TextureSubresource srcSubresource) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	Render_Texture* dst = RenderTF_TextureAcquire(dstHandle);
+	Render_Texture* src = RenderTF_TextureAcquire(srcHandle);
+	ASSERT(TheForge_TextureGetFormat(dst->texture) == TheForge_TextureGetFormat(src->texture));
+
+	TheForge_TextureCopyDesc const desc{
+			dstSubresource.mipLevel,
+			dstSubresource.slice,
+			srcSubresource.mipLevel,
+			srcSubresource.slice,
+	};
+	TheForge_CmdCopyTexture(encoder->cmd, dst->texture, src->texture, &desc);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderFillBuffer(Render_BlitEncoderHandle handle,
+																								 Render_BufferHandle dstHandle,
+																								 uint64_t dstOffset,
+																								 uint64_t size,
+																								 uint32_t value) {
+	ASSERT((size & 0x3) == 0);
+	if (size == 0) {
+		return;
+	}
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	Render_Buffer* dst = Render_BufferHandleToPtr(dstHandle);
+	ASSERT(dstOffset + size <= dst->size);
+
+	uint64_t const chunkSize = size < FillChunkSize ? size : FillChunkSize;
+	uint64_t const patternOffset = ScratchAlloc(encoder, chunkSize);
+	if (!encoder->scratchData) {
+		LOGERROR("Blit encoder scratch buffer creation failed, buffer fill skipped");
+		return;
+	}
+	auto pattern = (uint32_t *) (encoder->scratchData + patternOffset);
+	for (uint64_t i = 0; i < chunkSize / sizeof(uint32_t); ++i) {
+		pattern[i] = value;
+	}
+
+	uint64_t offset = BufferOffset(dst, dstOffset);
+	while (size) {
+		uint64_t const copySize = size < chunkSize ? size : chunkSize;
+		TheForge_CmdUpdateBuffer(encoder->cmd, dst->buffer, offset, encoder->scratch, patternOffset, copySize);
+		offset += copySize;
+		size -= copySize;
+	}
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderClearBuffer(Render_BlitEncoderHandle handle,
+																									Render_BufferHandle dst,
+																									uint64_t dstOffset,
+																									uint64_t size) {
+	Render_BlitEncoderFillBuffer(handle, dst, dstOffset, size, 0);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderTransition(Render_BlitEncoderHandle handle,
+																								 uint32_t numBuffers,
+																								 Render_BufferHandle const *buffers,
+																								 Render_BufferTransitionType const *bufferTransitions,
+																								 uint32_t numTextures,
+																								 Render_TextureHandle const *textures,
+																								 Render_TextureTransitionType const *textureTransitions) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	RenderTF_CmdTransition(encoder->cmd,
+												 numBuffers, buffers, bufferTransitions,
+												 numTextures, textures, textureTransitions);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderSubmit(Render_BlitEncoderHandle handle) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+
+	RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
+	TheForge_EndCmd(encoder->cmd);
+
+	Render_Queue* queue = Render_QueueHandleToPtr(encoder->renderer->blitQueue);
+	TheForge_QueueSubmit(queue->queue,
+											 1,
+											 &encoder->cmd,
+											 encoder->completeFence,
+											 0, nullptr,
+											 0, nullptr);
+	encoder->submitted = true;
+}
+
+AL2O3_EXTERN_C bool Render_BlitEncoderIsComplete(Render_BlitEncoderHandle handle) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	if (!encoder->submitted) {
+		return true;
+	}
+
+	TheForge_FenceStatus fenceStatus;
+	TheForge_GetFenceStatus(encoder->renderer->renderer, encoder->completeFence, &fenceStatus);
+	return fenceStatus != TheForge_FS_INCOMPLETE;
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderWait(Render_BlitEncoderHandle handle) {
+	Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(handle);
+	if (!Render_BlitEncoderIsComplete(handle)) {
+		TheForge_WaitForFences(encoder->renderer->renderer, 1, &encoder->completeFence);
+	}
+}
@@ -131,4 +131,8 @@ AL2O3_EXTERN_C void Render_BufferUpload(Render_BufferHandle handle, Render_Buffe
 	};
 
 	TheForge_UpdateBuffer(&tfUpdate, false);
+	// frequently updated buffers are rewritten every frame, they don't mean anything changed
+	if (!buffer->frequentlyUpdated) {
+		buffer->renderer->resourceUpdateCount++;
+	}
 }
@@ -4,14 +4,21 @@
 #include "render_basics/theforge/api.h"
 #include "render_basics/theforge/handlemanager.h"
 #include "render_basics/api.h"
-
+#include "render_basics/theforge/computeencoder.h"
+#include "encoder.hpp"
+#include "gpuprofiler.hpp"
 
 AL2O3_EXTERN_C Render_ComputeEncoderHandle Render_ComputeEncoderCreate(Render_RendererHandle renderer) {
 
 	Render_ComputeEncoderHandle handle = Render_ComputeEncoderHandleAlloc();
 	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
-	encoder->cmdPool = renderer->blitCmdPool;
+	encoder->renderer = renderer;
+	encoder->cmdPool = renderer->computeCmdPool;
 	TheForge_AddCmd(encoder->cmdPool, false, &encoder->cmd);
+	TheForge_AddFence(renderer->renderer, &encoder->completeFence);
+	TheForge_AddSemaphore(renderer->renderer, &encoder->completeSemaphore);
+	encoder->submitted = false;
+	encoder->timer = RenderTF_GpuTimerCreate(renderer, Render_QT_COMPUTE);
 
 	return handle;
 }
@@ -19,7 +26,145 @@ AL2O3_EXTERN_C Render_ComputeEncoderHandle Render_ComputeEncoderCreate(Render_Re
 AL2O3_EXTERN_C void Render_ComputeEncoderDestroy(Render_RendererHandle renderer, Render_ComputeEncoderHandle handle){
 
 	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	if (encoder->submitted) {
+		TheForge_WaitForFences(renderer->renderer, 1, &encoder->completeFence);
+	}
+	RenderTF_GpuTimerDestroy(renderer, encoder->timer);
+	TheForge_RemoveSemaphore(renderer->renderer, encoder->completeSemaphore);
+	TheForge_RemoveFence(renderer->renderer, encoder->completeFence);
 	TheForge_RemoveCmd(encoder->cmdPool, encoder->cmd);
 	Render_ComputeEncoderHandleRelease(handle);
 
 }
+
+AL2O3_EXTERN_C void Render_ComputeEncoderBegin(Render_ComputeEncoderHandle handle) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+
+	// the cmd can't be reset while the gpu is still executing it
+	if (encoder->submitted) {
+		TheForge_FenceStatus fenceStatus;
+		TheForge_GetFenceStatus(encoder->renderer->renderer, encoder->completeFence, &fenceStatus);
+		if (fenceStatus == TheForge_FS_INCOMPLETE) {
+			TheForge_WaitForFences(encoder->renderer->renderer, 1, &encoder->completeFence);
+		}
+		encoder->submitted = false;
+	}
+
+	TheForge_BeginCmd(encoder->cmd);
+	RenderTF_GpuTimerBegin(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderBindPipeline(Render_ComputeEncoderHandle handle,
+																											Render_PipelineHandle pipelineHandle) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(pipelineHandle);
+
+	TheForge_CmdBindPipeline(encoder->cmd, pipeline->pipeline);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderBindDescriptorSet(Render_ComputeEncoderHandle handle,
+																													 Render_DescriptorSetHandle setHandle,
+																													 uint32_t setIndex) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	Render_DescriptorSet* set = Render_DescriptorSetHandleToPtr(setHandle);
+
+	TheForge_CmdBindDescriptorSet(encoder->cmd, set->setIndexOffset + setIndex, set->descriptorSet);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderPushConstants(Render_ComputeEncoderHandle handle,
+																											 Render_RootSignatureHandle rootSignatureHandle,
+																											 char const *name,
+																											 void const *data) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	Render_RootSignature* rootSignature = Render_RootSignatureHandleToPtr(rootSignatureHandle);
+
+	TheForge_CmdBindPushConstants(encoder->cmd, rootSignature->signature, name, data);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderDispatch(Render_ComputeEncoderHandle handle,
+																									uint32_t groupCountX,
+																									uint32_t groupCountY,
+																									uint32_t groupCountZ) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+
+	TheForge_CmdDispatch(encoder->cmd, groupCountX, groupCountY, groupCountZ);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderDispatchIndirect(Render_ComputeEncoderHandle handle,
+																													Render_BufferHandle bufferHandle,
+																													uint64_t offset) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	Render_Buffer* buffer = Render_BufferHandleToPtr(bufferHandle);
+
+	uint64_t actualOffset = offset;
+	if (buffer->frequentlyUpdated) {
+		uint32_t const frameIndex = Render_RendererGetFrameIndex(buffer->renderer);
+		actualOffset += (frameIndex * buffer->size);
+	}
+
+	TheForge_CmdExecuteIndirect(encoder->cmd,
+															encoder->renderer->dispatchCommandSignature,
+															1,
+															buffer->buffer,
+															actualOffset,
+															nullptr,
+															0);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderTransition(Render_ComputeEncoderHandle handle,
+																										uint32_t numBuffers,
+																										Render_BufferHandle const *buffers,
+																										Render_BufferTransitionType const *bufferTransitions,
+																										uint32_t numTextures,
+																										Render_TextureHandle const *textures,
+																										Render_TextureTransitionType const *textureTransitions) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+	RenderTF_CmdTransition(encoder->cmd,
+												 numBuffers, buffers, bufferTransitions,
+												 numTextures, textures, textureTransitions);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderSubmit(Render_ComputeEncoderHandle handle,
+																								Render_FrameBufferHandle waitFor,
+																								Render_FrameBufferHandle signal) {
+	Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(handle);
+
+	RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
+	TheForge_EndCmd(encoder->cmd);
+
+	uint32_t waitCount = 0;
+	TheForge_SemaphoreHandle waitSemaphore = nullptr;
+	if (Render_FrameBufferHandleIsValid(waitFor)) {
+		Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(waitFor);
+		if (frameBuffer->computeSignalPending) {
+			waitSemaphore = frameBuffer->computeSignalSemaphore;
+			frameBuffer->computeSignalPending = false;
+			waitCount = 1;
+		} else {
+			LOGWARNING("Compute submit waiting on a frame buffer that didn't signal compute, not waiting");
+		}
+	}
+
+	uint32_t signalCount = 0;
+	if (Render_FrameBufferHandleIsValid(signal)) {
+		Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(signal);
+		uint32_t const maxWaits = sizeof(frameBuffer->computeWaits) / sizeof(frameBuffer->computeWaits[0]);
+		if (frameBuffer->computeWaitCount < maxWaits) {
+			frameBuffer->computeWaits[frameBuffer->computeWaitCount++] = encoder->completeSemaphore;
+			signalCount = 1;
+		} else {
+			LOGERROR("Too many compute submits for one frame buffer present, max is %u", maxWaits);
+		}
+	}
+
+	Render_Queue* queue = Render_QueueHandleToPtr(encoder->renderer->computeQueue);
+	TheForge_QueueSubmit(queue->queue,
+											 1,
+											 &encoder->cmd,
+											 encoder->completeFence,
+											 waitCount,
+											 &waitSemaphore,
+											 signalCount,
+											 &encoder->completeSemaphore);
+	encoder->submitted = true;
+}
@@ -5,6 +5,7 @@
 #include "render_basics/api.h"
 #include "render_basics/descriptorset.h"
 #include "render_basics/theforge/handlemanager.h"
+#include "framebuffer.hpp"
 
 AL2O3_EXTERN_C Render_DescriptorSetHandle Render_DescriptorSetCreate(Render_RendererHandle renderer,
 																																		 Render_DescriptorSetDesc const *desc) {
@@ -31,6 +32,7 @@ AL2O3_EXTERN_C Render_DescriptorSetHandle Render_DescriptorSetCreate(Render_Rend
 	ds->maxSetsPerFrame = desc->maxSets;
 	ds->setIndexOffset = 0;
 	ds->renderer = renderer;
+	ds->rootSignature = desc->rootSignature;
 	TheForge_AddDescriptorSet(renderer->renderer, &tfdesc, &ds->descriptorSet);
 	return handle;
 
@@ -48,10 +50,12 @@ AL2O3_EXTERN_C void Render_DescriptorSetDestroy(Render_RendererHandle renderer,
 
 }
 
+// indices are from Render_RootSignatureGetDescriptorIndex, without them (~0) TheForge looks up the name
 static void descriptorUpdate(Render_DescriptorSetHandle handle,
 																						 uint32_t setIndex,
 																						 uint32_t numDescriptors,
 																						 Render_DescriptorDesc const *desc,
+																						 uint32_t const *indices,
 																						 uint32_t frameIndex ) {
 	TheForge_DescriptorData* dd = (TheForge_DescriptorData *) STACK_ALLOC(sizeof(TheForge_DescriptorData) * numDescriptors);
 	memset(dd, 0, sizeof(TheForge_DescriptorData) * numDescriptors);
@@ -62,13 +66,15 @@ static void descriptorUpdate(Render_DescriptorSetHandle handle,
 	TheForge_BufferHandle* buffers = (TheForge_BufferHandle*) STACK_ALLOC(sizeof(TheForge_BufferHandle) * numDescriptors);
 	TheForge_SamplerHandle* samplers = (TheForge_SamplerHandle*) STACK_ALLOC(sizeof(TheForge_SamplerHandle) * numDescriptors);
 
+	Render_DescriptorSet* set = Render_DescriptorSetHandleToPtr(handle);
+
 	for (uint32_t i = 0; i < numDescriptors; ++i) {
 		dd[i].pName = desc[i].name;
 		dd[i].count = 1;
-		dd[i].index = ~0; // use name not index currently
+		dd[i].index = indices ? indices[i] : ~0u;
 		switch (desc[i].type) {
 			case Render_DT_TEXTURE:
-				textures[i] = Render_TextureHandleToPtr(desc[i].texture)->texture;
+				textures[i] = RenderTF_TextureAcquire(desc[i].texture)->texture;
 				dd[i].pTextures = &textures[i];
 				break;
 			case Render_DT_SAMPLER:
@@ -87,8 +93,6 @@ static void descriptorUpdate(Render_DescriptorSetHandle handle,
 		}
 	}
 
-	Render_DescriptorSet* set = Render_DescriptorSetHandleToPtr(handle);
-
 	// frame has changed and we have frequency >= frame rate adjust set index
 	if (set->frequency != TheForge_DESCRIPTOR_UPDATE_FREQ_NONE) {
 		set->setIndexOffset = frameIndex * set->maxSetsPerFrame;
@@ -106,7 +110,15 @@ AL2O3_EXTERN_C void 	Render_DescriptorUpdate(Render_DescriptorSetHandle handle,
 																						uint32_t numDescriptors,
 																						Render_DescriptorDesc const *desc) {
 
-	descriptorUpdate(handle, setIndex, numDescriptors, desc, Render_DescriptorSetHandleToPtr(handle)->renderer->frameIndex);
+	descriptorUpdate(handle, setIndex, numDescriptors, desc, nullptr, Render_DescriptorSetHandleToPtr(handle)->renderer->frameIndex);
+}
+
+AL2O3_EXTERN_C void Render_DescriptorUpdateIndexed(Render_DescriptorSetHandle handle,
+																									 uint32_t setIndex,
+																									 uint32_t numDescriptors,
+																									 Render_DescriptorDesc const *desc,
+																									 uint32_t const *indices) {
+	descriptorUpdate(handle, setIndex, numDescriptors, desc, indices, Render_DescriptorSetHandleToPtr(handle)->renderer->frameIndex);
 }
 
 // optimization that prefills all the per frame buffers
@@ -115,7 +127,7 @@ AL2O3_EXTERN_C void 	Render_DescriptorPresetFrequencyUpdated(Render_DescriptorSe
 																						 uint32_t numDescriptors,
 																						 Render_DescriptorDesc const *desc) {
 	for(uint32_t i = 0;i < Render_DescriptorSetHandleToPtr(handle)->maxSetsPerFrame;++i) {
-		descriptorUpdate(handle, setIndex, numDescriptors, desc, i);
+		descriptorUpdate(handle, setIndex, numDescriptors, desc, nullptr, i);
 	}
 
 }
\ No newline at end of file
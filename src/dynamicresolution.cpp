@@ -0,0 +1,273 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/buffer.h"
+#include "render_basics/descriptorset.h"
+#include "render_basics/graphicsencoder.h"
+#include "render_basics/pipeline.h"
+#include "render_basics/rootsignature.h"
+#include "render_basics/theforge/shader.h"
+#include "render_basics/theforge/texturepool.h"
+#include "dynamicresolution.hpp"
+#include "embeddedshaders.hpp"
+#include <cmath>
+
+struct RenderTF_DynamicResolution {
+	Render_RendererHandle renderer;
+	Render_DynamicResolutionDesc desc;
+	TinyImageFormat format;
+
+	float scale;
+	double averageGpuMs;
+
+	uint32_t width;               ///< output size
+	uint32_t height;
+	Render_TextureHandle target;  ///< transient at the output size, rendered into at scale
+
+	Render_ShaderHandle shader;
+	Render_RootSignatureHandle rootSignature;
+	Render_PipelineHandle pipeline;
+	Render_DescriptorSetHandle descriptorSet;
+	uint32_t descriptorIndices[2]; ///< uniformBlock and sourceTexture
+	Render_BufferHandle uniformBuffer;
+
+	union {
+		Math_Vec2F uvScale;
+		uint8_t spacer[UNIFORM_BUFFER_MIN_SIZE];
+	} uniforms;
+};
+
+namespace {
+
+float Clamp(float v, float lo, float hi) {
+	return v < lo ? lo : (v > hi ? hi : v);
+}
+
+uint32_t ScaledSize(uint32_t size, float scale) {
+	uint32_t const scaled = (uint32_t) ((float) size * scale);
+	return scaled ? scaled : 1;
+}
+
+void AcquireTarget(RenderTF_DynamicResolution *dr) {
+	Render_TextureCreateDesc desc{};
+	desc.format = dr->format;
+	desc.usageflags = (Render_TextureUsageFlags) (Render_TUF_ROP_WRITE | Render_TUF_SHADER_READ);
+	desc.width = dr->width;
+	desc.height = dr->height;
+	desc.depth = 1;
+	desc.slices = 1;
+	desc.mipLevels = 1;
+	desc.renderTargetClearValue = {0, 0, 0, 1};
+	desc.debugName = "Dynamic resolution target";
+	dr->target = Render_TextureAcquireTransient(dr->renderer, &desc);
+}
+
+bool CreatePipeline(RenderTF_DynamicResolution *dr) {
+	dr->shader = RenderTF_ShaderCreateEmbedded(dr->renderer, "upscale_vertex", "upscale_fragment");
+	if (!Render_ShaderHandleIsValid(dr->shader)) {
+		return false;
+	}
+
+	Render_ShaderHandle shaders[]{dr->shader};
+	Render_SamplerHandle samplers[]{Render_GetStockSampler(dr->renderer, Render_SST_LINEAR)};
+	char const *samplerNames[]{"linearSampler"};
+
+	Render_RootSignatureDesc rootSignatureDesc{};
+	rootSignatureDesc.shaderCount = 1;
+	rootSignatureDesc.shaders = shaders;
+	rootSignatureDesc.staticSamplerCount = 1;
+	rootSignatureDesc.staticSamplers = samplers;
+	rootSignatureDesc.staticSamplerNames = samplerNames;
+	dr->rootSignature = Render_RootSignatureCreate(dr->renderer, &rootSignatureDesc);
+	if (!Render_RootSignatureHandleIsValid(dr->rootSignature)) {
+		return false;
+	}
+	dr->descriptorIndices[0] = Render_RootSignatureGetDescriptorIndex(dr->rootSignature, "uniformBlock");
+	dr->descriptorIndices[1] = Render_RootSignatureGetDescriptorIndex(dr->rootSignature, "sourceTexture");
+	if (dr->descriptorIndices[0] == ~0u || dr->descriptorIndices[1] == ~0u) {
+		return false;
+	}
+
+	TinyImageFormat colourFormats[] = {dr->format};
+
+	Render_GraphicsPipelineDesc gfxPipeDesc{};
+	gfxPipeDesc.shader = dr->shader;
+	gfxPipeDesc.rootSignature = dr->rootSignature;
+	gfxPipeDesc.vertexLayout = nullptr;
+	gfxPipeDesc.blendState = Render_GetStockBlendState(dr->renderer, Render_SBS_OPAQUE);
+	gfxPipeDesc.depthState = Render_GetStockDepthState(dr->renderer, Render_SDS_IGNORE);
+	gfxPipeDesc.rasteriserState = Render_GetStockRasterisationState(dr->renderer, Render_SRS_NOCULL);
+	gfxPipeDesc.colourRenderTargetCount = 1;
+	gfxPipeDesc.colourFormats = colourFormats;
+	gfxPipeDesc.depthStencilFormat = TinyImageFormat_UNDEFINED;
+	gfxPipeDesc.sampleCount = 1;
+	gfxPipeDesc.sampleQuality = 0;
+	gfxPipeDesc.primitiveTopo = Render_PT_TRI_LIST;
+	dr->pipeline = Render_GraphicsPipelineCreate(dr->renderer, &gfxPipeDesc);
+	if (!Render_PipelineHandleIsValid(dr->pipeline)) {
+		return false;
+	}
+
+	Render_DescriptorSetDesc const setDesc = {
+			dr->rootSignature,
+			Render_DUF_PER_FRAME,
+			1
+	};
+	dr->descriptorSet = Render_DescriptorSetCreate(dr->renderer, &setDesc);
+	if (!Render_DescriptorSetHandleIsValid(dr->descriptorSet)) {
+		return false;
+	}
+
+	static Render_BufferUniformDesc const ubDesc{
+			sizeof(dr->uniforms),
+			true
+	};
+	dr->uniformBuffer = Render_BufferCreateUniform(dr->renderer, &ubDesc);
+	return Render_BufferHandleIsValid(dr->uniformBuffer);
+}
+
+} // end anon namespace
+
+RenderTF_DynamicResolution *RenderTF_DynamicResolutionCreate(Render_RendererHandle renderer,
+																														 TinyImageFormat format,
+																														 uint32_t width,
+																														 uint32_t height,
+																														 Render_DynamicResolutionDesc const *desc) {
+	auto dr = (RenderTF_DynamicResolution *) MEMORY_CALLOC(1, sizeof(RenderTF_DynamicResolution));
+	if (!dr) {
+		return nullptr;
+	}
+	dr->renderer = renderer;
+	dr->format = format;
+	dr->width = width;
+	dr->height = height;
+	RenderTF_DynamicResolutionSetDesc(dr, desc);
+	dr->scale = dr->desc.maxScale;
+
+	if (!CreatePipeline(dr)) {
+		LOGERROR("Dynamic resolution upscale pipeline creation failed");
+		RenderTF_DynamicResolutionDestroy(dr);
+		return nullptr;
+	}
+	AcquireTarget(dr);
+	if (!Render_TextureHandleIsValid(dr->target)) {
+		LOGERROR("Dynamic resolution target creation failed");
+		RenderTF_DynamicResolutionDestroy(dr);
+		return nullptr;
+	}
+	return dr;
+}
+
+void RenderTF_DynamicResolutionDestroy(RenderTF_DynamicResolution *dr) {
+	if (!dr) {
+		return;
+	}
+	Render_TextureReleaseTransient(dr->renderer, dr->target);
+
+	if (Render_BufferHandleIsValid(dr->uniformBuffer)) {
+		Render_BufferDestroy(dr->renderer, dr->uniformBuffer);
+	}
+	if (Render_DescriptorSetHandleIsValid(dr->descriptorSet)) {
+		Render_DescriptorSetDestroy(dr->renderer, dr->descriptorSet);
+	}
+	if (Render_PipelineHandleIsValid(dr->pipeline)) {
+		Render_PipelineDestroy(dr->renderer, dr->pipeline);
+	}
+	if (Render_RootSignatureHandleIsValid(dr->rootSignature)) {
+		Render_RootSignatureDestroy(dr->renderer, dr->rootSignature);
+	}
+	if (Render_ShaderHandleIsValid(dr->shader)) {
+		Render_ShaderDestroy(dr->renderer, dr->shader);
+	}
+	MEMORY_FREE(dr);
+}
+
+void RenderTF_DynamicResolutionSetDesc(RenderTF_DynamicResolution *dr, Render_DynamicResolutionDesc const *desc) {
+	dr->desc = *desc;
+	if (dr->desc.maxScale <= 0.0f || dr->desc.maxScale > 1.0f) {
+		dr->desc.maxScale = 1.0f;
+	}
+	if (dr->desc.minScale <= 0.0f) {
+		dr->desc.minScale = 0.5f;
+	}
+	if (dr->desc.minScale > dr->desc.maxScale) {
+		dr->desc.minScale = dr->desc.maxScale;
+	}
+	dr->scale = Clamp(dr->scale, dr->desc.minScale, dr->desc.maxScale);
+}
+
+void RenderTF_DynamicResolutionResize(RenderTF_DynamicResolution *dr, uint32_t width, uint32_t height) {
+	// the pool keeps the old target alive until the frames using it have finished
+	Render_TextureReleaseTransient(dr->renderer, dr->target);
+	dr->width = width;
+	dr->height = height;
+	AcquireTarget(dr);
+}
+
+void RenderTF_DynamicResolutionUpdate(RenderTF_DynamicResolution *dr, double gpuMs) {
+	if (gpuMs <= 0.0 || dr->desc.targetGpuMs <= 0.0) {
+		return;
+	}
+	double const alpha = 0.1;
+	dr->averageGpuMs = dr->averageGpuMs > 0.0 ? dr->averageGpuMs + (gpuMs - dr->averageGpuMs) * alpha : gpuMs;
+
+	// gpu time is roughly proportional to pixel count so the scale moves by the square
+	// root of the headroom. The dead band stops it hunting around the budget and
+	// limiting each step keeps the changes from being visible
+	double const ratio = dr->desc.targetGpuMs / dr->averageGpuMs;
+	if (ratio > 0.95 && ratio < 1.05) {
+		return;
+	}
+	float const step = Clamp((float) sqrt(ratio), 0.95f, 1.05f);
+	dr->scale = Clamp(dr->scale * step, dr->desc.minScale, dr->desc.maxScale);
+}
+
+float RenderTF_DynamicResolutionScale(RenderTF_DynamicResolution const *dr) {
+	return dr->scale;
+}
+
+Render_TextureHandle RenderTF_DynamicResolutionTarget(RenderTF_DynamicResolution const *dr) {
+	return dr->target;
+}
+
+Math_Vec4F RenderTF_DynamicResolutionViewport(RenderTF_DynamicResolution const *dr) {
+	return {0.0f, 0.0f, (float) ScaledSize(dr->width, dr->scale), (float) ScaledSize(dr->height, dr->scale)};
+}
+
+Math_Vec4U32 RenderTF_DynamicResolutionScissor(RenderTF_DynamicResolution const *dr) {
+	return {0, 0, ScaledSize(dr->width, dr->scale), ScaledSize(dr->height, dr->scale)};
+}
+
+void RenderTF_DynamicResolutionUpscale(RenderTF_DynamicResolution *dr,
+																			 Render_GraphicsEncoderHandle encoder,
+																			 Math_Vec4F viewport,
+																			 Math_Vec4U32 scissor) {
+	dr->uniforms.uvScale.x = (float) ScaledSize(dr->width, dr->scale) / (float) dr->width;
+	dr->uniforms.uvScale.y = (float) ScaledSize(dr->height, dr->scale) / (float) dr->height;
+	Render_BufferUpdateDesc uniformUpdate = {
+			&dr->uniforms,
+			0,
+			sizeof(dr->uniforms)
+	};
+	Render_BufferUpload(dr->uniformBuffer, &uniformUpdate);
+
+	// the target changes on resize so the set is rewritten every frame
+	Render_DescriptorDesc params[2];
+	params[0].name = "uniformBlock";
+	params[0].type = Render_DT_BUFFER;
+	params[0].buffer = dr->uniformBuffer;
+	params[0].offset = 0;
+	params[0].size = sizeof(dr->uniforms);
+	params[1].name = "sourceTexture";
+	params[1].type = Render_DT_TEXTURE;
+	params[1].texture = dr->target;
+	Render_DescriptorUpdateIndexed(dr->descriptorSet, 0, 2, params, dr->descriptorIndices);
+
+	Render_GraphicsEncoderSetScissor(encoder, scissor);
+	Render_GraphicsEncoderSetViewport(encoder, viewport, {0, 1});
+	Render_GraphicsEncoderBindPipeline(encoder, dr->pipeline);
+	Render_GraphicsEncoderBindDescriptorSet(encoder, dr->descriptorSet, 0);
+	Render_GraphicsEncoderDraw(encoder, 3, 0);
+}
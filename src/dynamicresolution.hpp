@@ -0,0 +1,31 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/dynamicresolution.h"
+
+struct RenderTF_DynamicResolution *RenderTF_DynamicResolutionCreate(Render_RendererHandle renderer,
+																																		TinyImageFormat format,
+																																		uint32_t width,
+																																		uint32_t height,
+																																		Render_DynamicResolutionDesc const *desc);
+void RenderTF_DynamicResolutionDestroy(struct RenderTF_DynamicResolution *dr);
+
+void RenderTF_DynamicResolutionSetDesc(struct RenderTF_DynamicResolution *dr, Render_DynamicResolutionDesc const *desc);
+// output size changed, the internal target is replaced
+void RenderTF_DynamicResolutionResize(struct RenderTF_DynamicResolution *dr, uint32_t width, uint32_t height);
+
+// feeds the controller the latest gpu frame time, 0 when there isn't one yet
+void RenderTF_DynamicResolutionUpdate(struct RenderTF_DynamicResolution *dr, double gpuMs);
+
+float RenderTF_DynamicResolutionScale(struct RenderTF_DynamicResolution const *dr);
+Render_TextureHandle RenderTF_DynamicResolutionTarget(struct RenderTF_DynamicResolution const *dr);
+Math_Vec4F RenderTF_DynamicResolutionViewport(struct RenderTF_DynamicResolution const *dr);
+Math_Vec4U32 RenderTF_DynamicResolutionScissor(struct RenderTF_DynamicResolution const *dr);
+
+// draws the scaled rect of the internal target (in shader read state) over the whole
+// of the bound render target
+void RenderTF_DynamicResolutionUpscale(struct RenderTF_DynamicResolution *dr,
+																			 Render_GraphicsEncoderHandle encoder,
+																			 Math_Vec4F viewport,
+																			 Math_Vec4U32 scissor);
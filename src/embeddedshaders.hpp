@@ -0,0 +1,31 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+// shaders under resources/ compiled at build time (see cmake/shaders.cmake)
+// the binaries are null if dxc wasn't found, the source is always present
+struct RenderTF_EmbeddedShader {
+	char const *name; ///< file name without the extension
+	char const *entryPoint;
+	decltype(Render_ShaderObjectDesc::shaderType) shaderType;
+
+	char const *source;
+	size_t sourceSize;
+	uint8_t const *spirv;
+	size_t spirvSize;
+	uint8_t const *dxil;
+	size_t dxilSize;
+};
+
+extern RenderTF_EmbeddedShader const RenderTF_EmbeddedShaders[];
+extern uint32_t const RenderTF_EmbeddedShaderCount;
+
+// uses the precompiled binary for the renderers backend if there is one, else compiles
+// the embedded source at runtime
+Render_ShaderObjectHandle RenderTF_ShaderObjectCreateEmbedded(Render_RendererHandle renderer, char const *name);
+
+// vertex + fragment shader from two embedded shaders
+Render_ShaderHandle RenderTF_ShaderCreateEmbedded(Render_RendererHandle renderer,
+																									char const *vertexName,
+																									char const *fragmentName);
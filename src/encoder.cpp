@@ -0,0 +1,80 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "encoder.hpp"
+#include "framebuffer.hpp"
+
+// shared by the graphics and compute encoders, transition enums to TheForge resource states
+void RenderTF_CmdTransition(TheForge_CmdHandle cmd,
+														uint32_t numBuffers,
+														Render_BufferHandle const *buffers,
+														Render_BufferTransitionType const *bufferTransitions,
+														uint32_t numTextures,
+														Render_TextureHandle const *textures,
+														Render_TextureTransitionType const *textureTransitions) {
+	if (!numBuffers && !numTextures) {
+		return;
+	}
+
+	auto bufferBarriers = (TheForge_BufferBarrier *) STACK_ALLOC(sizeof(TheForge_BufferBarrier) * numBuffers);
+
+	for (uint32_t i = 0; i < numBuffers; ++i) {
+		bufferBarriers[i].buffer = Render_BufferHandleToPtr(buffers[i])->buffer;
+		uint32_t newState = 0;
+		for (uint32_t j = 0x1; j < Render_BTT_MAX; j = j << 1) {
+			switch ((Render_BufferTransitionType) ((uint32_t const) bufferTransitions[i] & j)) {
+				case Render_BTT_VERTEX_OR_CONSTANT_BUFFER: newState |= TheForge_RS_VERTEX_AND_CONSTANT_BUFFER;
+					break;
+				case Render_BTT_INDEX_BUFFER: newState |= TheForge_RS_INDEX_BUFFER;
+					break;
+				case Render_BTT_UNORDERED_ACCESS: newState |= TheForge_RS_UNORDERED_ACCESS;
+					break;
+				case Render_BTT_INDIRECT_ARGUMENT: newState |= TheForge_RS_INDIRECT_ARGUMENT;
+					break;
+				case Render_BTT_COPY_DEST: newState |= TheForge_RS_COPY_DEST;
+					break;
+				case Render_BTT_COPY_SOURCE: newState |= TheForge_RS_COPY_SOURCE;
+					break;
+
+				default:
+				case Render_BTT_UNDEFINED: break;
+			}
+		}
+		bufferBarriers[i].newState = (TheForge_ResourceState) newState;
+		bufferBarriers[i].split = false;
+	}
+	auto textureBarriers = (TheForge_TextureBarrier *) STACK_ALLOC(sizeof(TheForge_TextureBarrier) * numTextures);
+	for (uint32_t i = 0; i < numTextures; ++i) {
+		textureBarriers[i].texture = RenderTF_TextureAcquire(textures[i])->texture;
+		uint32_t newState = 0;
+		for (uint32_t j = 0x1; j < Render_TTT_MAX; j = j << 1) {
+			switch ((Render_TextureTransitionType) ((uint32_t const) textureTransitions[i] & j)) {
+				case Render_TTT_RENDER_TARGET: newState |= TheForge_RS_RENDER_TARGET;
+					break;
+				case Render_TTT_UNORDERED_ACCESS: newState |= TheForge_RS_UNORDERED_ACCESS;
+					break;
+				case Render_TTT_DEPTH_WRITE: newState |= TheForge_RS_DEPTH_WRITE;
+					break;
+				case Render_TTT_DEPTH_READ: newState |= TheForge_RS_DEPTH_READ;
+					break;
+				case Render_TTT_COPY_DEST: newState |= TheForge_RS_COPY_DEST;
+					break;
+				case Render_TTT_COPY_SOURCE: newState |= TheForge_RS_COPY_SOURCE;
+					break;
+				case Render_TTT_PRESENT: newState |= TheForge_RS_PRESENT;
+					break;
+				case RENDER_TTT_SHADER_ACCESS: newState |= TheForge_RS_SHADER_RESOURCE;
+					break;
+				default:
+				case Render_TTT_UNDEFINED:break;
+			}
+		}
+		textureBarriers[i].newState = (TheForge_ResourceState) newState;
+		textureBarriers[i].split = false;
+	}
+
+	TheForge_CmdResourceBarrier(cmd, numBuffers, bufferBarriers, numTextures, textureBarriers);
+}
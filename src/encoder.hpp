@@ -0,0 +1,16 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+void RenderTF_CmdTransition(TheForge_CmdHandle cmd,
+														uint32_t numBuffers,
+														Render_BufferHandle const *buffers,
+														Render_BufferTransitionType const *bufferTransitions,
+														uint32_t numTextures,
+														Render_TextureHandle const *textures,
+														Render_TextureTransitionType const *textureTransitions);
+
+// the graphics encoders render pass was closed behind its back (barrier, copy or the
+// cmd beginning), the next bind must start a new one
+void RenderTF_GraphicsEncoderRenderPassEnded(Render_GraphicsEncoder *encoder);
@@ -0,0 +1,348 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "render_basics/theforge/submit.h"
+#include "gpuprofiler.hpp"
+#include "readback.hpp"
+#include "texturepool.hpp"
+#include "encoder.hpp"
+
+namespace {
+
+// a signalled timeline value, oldest first in Render_Fence::points
+struct Point {
+	uint64_t value;
+	TheForge_FenceHandle fence;
+	TheForge_SemaphoreHandle semaphore;
+	bool semaphoreWaited; ///< a binary semaphore can only be waited on once
+};
+
+// a semaphore consumed by a submit's wait, reusable once that submit has finished
+struct WaitedSemaphore {
+	TheForge_SemaphoreHandle semaphore;
+	TheForge_FenceHandle fence;       ///< of the waiting submit, not owned
+};
+
+} // end anon namespace
+
+typedef struct Render_Fence {
+	Render_RendererHandle renderer;
+	uint64_t signalledValue;
+	uint64_t completedValue;
+
+	CADT_VectorHandle points;         // Point
+	CADT_VectorHandle freeFences;     // TheForge_FenceHandle
+	CADT_VectorHandle freeSemaphores; // TheForge_SemaphoreHandle
+	CADT_VectorHandle waitedSemaphores; // WaitedSemaphore
+	CADT_VectorHandle unwaitedSemaphores; // TheForge_SemaphoreHandle, still signalled
+} Render_Fence;
+
+namespace {
+
+// a waited semaphore has already moved to waitedSemaphores, an unwaited one is still
+// signalled and can't be signalled again until something waits on it. The next submit
+// that signals this fence does that, then it's recycled like any other waited semaphore
+void RetirePoint(Render_Fence *fence, Point const *point) {
+	CADT_VectorPushElement(fence->freeFences, (void *) &point->fence);
+	if (point->semaphore) {
+		CADT_VectorPushElement(fence->unwaitedSemaphores, (void *) &point->semaphore);
+	}
+}
+
+// semaphores come back once the submit that waited on them has finished, not when
+// the submit that signalled them did
+void RecycleWaitedSemaphores(Render_Fence *fence, bool wait) {
+	size_t i = 0;
+	while (i < CADT_VectorSize(fence->waitedSemaphores)) {
+		auto waited = (WaitedSemaphore *) CADT_VectorData(fence->waitedSemaphores);
+		TheForge_FenceStatus fenceStatus;
+		TheForge_GetFenceStatus(fence->renderer->renderer, waited[i].fence, &fenceStatus);
+		if (fenceStatus == TheForge_FS_INCOMPLETE) {
+			if (!wait) {
+				++i;
+				continue;
+			}
+			TheForge_WaitForFences(fence->renderer->renderer, 1, &waited[i].fence);
+		}
+		CADT_VectorPushElement(fence->freeSemaphores, &waited[i].semaphore);
+		size_t const last = CADT_VectorSize(fence->waitedSemaphores) - 1;
+		waited[i] = waited[last];
+		CADT_VectorResize(fence->waitedSemaphores, last);
+	}
+}
+
+// retire completed points from the front, their values are in submission order
+void Update(Render_Fence *fence) {
+	auto points = (Point *) CADT_VectorData(fence->points);
+	size_t const count = CADT_VectorSize(fence->points);
+	size_t retired = 0;
+	while (retired < count) {
+		TheForge_FenceStatus fenceStatus;
+		TheForge_GetFenceStatus(fence->renderer->renderer, points[retired].fence, &fenceStatus);
+		if (fenceStatus == TheForge_FS_INCOMPLETE) {
+			break;
+		}
+		fence->completedValue = points[retired].value;
+		RetirePoint(fence, &points[retired]);
+		retired++;
+	}
+	if (retired) {
+		memmove(points, points + retired, (count - retired) * sizeof(Point));
+		CADT_VectorResize(fence->points, count - retired);
+	}
+	RecycleWaitedSemaphores(fence, false);
+}
+
+// the first pending point at or after value, null if value has completed
+Point *FindPoint(Render_Fence *fence, uint64_t value) {
+	if (value <= fence->completedValue) {
+		return nullptr;
+	}
+	auto points = (Point *) CADT_VectorData(fence->points);
+	for (size_t i = 0; i < CADT_VectorSize(fence->points); ++i) {
+		if (points[i].value >= value) {
+			return &points[i];
+		}
+	}
+	return nullptr;
+}
+
+Point *AddPoint(Render_Fence *fence, uint64_t value, bool withSemaphore) {
+	Point point{value, nullptr, nullptr, false};
+	size_t const freeFenceCount = CADT_VectorSize(fence->freeFences);
+	if (freeFenceCount) {
+		point.fence = ((TheForge_FenceHandle *) CADT_VectorData(fence->freeFences))[freeFenceCount - 1];
+		CADT_VectorResize(fence->freeFences, freeFenceCount - 1);
+	} else {
+		TheForge_AddFence(fence->renderer->renderer, &point.fence);
+	}
+	size_t const freeSemaphoreCount = CADT_VectorSize(fence->freeSemaphores);
+	if (withSemaphore && freeSemaphoreCount) {
+		point.semaphore = ((TheForge_SemaphoreHandle *) CADT_VectorData(fence->freeSemaphores))[freeSemaphoreCount - 1];
+		CADT_VectorResize(fence->freeSemaphores, freeSemaphoreCount - 1);
+	} else if (withSemaphore) {
+		TheForge_AddSemaphore(fence->renderer->renderer, &point.semaphore);
+	}
+	size_t const index = CADT_VectorPushElement(fence->points, &point);
+	fence->signalledValue = value;
+	return ((Point *) CADT_VectorData(fence->points)) + index;
+}
+
+// Render_QueueSubmit has no renderer handle, every encoder knows it
+Render_RendererHandle SubmitRenderer(Render_QueueSubmitDesc const *desc) {
+	if (desc->graphicsEncoderCount) {
+		return Render_GraphicsEncoderHandleToPtr(desc->graphicsEncoders[0])->renderer;
+	}
+	if (desc->computeEncoderCount) {
+		return Render_ComputeEncoderHandleToPtr(desc->computeEncoders[0])->renderer;
+	}
+	if (desc->blitEncoderCount) {
+		return Render_BlitEncoderHandleToPtr(desc->blitEncoders[0])->renderer;
+	}
+	if (desc->waitCount) {
+		return desc->waits[0].fence->renderer;
+	}
+	return desc->signal.fence ? desc->signal.fence->renderer : nullptr;
+}
+
+} // end anon namespace
+
+AL2O3_EXTERN_C Render_FenceHandle Render_FenceCreate(Render_RendererHandle renderer) {
+	auto fence = (Render_Fence *) MEMORY_CALLOC(1, sizeof(Render_Fence));
+	if (!fence) {
+		return nullptr;
+	}
+	fence->renderer = renderer;
+	fence->points = CADT_VectorCreate(sizeof(Point));
+	fence->freeFences = CADT_VectorCreate(sizeof(TheForge_FenceHandle));
+	fence->freeSemaphores = CADT_VectorCreate(sizeof(TheForge_SemaphoreHandle));
+	fence->waitedSemaphores = CADT_VectorCreate(sizeof(WaitedSemaphore));
+	fence->unwaitedSemaphores = CADT_VectorCreate(sizeof(TheForge_SemaphoreHandle));
+	return fence;
+}
+
+AL2O3_EXTERN_C void Render_FenceDestroy(Render_RendererHandle renderer, Render_FenceHandle fence) {
+	if (!renderer || !fence) {
+		return;
+	}
+
+	Render_FenceWait(fence, fence->signalledValue);
+	RecycleWaitedSemaphores(fence, true);
+
+	// readback and the texture pool can still be holding our fences for a few frames,
+	// the renderers submit fence adopts them so they live until the renderer does
+	auto fences = (TheForge_FenceHandle *) CADT_VectorData(fence->freeFences);
+	for (size_t i = 0; i < CADT_VectorSize(fence->freeFences); ++i) {
+		if (renderer->submitFence && renderer->submitFence != fence) {
+			CADT_VectorPushElement(renderer->submitFence->freeFences, &fences[i]);
+		} else {
+			TheForge_RemoveFence(renderer->renderer, fences[i]);
+		}
+	}
+	auto semaphores = (TheForge_SemaphoreHandle *) CADT_VectorData(fence->freeSemaphores);
+	for (size_t i = 0; i < CADT_VectorSize(fence->freeSemaphores); ++i) {
+		TheForge_RemoveSemaphore(renderer->renderer, semaphores[i]);
+	}
+	semaphores = (TheForge_SemaphoreHandle *) CADT_VectorData(fence->unwaitedSemaphores);
+	for (size_t i = 0; i < CADT_VectorSize(fence->unwaitedSemaphores); ++i) {
+		TheForge_RemoveSemaphore(renderer->renderer, semaphores[i]);
+	}
+
+	CADT_VectorDestroy(fence->unwaitedSemaphores);
+	CADT_VectorDestroy(fence->waitedSemaphores);
+	CADT_VectorDestroy(fence->freeSemaphores);
+	CADT_VectorDestroy(fence->freeFences);
+	CADT_VectorDestroy(fence->points);
+	MEMORY_FREE(fence);
+}
+
+AL2O3_EXTERN_C uint64_t Render_FenceGetSignalledValue(Render_FenceHandle fence) {
+	return fence->signalledValue;
+}
+
+AL2O3_EXTERN_C uint64_t Render_FencePoll(Render_FenceHandle fence) {
+	Update(fence);
+	return fence->completedValue;
+}
+
+AL2O3_EXTERN_C void Render_FenceWait(Render_FenceHandle fence, uint64_t value) {
+	if (value > fence->signalledValue) {
+		LOGERROR("Waiting for fence value %llu that hasn't been signalled (last %llu)",
+						 (unsigned long long) value, (unsigned long long) fence->signalledValue);
+		return;
+	}
+
+	Update(fence);
+	Point *point = FindPoint(fence, value);
+	if (point) {
+		TheForge_WaitForFences(fence->renderer->renderer, 1, &point->fence);
+		Update(fence);
+	}
+}
+
+AL2O3_EXTERN_C void Render_GraphicsEncoderBegin(Render_GraphicsEncoderHandle handle) {
+	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	encoder->view = Render_View{};
+	encoder->skipDraws = false;
+	encoder->pendingClear = nullptr;
+	TheForge_BeginCmd(encoder->cmd);
+	RenderTF_GraphicsEncoderRenderPassEnded(encoder);
+	RenderTF_GpuTimerBegin(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_QueueSubmit(Render_QueueHandle queue, Render_QueueSubmitDesc const *desc) {
+	uint32_t const cmdCount = desc->graphicsEncoderCount + desc->computeEncoderCount + desc->blitEncoderCount;
+	auto cmds = (TheForge_CmdHandle *) STACK_ALLOC(sizeof(TheForge_CmdHandle) * (cmdCount ? cmdCount : 1));
+
+	uint32_t cmdIndex = 0;
+	for (uint32_t i = 0; i < desc->graphicsEncoderCount; ++i) {
+		Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(desc->graphicsEncoders[i]);
+		RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
+		cmds[cmdIndex++] = encoder->cmd;
+	}
+	for (uint32_t i = 0; i < desc->computeEncoderCount; ++i) {
+		Render_ComputeEncoder* encoder = Render_ComputeEncoderHandleToPtr(desc->computeEncoders[i]);
+		RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
+		encoder->submitted = false;
+		cmds[cmdIndex++] = encoder->cmd;
+	}
+	for (uint32_t i = 0; i < desc->blitEncoderCount; ++i) {
+		Render_BlitEncoder* encoder = Render_BlitEncoderHandleToPtr(desc->blitEncoders[i]);
+		RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
+		encoder->submitted = false;
+		cmds[cmdIndex++] = encoder->cmd;
+	}
+	for (uint32_t i = 0; i < cmdCount; ++i) {
+		TheForge_EndCmd(cmds[i]);
+	}
+
+	// the signalled fences retired but never waited semaphores are waited on by this
+	// submit, which leaves them unsignalled and free once it has finished
+	Render_FenceHandle const signalOwner = desc->signal.fence;
+	uint32_t unwaitedCount = 0;
+	if (signalOwner) {
+		Update(signalOwner);
+		unwaitedCount = (uint32_t) CADT_VectorSize(signalOwner->unwaitedSemaphores);
+	}
+	uint32_t const maxWaits = desc->waitCount + unwaitedCount;
+	auto waitSemaphores = (TheForge_SemaphoreHandle *) STACK_ALLOC(
+			sizeof(TheForge_SemaphoreHandle) * (maxWaits ? maxWaits : 1));
+	auto waitOwners = (Render_FenceHandle *) STACK_ALLOC(sizeof(Render_FenceHandle) * (maxWaits ? maxWaits : 1));
+	uint32_t waitSemaphoreCount = 0;
+	for (uint32_t i = 0; i < desc->waitCount; ++i) {
+		Render_FenceHandle fence = desc->waits[i].fence;
+		uint64_t const value = desc->waits[i].value;
+		if (value > fence->signalledValue) {
+			LOGERROR("Submit waits for fence value %llu that hasn't been signalled (last %llu), ignoring the wait",
+							 (unsigned long long) value, (unsigned long long) fence->signalledValue);
+			continue;
+		}
+
+		Update(fence);
+		Point *point = FindPoint(fence, value);
+		if (!point) {
+			continue;
+		}
+		if (point->semaphoreWaited) {
+			// already consumed by another submit, only the cpu can wait now
+			TheForge_WaitForFences(fence->renderer->renderer, 1, &point->fence);
+			continue;
+		}
+		point->semaphoreWaited = true;
+		waitOwners[waitSemaphoreCount] = fence;
+		waitSemaphores[waitSemaphoreCount++] = point->semaphore;
+		point->semaphore = nullptr;
+	}
+	if (unwaitedCount) {
+		auto unwaited = (TheForge_SemaphoreHandle *) CADT_VectorData(signalOwner->unwaitedSemaphores);
+		for (uint32_t i = 0; i < unwaitedCount; ++i) {
+			waitOwners[waitSemaphoreCount] = signalOwner;
+			waitSemaphores[waitSemaphoreCount++] = unwaited[i];
+		}
+		CADT_VectorResize(signalOwner->unwaitedSemaphores, 0);
+	}
+
+	TheForge_FenceHandle signalFence = nullptr;
+	TheForge_SemaphoreHandle signalSemaphore = nullptr;
+	if (desc->signal.fence) {
+		Render_FenceHandle fence = desc->signal.fence;
+		if (desc->signal.value <= fence->signalledValue) {
+			LOGERROR("Fence signal value %llu must be greater than the last signalled %llu",
+							 (unsigned long long) desc->signal.value, (unsigned long long) fence->signalledValue);
+		} else {
+			Point const *point = AddPoint(fence, desc->signal.value, true);
+			signalFence = point->fence;
+			signalSemaphore = point->semaphore;
+		}
+	}
+	// readbacks need a fence to complete with even if the caller doesn't want one
+	Render_RendererHandle renderer = SubmitRenderer(desc);
+	if (!signalFence && renderer) {
+		Render_FenceHandle own = renderer->submitFence;
+		Update(own);
+		signalFence = AddPoint(own, own->signalledValue + 1, false)->fence;
+	}
+
+	TheForge_QueueSubmit(Render_QueueHandleToPtr(queue)->queue,
+											 cmdCount,
+											 cmds,
+											 signalFence,
+											 waitSemaphoreCount,
+											 waitSemaphores,
+											 signalSemaphore ? 1 : 0,
+											 &signalSemaphore);
+	for (uint32_t i = 0; i < waitSemaphoreCount; ++i) {
+		WaitedSemaphore const waited{waitSemaphores[i], signalFence};
+		CADT_VectorPushElement(waitOwners[i]->waitedSemaphores, (void *) &waited);
+	}
+	if (renderer && desc->graphicsEncoderCount) {
+		RenderTF_ReadbackSubmitted(renderer, signalFence);
+	}
+	if (renderer) {
+		RenderTF_TexturePoolFrameSubmitted(renderer, signalFence);
+	}
+}
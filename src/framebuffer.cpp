@@ -5,10 +5,354 @@
 #include "gfx_imgui_al2o3_theforge_bindings/bindings.h"
 
 #include "render_basics/theforge/handlemanager.h"
+#include "render_basics/buffer.h"
 #include "render_basics/framebuffer.h"
 #include "render_basics/graphicsencoder.h"
 #include "render_basics/view.h"
+#include "render_basics/theforge/computeencoder.h"
+#include "render_basics/theforge/headless.h"
+#include "render_basics/theforge/latelatch.h"
+#include "render_basics/theforge/multiwindow.h"
+#include "render_basics/theforge/recorder.h"
+#include "render_basics/theforge/throttle.h"
 #include "visdebug.hpp"
+#include "readback.hpp"
+#include "texturepool.hpp"
+#include "gpuprofiler.hpp"
+#include "dynamicresolution.hpp"
+#include "recorder.hpp"
+#include "encoder.hpp"
+#include "framebuffer.hpp"
+#include <chrono>
+
+namespace {
+
+struct PendingReadback {
+	Render_ReadbackTicket ticket;
+	bool valid;
+};
+
+// a headless (or stand in) target ring replaced by a resize, in flight frames may still
+// be using it
+struct RetiredHeadlessTargets {
+	Render_TextureHandle *headlessTargets;
+	uint64_t frame;  ///< renderer frame count when it was replaced
+};
+
+} // end anon namespace
+
+struct RenderTF_Headless {
+	Render_TextureHandle *targets;  ///< swapChainImageCount offscreen colour targets
+	Render_FrameBufferReadbackFunc readbackFunc;
+	void *readbackUserData;
+	PendingReadback *pending;       ///< per frame in flight
+};
+
+namespace {
+
+double NowMs() {
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// exponential moving average over roughly 30 frames
+void AccumulateTiming(Render_FrameBuffer *frameBuffer) {
+	double const alpha = 1.0 / 30.0;
+	Render_FrameTimingStats const &last = frameBuffer->timing;
+	Render_FrameTimingStats &average = frameBuffer->averageTiming;
+	average.waitMs += (last.waitMs - average.waitMs) * alpha;
+	average.acquireMs += (last.acquireMs - average.acquireMs) * alpha;
+	average.submitMs += (last.submitMs - average.submitMs) * alpha;
+	average.presentMs += (last.presentMs - average.presentMs) * alpha;
+	average.frameMs += (last.frameMs - average.frameMs) * alpha;
+}
+
+void WaitForFence(TheForge_RendererHandle renderer, TheForge_FenceHandle fence) {
+	TheForge_FenceStatus fenceStatus;
+	TheForge_GetFenceStatus(renderer, fence, &fenceStatus);
+	if (fenceStatus == TheForge_FS_INCOMPLETE) {
+		TheForge_WaitForFences(renderer, 1, &fence);
+	}
+}
+
+bool CreateSwapChain(Render_FrameBuffer *frameBuffer, uint32_t width, uint32_t height, bool vsync) {
+	TheForge_QueueHandle qs[] = {Render_QueueHandleToPtr(frameBuffer->presentQueue)->queue};
+	TheForge_SwapChainDesc swapChainDesc;
+	swapChainDesc.window = frameBuffer->platformHandle;
+	swapChainDesc.presentQueueCount = 1;
+	swapChainDesc.pPresentQueues = qs;
+	swapChainDesc.width = width;
+	swapChainDesc.height = height;
+	swapChainDesc.imageCount = frameBuffer->swapChainImageCount;
+	swapChainDesc.sampleCount = TheForge_SC_1;
+	swapChainDesc.sampleQuality = 0;
+	swapChainDesc.colorFormat = frameBuffer->colourBufferFormat;
+	swapChainDesc.enableVsync = vsync;
+	swapChainDesc.colorClearValue = {0, 0, 0, 1};
+	frameBuffer->swapChain = nullptr;
+	TheForge_AddSwapChain(frameBuffer->renderer->renderer, &swapChainDesc, &frameBuffer->swapChain);
+	return frameBuffer->swapChain != nullptr;
+}
+
+void DestroyHeadlessTargets(Render_FrameBuffer *frameBuffer, Render_TextureHandle *targets);
+
+// null if any target can't be created
+Render_TextureHandle *CreateHeadlessTargets(Render_FrameBuffer *frameBuffer, uint32_t width, uint32_t height) {
+	Render_TextureCreateDesc desc{};
+	desc.format = frameBuffer->colourBufferFormat;
+	desc.usageflags = (Render_TextureUsageFlags) (Render_TUF_ROP_WRITE | Render_TUF_SHADER_READ);
+	desc.width = width;
+	desc.height = height;
+	desc.depth = 1;
+	desc.slices = 1;
+	desc.mipLevels = 1;
+	desc.renderTargetClearValue = {0, 0, 0, 1};
+	desc.debugName = "Headless frame buffer";
+
+	auto targets = (Render_TextureHandle *) MEMORY_CALLOC(frameBuffer->swapChainImageCount, sizeof(Render_TextureHandle));
+	for (uint32_t i = 0; i < frameBuffer->swapChainImageCount; ++i) {
+		targets[i] = Render_TextureSyncCreate(frameBuffer->renderer, &desc);
+		if (!Render_TextureHandleIsValid(targets[i])) {
+			LOGERROR("Unable to create a %ux%u headless frame buffer target", width, height);
+			DestroyHeadlessTargets(frameBuffer, targets);
+			return nullptr;
+		}
+	}
+	return targets;
+}
+
+void DestroyHeadlessTargets(Render_FrameBuffer *frameBuffer, Render_TextureHandle *targets) {
+	if (!targets) {
+		return;
+	}
+	for (uint32_t i = 0; i < frameBuffer->swapChainImageCount; ++i) {
+		if (Render_TextureHandleIsValid(targets[i])) {
+			Render_TextureDestroy(frameBuffer->renderer, targets[i]);
+		}
+	}
+	MEMORY_FREE(targets);
+}
+
+// every frame slot is waited on by NewFrame before reuse, so once a slots worth of
+// frames have passed nothing in flight can reference retired headless targets.
+// force is only for destroy, after all fences have been waited on
+void ReleaseRetiredHeadlessTargets(Render_FrameBuffer *frameBuffer, bool force) {
+	size_t i = 0;
+	while (i < CADT_VectorSize(frameBuffer->retiredHeadlessTargets)) {
+		auto retired = (RetiredHeadlessTargets *) CADT_VectorData(frameBuffer->retiredHeadlessTargets);
+		if (!force && frameBuffer->renderer->frameCount - retired[i].frame <= frameBuffer->frameBufferCount) {
+			++i;
+			continue;
+		}
+		DestroyHeadlessTargets(frameBuffer, retired[i].headlessTargets);
+		size_t const last = CADT_VectorSize(frameBuffer->retiredHeadlessTargets) - 1;
+		retired[i] = retired[last];
+		CADT_VectorResize(frameBuffer->retiredHeadlessTargets, last);
+	}
+}
+
+// headless targets are replaced straight away and the old ones retired. TheForge's
+// AddSwapChain doesn't expose vulkans oldSwapchain (or dxgi's ResizeBuffers) so the old
+// swap chain is removed first, which only needs this frame buffers slots to finish not
+// the whole queue to drain. If the new one can't be made the old size (and vsync) is
+// kept, if that fails too frames go to stand in targets and nothing is presented until
+// a later NewFrame manages to create one
+void ApplyResize(Render_FrameBuffer *frameBuffer) {
+	uint32_t const width = frameBuffer->pendingWidth;
+	uint32_t const height = frameBuffer->pendingHeight;
+	frameBuffer->resizePending = false;
+
+	if (frameBuffer->headless) {
+		Render_TextureHandle *targets = CreateHeadlessTargets(frameBuffer, width, height);
+		if (!targets) {
+			return;
+		}
+		RetiredHeadlessTargets retired{frameBuffer->headless->targets, frameBuffer->renderer->frameCount};
+		frameBuffer->headless->targets = targets;
+		CADT_VectorPushElement(frameBuffer->retiredHeadlessTargets, &retired);
+	} else {
+		auto renderer = (TheForge_RendererHandle) frameBuffer->renderer->renderer;
+		bool const lost = frameBuffer->swapChain == nullptr;
+		if (!lost) {
+			for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+				WaitForFence(renderer, frameBuffer->slotFences[i]);
+			}
+			TheForge_RemoveSwapChain(renderer, frameBuffer->swapChain);
+		}
+
+		if (!CreateSwapChain(frameBuffer, width, height, frameBuffer->pendingVsync)) {
+			frameBuffer->pendingVsync = frameBuffer->vsync;
+			if (lost) {
+				return;
+			}
+			LOGERROR("Unable to resize the swap chain to %ux%u", width, height);
+			uint32_t const oldWidth = (uint32_t) frameBuffer->entireScissor.z;
+			uint32_t const oldHeight = (uint32_t) frameBuffer->entireScissor.w;
+			if (!CreateSwapChain(frameBuffer, oldWidth, oldHeight, frameBuffer->vsync)) {
+				LOGERROR("Unable to recreate the swap chain, nothing will be presented until it can be");
+				frameBuffer->pendingWidth = oldWidth;
+				frameBuffer->pendingHeight = oldHeight;
+				frameBuffer->standInTargets = CreateHeadlessTargets(frameBuffer, oldWidth, oldHeight);
+			}
+			return;
+		}
+		frameBuffer->vsync = frameBuffer->pendingVsync;
+		if (frameBuffer->standInTargets) {
+			RetiredHeadlessTargets retired{frameBuffer->standInTargets, frameBuffer->renderer->frameCount};
+			frameBuffer->standInTargets = nullptr;
+			CADT_VectorPushElement(frameBuffer->retiredHeadlessTargets, &retired);
+		}
+	}
+
+	frameBuffer->entireScissor.z = width;
+	frameBuffer->entireScissor.w = height;
+	frameBuffer->entireViewport.z = (float) width;
+	frameBuffer->entireViewport.w = (float) height;
+
+	if (frameBuffer->imguiBindings) {
+		ImguiBindings_SetWindowSize(frameBuffer->imguiBindings, width, height);
+	}
+	if (frameBuffer->dynamicResolution) {
+		RenderTF_DynamicResolutionResize(frameBuffer->dynamicResolution, width, height);
+	}
+}
+
+// scene rendering is finished, upscale into the output so the overlays draw at full size
+void ResolveDynamicResolution(Render_FrameBuffer *frameBuffer) {
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(frameBuffer->graphicsEncoder);
+	Render_TextureHandle textures[] = {frameBuffer->currentColourTarget};
+	if (encoder->pendingClear) {
+		// nothing bound the scene target this frame, it still needs its clear
+		Render_GraphicsEncoderBindRenderTargets(frameBuffer->graphicsEncoder, 1, textures, false, false, false);
+	}
+	Render_TextureTransitionType textureTransitions[] = {RENDER_TTT_SHADER_ACCESS};
+	Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder, 0, nullptr, nullptr, 1, textures, textureTransitions);
+
+	Render_Texture *tex = Render_TextureHandleToPtr(frameBuffer->currentColourTarget);
+	tex->renderTarget = frameBuffer->outputRenderTarget;
+	tex->texture = TheForge_RenderTargetGetTexture(tex->renderTarget);
+	frameBuffer->scaledRendering = false;
+
+	textureTransitions[0] = Render_TTT_RENDER_TARGET;
+	Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder, 0, nullptr, nullptr, 1, textures, textureTransitions);
+	// every pixel is overwritten, a clear is never more expensive than loading it
+	encoder->pendingClear = frameBuffer->outputRenderTarget;
+	Render_GraphicsEncoderBindRenderTargets(frameBuffer->graphicsEncoder, 1, textures, false, true, true);
+	RenderTF_DynamicResolutionUpscale(frameBuffer->dynamicResolution,
+																		frameBuffer->graphicsEncoder,
+																		frameBuffer->entireViewport,
+																		frameBuffer->entireScissor);
+}
+
+// hands finished readbacks to the callback, never blocks
+void DeliverHeadlessReadbacks(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer *frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	RenderTF_Headless *headless = frameBuffer->headless;
+
+	for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+		PendingReadback &pending = headless->pending[i];
+		if (!pending.valid) {
+			continue;
+		}
+		Render_ReadbackData data;
+		Render_ReadbackStatus const status = Render_ReadbackPoll(frameBuffer->renderer, pending.ticket, &data);
+		if (status == Render_RS_PENDING) {
+			continue;
+		}
+		pending.valid = false;
+		if (status == Render_RS_READY) {
+			headless->readbackFunc(handle, pending.ticket.frame, &data, headless->readbackUserData);
+		} else {
+			LOGWARNING("Headless frame buffer readback expired before it was delivered");
+		}
+	}
+}
+
+// one Render_GpuView per frame in flight in a persistently mapped frequently updated
+// buffer, so descriptors written with Render_DescriptorPresetFrequencyUpdated see it
+// false (with nothing left allocated) if the buffer can't be created
+bool CreateViewConstants(Render_FrameBuffer *fb) {
+	uint64_t const slotSize = ((sizeof(Render_GpuView) + UNIFORM_BUFFER_MIN_SIZE - 1) / UNIFORM_BUFFER_MIN_SIZE) * UNIFORM_BUFFER_MIN_SIZE;
+
+	fb->viewConstants = Render_BufferHandleAlloc();
+	Render_Buffer *buffer = Render_BufferHandleToPtr(fb->viewConstants);
+	buffer->renderer = fb->renderer;
+	buffer->size = slotSize;
+	buffer->frequentlyUpdated = true;
+
+	TheForge_BufferDesc const ubDesc{
+			slotSize * fb->frameBufferCount,
+			TheForge_RMU_CPU_TO_GPU,
+			(TheForge_BufferCreationFlags) (TheForge_BCF_PERSISTENT_MAP_BIT | TheForge_BCF_NO_DESCRIPTOR_VIEW_CREATION),
+			TheForge_RS_UNDEFINED,
+			TheForge_IT_UINT16,
+			0,
+			0,
+			0,
+			0,
+			TheForge_IAT_DRAW,
+			0,
+			0,
+			nullptr,
+			TinyImageFormat_UNDEFINED,
+			TheForge_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+	};
+	buffer->buffer = nullptr;
+	TheForge_AddBuffer(fb->renderer->renderer, &ubDesc, &buffer->buffer);
+	if (!buffer->buffer) {
+		LOGERROR("Unable to create the frame buffers view constants");
+		Render_BufferHandleRelease(fb->viewConstants);
+		fb->viewConstants = {0};
+		fb->viewConstantsData = nullptr;
+		return false;
+	}
+	fb->viewConstantsData = (uint8_t *) TheForge_BufferGetCpuMappedAddress(buffer->buffer);
+	memset(fb->viewConstantsData, 0, slotSize * fb->frameBufferCount);
+	return true;
+}
+
+// the slot was last read by the submit that the slots fence waited for, so it's free
+void LatchView(Render_FrameBuffer *frameBuffer, uint32_t frameIndex) {
+	Render_Buffer const *buffer = Render_BufferHandleToPtr(frameBuffer->viewConstants);
+	memcpy(frameBuffer->viewConstantsData + (frameIndex * buffer->size), frameBuffer->latchedView, sizeof(Render_GpuView));
+}
+
+// swap chains are only rebuilt by a resize, so a vsync change is one at the current size
+void UpdateVsync(Render_FrameBuffer *frameBuffer) {
+	bool const vsync = !frameBuffer->focused && frameBuffer->throttle.backgroundVsync;
+	if (frameBuffer->headless || vsync == frameBuffer->pendingVsync) {
+		return;
+	}
+	frameBuffer->pendingVsync = vsync;
+	if (!frameBuffer->resizePending) {
+		frameBuffer->resizePending = true;
+		frameBuffer->pendingWidth = frameBuffer->entireScissor.z;
+		frameBuffer->pendingHeight = frameBuffer->entireScissor.w;
+	}
+}
+
+bool IsDirty(Render_FrameBuffer *frameBuffer) {
+	if (frameBuffer->dirty || frameBuffer->resizePending) {
+		return true;
+	}
+	if (frameBuffer->seenResourceUpdateCount != frameBuffer->renderer->resourceUpdateCount) {
+		return true;
+	}
+	if (frameBuffer->visualDebug && RenderTF_VisualDebugHasPrimitives(frameBuffer->visualDebug)) {
+		return true;
+	}
+	// readbacks are only delivered by later frames
+	if (frameBuffer->headless && frameBuffer->headless->readbackFunc) {
+		for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+			if (frameBuffer->headless->pending[i].valid) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+} // end anon namespace
 
 AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 		Render_RendererHandle renderer,
@@ -16,7 +360,6 @@ AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 	ASSERT(desc->frameBufferWidth);
 	ASSERT(desc->frameBufferHeight);
 	ASSERT(Render_QueueHandleIsValid(desc->queue));
-	ASSERT(desc->platformHandle);
 
 	auto tfrenderer = (TheForge_RendererHandle) renderer->renderer;
 
@@ -27,37 +370,65 @@ AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 	fb->commandPool = renderer->graphicsCmdPool;
 	fb->presentQueue = desc->queue;
 	fb->frameBufferCount = renderer->maxFramesAhead;
+	fb->rendererFrame = ~0ull;
+	fb->swapChainImageCount = renderer->swapChainImageCount;
 	fb->platformHandle = desc->platformHandle;
 
 	fb->renderCompleteFences = (TheForge_FenceHandle *) MEMORY_CALLOC(fb->frameBufferCount, sizeof(TheForge_FenceHandle));
 	fb->renderCompleteSemaphores =
 			(TheForge_SemaphoreHandle *) MEMORY_CALLOC(fb->frameBufferCount, sizeof(TheForge_SemaphoreHandle));
+	fb->imageAcquiredSemaphores =
+			(TheForge_SemaphoreHandle *) MEMORY_CALLOC(fb->frameBufferCount, sizeof(TheForge_SemaphoreHandle));
+
+	fb->slotFences = (TheForge_FenceHandle *) MEMORY_CALLOC(fb->frameBufferCount, sizeof(TheForge_FenceHandle));
 
 	for (uint32_t i = 0; i < fb->frameBufferCount; ++i) {
 		TheForge_AddFence(tfrenderer, &fb->renderCompleteFences[i]);
+		fb->slotFences[i] = fb->renderCompleteFences[i];
 		TheForge_AddSemaphore(tfrenderer, &fb->renderCompleteSemaphores[i]);
+		TheForge_AddSemaphore(tfrenderer, &fb->imageAcquiredSemaphores[i]);
 	}
-	TheForge_AddSemaphore(tfrenderer, &fb->imageAcquiredSemaphore);
+	TheForge_AddSemaphore(tfrenderer, &fb->computeSignalSemaphore);
+	fb->signalCompute = false;
+	fb->computeSignalPending = false;
+	fb->computeWaitCount = 0;
 
 	TheForge_AddCmd_n( fb->commandPool, false, fb->frameBufferCount, &fb->frameCmds);
+	fb->frameTimers = (RenderTF_GpuTimer **) MEMORY_CALLOC(fb->frameBufferCount, sizeof(RenderTF_GpuTimer *));
+	for (uint32_t i = 0; i < fb->frameBufferCount; ++i) {
+		fb->frameTimers[i] = RenderTF_GpuTimerCreate(renderer, Render_QT_GRAPHICS);
+	}
 
-	TheForge_QueueHandle qs[] = {Render_QueueHandleToPtr(desc->queue)->queue};
-	TheForge_SwapChainDesc swapChainDesc;
-	swapChainDesc.window = desc->platformHandle;
-	swapChainDesc.presentQueueCount = 1;
-	swapChainDesc.pPresentQueues = qs;
-	swapChainDesc.width = desc->frameBufferWidth;
-	swapChainDesc.height = desc->frameBufferHeight;
-	swapChainDesc.imageCount = fb->frameBufferCount;
-	swapChainDesc.sampleCount = TheForge_SC_1;
-	swapChainDesc.sampleQuality = 0;
-	swapChainDesc.colorFormat = desc->colourFormat != TinyImageFormat_UNDEFINED ?
-															desc->colourFormat : TinyImageFormat_B8G8R8A8_SRGB;
-	swapChainDesc.enableVsync = false;
-	swapChainDesc.colorClearValue = {0, 0, 0, 1};
-	TheForge_AddSwapChain(tfrenderer, &swapChainDesc, &fb->swapChain);
+	fb->colourBufferFormat = desc->colourFormat != TinyImageFormat_UNDEFINED ?
+													 desc->colourFormat : TinyImageFormat_B8G8R8A8_SRGB;
+
+	fb->throttle = Render_FrameBufferThrottleDesc{};
+	fb->focused = true;
+	fb->minimised = false;
+	fb->dirty = true;
+	fb->vsync = false;
+	fb->pendingVsync = false;
+	fb->seenResourceUpdateCount = renderer->resourceUpdateCount;
+	fb->lastRenderMs = 0.0;
+
+	bool targetsOkay;
+	if (desc->platformHandle) {
+		targetsOkay = CreateSwapChain(fb, desc->frameBufferWidth, desc->frameBufferHeight, fb->vsync);
+		if (!targetsOkay) {
+			LOGERROR("Unable to create the frame buffers swap chain");
+		}
+	} else {
+		fb->headless = (RenderTF_Headless *) MEMORY_CALLOC(1, sizeof(RenderTF_Headless));
+		fb->headless->targets = CreateHeadlessTargets(fb, desc->frameBufferWidth, desc->frameBufferHeight);
+		targetsOkay = fb->headless->targets != nullptr;
+		fb->headless->pending = (PendingReadback *) MEMORY_CALLOC(fb->frameBufferCount, sizeof(PendingReadback));
+		// NewFrame advances before use so the first frame renders into target 0
+		fb->imageIndex = fb->swapChainImageCount - 1;
+	}
+	fb->resizePending = false;
+	fb->standInTargets = nullptr;
+	fb->retiredHeadlessTargets = CADT_VectorCreate(sizeof(RetiredHeadlessTargets));
 
-	fb->colourBufferFormat = swapChainDesc.colorFormat;
 	fb->entireViewport.x = 0.0f;
 	fb->entireScissor.x = 0;
 	fb->entireViewport.y = 0.0f;
@@ -67,9 +438,13 @@ AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 	fb->entireViewport.z = (float) desc->frameBufferWidth;
 	fb->entireViewport.w = (float) desc->frameBufferHeight;
 
+	fb->latchedView = (Render_GpuView *) MEMORY_CALLOC(1, sizeof(Render_GpuView));
+	if (!CreateViewConstants(fb)) {
+		targetsOkay = false;
+	}
+
 	if (desc->visualDebugTarget) {
 		fb->visualDebug = RenderTF_VisualDebugCreate(renderer, fbHandle);
-		fb->debugGpuView = (Render_GpuView *) MEMORY_CALLOC(1, sizeof(Render_GpuView));
 	}
 
 	if (desc->embeddedImgui) {
@@ -93,7 +468,7 @@ AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 																						 &shared,
 																						 20,
 																						 fb->frameBufferCount,
-																						 swapChainDesc.colorFormat,
+																						 fb->colourBufferFormat,
 																						 TheForge_SC_1,
 																						 0);
 		if (fb->imguiBindings) {
@@ -104,7 +479,20 @@ AL2O3_EXTERN_C Render_FrameBufferHandle Render_FrameBufferCreate(
 	}
 
 	fb->currentColourTarget = Render_TextureHandleAlloc();
+	Render_Texture *colourTarget = Render_TextureHandleToPtr(fb->currentColourTarget);
+	colourTarget->renderer = renderer;
+	colourTarget->frameBuffer = fbHandle;
+	colourTarget->texture = nullptr;
+	colourTarget->renderTarget = nullptr;
 	fb->graphicsEncoder = Render_GraphicsEncoderHandleAlloc();
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(fb->graphicsEncoder);
+	encoder->renderer = renderer;
+
+	// built completely so destroy doesn't need to know how far it got
+	if (!targetsOkay) {
+		Render_FrameBufferDestroy(renderer, fbHandle);
+		return {0};
+	}
 	return fbHandle;
 }
 
@@ -113,134 +501,221 @@ AL2O3_EXTERN_C void Render_FrameBufferDestroy(Render_RendererHandle renderer, Re
 
 	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
 
-	TheForge_WaitForFences(renderer->renderer, frameBuffer->frameBufferCount, frameBuffer->renderCompleteFences);
+	TheForge_WaitForFences(renderer->renderer, frameBuffer->frameBufferCount, frameBuffer->slotFences);
 
 	TheForge_WaitQueueIdle(Render_QueueHandleToPtr(frameBuffer->presentQueue)->queue);
 
 	Render_GraphicsEncoderHandleRelease(frameBuffer->graphicsEncoder);
 	Render_TextureHandleRelease(frameBuffer->currentColourTarget);
 
+	RenderTF_DynamicResolutionDestroy(frameBuffer->dynamicResolution);
+	RenderTF_RecorderDestroy(frameBuffer->recorder);
+
 	if (frameBuffer->visualDebug) {
-		MEMORY_FREE(frameBuffer->debugGpuView);
 		RenderTF_VisualDebugDestroy(frameBuffer->visualDebug);
 	}
+	Render_BufferDestroy(renderer, frameBuffer->viewConstants);
+	MEMORY_FREE(frameBuffer->latchedView);
 
 	if (frameBuffer->imguiBindings) {
 		ImguiBindings_Destroy(frameBuffer->imguiBindings);
 	}
 
+	ReleaseRetiredHeadlessTargets(frameBuffer, true);
+	CADT_VectorDestroy(frameBuffer->retiredHeadlessTargets);
+	DestroyHeadlessTargets(frameBuffer, frameBuffer->standInTargets);
+
 	if (frameBuffer->swapChain) {
 		TheForge_RemoveSwapChain(renderer->renderer, frameBuffer->swapChain);
 	}
 
+	if (frameBuffer->headless) {
+		DestroyHeadlessTargets(frameBuffer, frameBuffer->headless->targets);
+		MEMORY_FREE(frameBuffer->headless->pending);
+		MEMORY_FREE(frameBuffer->headless);
+	}
+
 	TheForge_RemoveCmd_n(frameBuffer->commandPool, frameBuffer->frameBufferCount, frameBuffer->frameCmds);
+	for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+		RenderTF_GpuTimerDestroy(renderer, frameBuffer->frameTimers[i]);
+	}
+	MEMORY_FREE(frameBuffer->frameTimers);
 
-	TheForge_RemoveSemaphore(renderer->renderer, frameBuffer->imageAcquiredSemaphore);
+	TheForge_RemoveSemaphore(renderer->renderer, frameBuffer->computeSignalSemaphore);
 
 	for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+		for (uint32_t j = 0; j < renderer->maxFramesAhead; ++j) {
+			if (renderer->frameIndexFences[j] == frameBuffer->renderCompleteFences[i]) {
+				renderer->frameIndexFences[j] = nullptr;
+			}
+		}
 		TheForge_RemoveFence(renderer->renderer, frameBuffer->renderCompleteFences[i]);
 		TheForge_RemoveSemaphore(renderer->renderer, frameBuffer->renderCompleteSemaphores[i]);
+		TheForge_RemoveSemaphore(renderer->renderer, frameBuffer->imageAcquiredSemaphores[i]);
 	}
 
 
 	MEMORY_FREE(frameBuffer->renderCompleteFences);
+	MEMORY_FREE(frameBuffer->slotFences);
 	MEMORY_FREE(frameBuffer->renderCompleteSemaphores);
+	MEMORY_FREE(frameBuffer->imageAcquiredSemaphores);
 
 	Render_FrameBufferHandleRelease(handle);
 
 }
 AL2O3_EXTERN_C void Render_FrameBufferResize(Render_FrameBufferHandle handle, uint32_t width, uint32_t height) {
-
-	TheForge_FlushResourceUpdates();
-
 	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
 
-	Render_QueueWaitIdle(frameBuffer->presentQueue);
-
-	if(frameBuffer->swapChain) {
-		TheForge_RemoveSwapChain(frameBuffer->renderer->renderer, frameBuffer->swapChain);
-		frameBuffer->swapChain = nullptr;
-	}
+	// only the last size before the next NewFrame is built
+	frameBuffer->resizePending = true;
+	frameBuffer->pendingWidth = width;
+	frameBuffer->pendingHeight = height;
+}
 
-	TheForge_QueueHandle qs[] = { Render_QueueHandleToPtr(frameBuffer->presentQueue)->queue };
-	TheForge_SwapChainDesc swapChainDesc;
+namespace {
 
-	swapChainDesc.window = frameBuffer->platformHandle;
-	swapChainDesc.presentQueueCount = 1;
-	swapChainDesc.pPresentQueues = qs;
-	swapChainDesc.width = width;
-	swapChainDesc.height = height;
-	swapChainDesc.imageCount = frameBuffer->frameBufferCount;
-	swapChainDesc.sampleCount = TheForge_SC_1;
-	swapChainDesc.sampleQuality = 0;
-	swapChainDesc.colorFormat = frameBuffer->colourBufferFormat;
-	swapChainDesc.enableVsync = false;
-	swapChainDesc.colorClearValue = {0, 0, 0, 1};
-	TheForge_AddSwapChain(frameBuffer->renderer->renderer, &swapChainDesc, &frameBuffer->swapChain);
+// NewFrame and Present are split into per frame buffer phases so several frame buffers
+// can share one frame index advance and one submit
 
-	frameBuffer->entireScissor.z = width;
-	frameBuffer->entireScissor.w = height;
-	frameBuffer->entireViewport.z = (float) width;
-	frameBuffer->entireViewport.w = (float) height;
+void StartFrame(Render_FrameBuffer *frameBuffer, double startMs) {
+	frameBuffer->dirty = false;
+	frameBuffer->lastRenderMs = startMs;
+	if (frameBuffer->frameStartMs != 0.0) {
+		frameBuffer->timing.frameMs = startMs - frameBuffer->frameStartMs;
+		AccumulateTiming(frameBuffer);
+	}
+	frameBuffer->frameStartMs = startMs;
+}
 
-	if (frameBuffer->imguiBindings) {
-		ImguiBindings_SetWindowSize(frameBuffer->imguiBindings, width, height);
+// the next renderer frame, its per frame data is free once the last submit that used the
+// slot has finished. Frame submits share the graphics queue so that covers every window
+void AdvanceRendererFrame(Render_RendererHandle renderer) {
+	uint32_t const frameIndex = (uint32_t) (renderer->frameCount % renderer->maxFramesAhead);
+	if (renderer->frameIndexFences[frameIndex]) {
+		WaitForFence(renderer->renderer, renderer->frameIndexFences[frameIndex]);
 	}
+	Render_RendererSetFrameIndex(renderer, frameIndex);
 }
 
-AL2O3_EXTERN_C void Render_FrameBufferNewFrame(Render_FrameBufferHandle handle) {
+// stall before acquiring if the cpu is frames in flight ahead of the gpu, low latency
+// also waits for the previous frame so the caller samples input as late as possible
+void WaitForFrameSlot(Render_FrameBuffer *frameBuffer, uint32_t frameIndex) {
+	auto renderer = (TheForge_RendererHandle) frameBuffer->renderer->renderer;
+	WaitForFence(renderer, frameBuffer->slotFences[frameIndex]);
+	if (frameBuffer->renderer->lowLatency) {
+		uint32_t const previousIndex = (frameIndex + frameBuffer->frameBufferCount - 1) % frameBuffer->frameBufferCount;
+		WaitForFence(renderer, frameBuffer->slotFences[previousIndex]);
+	}
+	if (frameBuffer->recorder) {
+		RenderTF_RecorderCollect(frameBuffer->recorder);
+	}
+	ReleaseRetiredHeadlessTargets(frameBuffer, false);
+	// a window without a swap chain retries every frame at the last size asked for
+	if (frameBuffer->resizePending || (!frameBuffer->headless && !frameBuffer->swapChain)) {
+		ApplyResize(frameBuffer);
+	}
+}
 
+void AcquireImage(Render_FrameBufferHandle handle, uint32_t frameIndex) {
 	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	double const acquireStartMs = NowMs();
+	frameBuffer->imageAcquirePending = false;
+	if (frameBuffer->headless) {
+		frameBuffer->imageIndex = (frameBuffer->imageIndex + 1) % frameBuffer->swapChainImageCount;
+		if (frameBuffer->headless->readbackFunc) {
+			DeliverHeadlessReadbacks(handle);
+		}
+		Render_TextureHandle target = frameBuffer->headless->targets[frameBuffer->imageIndex];
+		frameBuffer->outputRenderTarget = Render_TextureHandleToPtr(target)->renderTarget;
+	} else if (!frameBuffer->swapChain) {
+		ASSERT(frameBuffer->standInTargets);
+		frameBuffer->imageIndex = (frameBuffer->imageIndex + 1) % frameBuffer->swapChainImageCount;
+		Render_TextureHandle target = frameBuffer->standInTargets[frameBuffer->imageIndex];
+		frameBuffer->outputRenderTarget = Render_TextureHandleToPtr(target)->renderTarget;
+	} else {
+		TheForge_AcquireNextImage(frameBuffer->renderer->renderer,
+															frameBuffer->swapChain,
+															frameBuffer->imageAcquiredSemaphores[frameIndex],
+															nullptr,
+															&frameBuffer->imageIndex);
+		frameBuffer->outputRenderTarget = TheForge_SwapChainGetRenderTarget(frameBuffer->swapChain, frameBuffer->imageIndex);
+	}
+	frameBuffer->timing.acquireMs = NowMs() - acquireStartMs;
+}
 
-	auto renderer = (TheForge_RendererHandle) frameBuffer->renderer->renderer;
+// write barrier for the colour target then the overlays clear, which is left to the first
+// bind so the app and overlays can share a single render pass
+void PrepareColourTarget(Render_FrameBuffer *frameBuffer) {
+	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(frameBuffer->graphicsEncoder);
+	Render_TextureTransitionType const textureTransitions[] = { Render_TTT_RENDER_TARGET};
+	Render_TextureHandle textures[] = { frameBuffer->currentColourTarget };
 
-	uint32_t frameIndex;
-	TheForge_AcquireNextImage(renderer, frameBuffer->swapChain, frameBuffer->imageAcquiredSemaphore, nullptr, &frameIndex);
-	Render_RendererSetFrameIndex(frameBuffer->renderer, frameIndex);
+	Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder,
+			0, nullptr, nullptr,
+																	 1, textures, textureTransitions);
 
-	TheForge_SemaphoreHandle renderCompleteSemaphore = frameBuffer->renderCompleteSemaphores[frameIndex];
-	TheForge_FenceHandle renderCompleteFence = frameBuffer->renderCompleteFences[frameIndex];
+	if (frameBuffer->visualDebug || frameBuffer->imguiBindings) {
+		encoder->pendingClear = Render_TextureHandleToPtr(frameBuffer->currentColourTarget)->renderTarget;
+	}
+}
 
-	// Stall if CPU is running "Swap Chain Buffer Count" frames ahead of GPU
-	TheForge_FenceStatus fenceStatus;
-	TheForge_GetFenceStatus(renderer, renderCompleteFence, &fenceStatus);
-	if (fenceStatus == TheForge_FS_INCOMPLETE) {
-		TheForge_WaitForFences(renderer, 1, &renderCompleteFence);
+// swap chain images are acquired the first time they are needed so the acquire hides
+// behind whatever is recorded before that, headless targets are just the next in the ring
+void BeginImageAcquire(Render_FrameBufferHandle handle, uint32_t frameIndex) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (frameBuffer->headless) {
+		AcquireImage(handle, frameIndex);
+	} else {
+		frameBuffer->imageAcquirePending = true;
+		frameBuffer->timing.acquireMs = 0.0;
 	}
+}
 
+// after the renderers frame index has been set
+void BeginFrameRecording(Render_FrameBuffer *frameBuffer, uint32_t frameIndex) {
 	Render_Texture *tex = Render_TextureHandleToPtr(frameBuffer->currentColourTarget);
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(frameBuffer->graphicsEncoder);
 
-	tex->renderTarget = TheForge_SwapChainGetRenderTarget(frameBuffer->swapChain, frameIndex);
-	tex->texture = TheForge_RenderTargetGetTexture(tex->renderTarget);
+	// until the image is acquired the colour target has nothing to point at
+	frameBuffer->scaledRendering = frameBuffer->dynamicResolution != nullptr;
+	if (frameBuffer->scaledRendering) {
+		Render_TextureHandle target = RenderTF_DynamicResolutionTarget(frameBuffer->dynamicResolution);
+		tex->renderTarget = Render_TextureHandleToPtr(target)->renderTarget;
+	} else if (frameBuffer->imageAcquirePending) {
+		tex->renderTarget = nullptr;
+	} else {
+		tex->renderTarget = frameBuffer->outputRenderTarget;
+	}
+	tex->texture = tex->renderTarget ? TheForge_RenderTargetGetTexture(tex->renderTarget) : nullptr;
 	encoder->cmd = frameBuffer->frameCmds[frameIndex];
+	encoder->timer = frameBuffer->frameTimers[frameIndex];
 	encoder->view = Render_View{};
+	encoder->skipDraws = false;
 
 	TheForge_BeginCmd(encoder->cmd);
+	RenderTF_GraphicsEncoderRenderPassEnded(encoder);
+	RenderTF_GpuTimerBegin(encoder->timer, encoder->cmd);
+	if (frameBuffer->dynamicResolution) {
+		// the whole command buffer is timed, the controller sees it once this slot comes round again
+		RenderTF_DynamicResolutionUpdate(frameBuffer->dynamicResolution,
+																		 RenderTF_GpuTimerLastRootMilliseconds(encoder->timer));
+		RenderTF_GpuTimerBeginRegion(encoder->timer, encoder->cmd, "Frame buffer");
+	}
 
-	// insert write barrier for render target if we are more the N frames ahead
-	Render_TextureTransitionType const textureTransitions[] = { Render_TTT_RENDER_TARGET};
-	Render_TextureHandle textures[] = { frameBuffer->currentColourTarget };
-
-	Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder,
-			0, nullptr, nullptr,
-																	 1, textures, textureTransitions);
-
-	if (frameBuffer->visualDebug || frameBuffer->imguiBindings) {
-		// ensure the buffer is cleared if we used visual debug or imgui bindings
-		Render_GraphicsEncoderBindRenderTargets(frameBuffer->graphicsEncoder,
-																						1,
-																						textures,
-																						true,
-																						true,
-																						true);
+	encoder->pendingClear = nullptr;
+	if (tex->renderTarget) {
+		PrepareColourTarget(frameBuffer);
 	}
 }
 
-AL2O3_EXTERN_C void Render_FrameBufferPresent(Render_FrameBufferHandle handle) {
+// overlays, the final transition and readback then closes the command buffer
+void EndFrameRecording(Render_FrameBufferHandle handle, uint32_t frameIndex) {
 	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
-
-	auto frameIndex = frameBuffer->renderer->frameIndex;
+	// nothing used the image this frame, it's still needed to present
+	RenderTF_FrameBufferAcquireImage(handle);
+	if (frameBuffer->scaledRendering) {
+		ResolveDynamicResolution(frameBuffer);
+	}
 
 	if (frameBuffer->visualDebug || frameBuffer->imguiBindings) {
 		Render_TextureHandle renderTargets[] = { frameBuffer->currentColourTarget};
@@ -264,28 +739,237 @@ AL2O3_EXTERN_C void Render_FrameBufferPresent(Render_FrameBufferHandle handle) {
 
 	Render_GraphicsEncoderBindRenderTargets(frameBuffer->graphicsEncoder, 0, nullptr, false, false, false);
 
+	RenderTF_Headless *headless = frameBuffer->headless;
+	uint64_t const frame = frameBuffer->renderer->frameCount;
+	bool const record = frameBuffer->recorder && RenderTF_RecorderWantsFrame(frameBuffer->recorder, frame);
 	Render_TextureHandle textures[] = {frameBuffer->currentColourTarget};
 	Render_TextureTransitionType textureTransitions[] = {Render_TTT_PRESENT};
+	if (record || (headless && headless->readbackFunc)) {
+		textureTransitions[0] = Render_TTT_COPY_SOURCE;
+	} else if (headless || !frameBuffer->swapChain) {
+		textureTransitions[0] = RENDER_TTT_SHADER_ACCESS;
+	}
 	Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder, 0, nullptr, nullptr, 1, textures, textureTransitions);
 
+	if (headless && headless->readbackFunc) {
+		headless->pending[frameIndex].ticket = Render_ReadbackRequestTexture(frameBuffer->renderer,
+																																				 frameBuffer->graphicsEncoder,
+																																				 headless->targets[frameBuffer->imageIndex],
+																																				 Render_TextureSubresource{0, 0});
+		headless->pending[frameIndex].valid = true;
+	}
+
+	if (record) {
+		Render_ReadbackTicket const ticket = Render_ReadbackRequestTexture(frameBuffer->renderer,
+																																			 frameBuffer->graphicsEncoder,
+																																			 frameBuffer->currentColourTarget,
+																																			 Render_TextureSubresource{0, 0});
+		RenderTF_RecorderRequested(frameBuffer->recorder,
+															 frameIndex,
+															 frame,
+															 ticket,
+															 frameBuffer->entireScissor.z,
+															 frameBuffer->entireScissor.w);
+		if (frameBuffer->swapChain) {
+			textureTransitions[0] = Render_TTT_PRESENT;
+			Render_GraphicsEncoderTransition(frameBuffer->graphicsEncoder, 0, nullptr, nullptr, 1, textures, textureTransitions);
+		}
+	}
+
+	if (frameBuffer->dynamicResolution) {
+		RenderTF_GpuTimerEndRegion(encoder->timer, encoder->cmd);
+	}
+	RenderTF_GpuTimerEnd(encoder->timer, encoder->cmd);
 	TheForge_EndCmd(encoder->cmd);
+}
+
+// one queue submit for every frame buffer, fence is signalled when they have all finished
+void SubmitFrames(uint32_t count,
+									Render_FrameBufferHandle const *frameBuffers,
+									uint32_t frameIndex,
+									TheForge_FenceHandle fence) {
+	Render_FrameBuffer* first = Render_FrameBufferHandleToPtr(frameBuffers[0]);
+	uint32_t const maxComputeWaits = sizeof(first->computeWaits) / sizeof(first->computeWaits[0]);
+
+	auto cmds = (TheForge_CmdHandle *) STACK_ALLOC(sizeof(TheForge_CmdHandle) * count);
+	auto waitSemaphores = (TheForge_SemaphoreHandle *) STACK_ALLOC(sizeof(TheForge_SemaphoreHandle) * count * (1 + maxComputeWaits));
+	auto signalSemaphores = (TheForge_SemaphoreHandle *) STACK_ALLOC(sizeof(TheForge_SemaphoreHandle) * count * 2);
+	uint32_t waitCount = 0;
+	uint32_t signalCount = 0;
+
+	// async compute this frame depends on and/or that depends on this frame, headless
+	// frames (and windows that lost their swap chain) have no image to wait for or present
+	for (uint32_t i = 0; i < count; ++i) {
+		Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(frameBuffers[i]);
+		ASSERT(frameBuffer->presentQueue.handle == first->presentQueue.handle);
+		LatchView(frameBuffer, frameIndex);
+		cmds[i] = Render_GraphicsEncoderHandleToPtr(frameBuffer->graphicsEncoder)->cmd;
+		if (frameBuffer->swapChain) {
+			waitSemaphores[waitCount++] = frameBuffer->imageAcquiredSemaphores[frameIndex];
+			signalSemaphores[signalCount++] = frameBuffer->renderCompleteSemaphores[frameIndex];
+		}
+		for (uint32_t j = 0; j < frameBuffer->computeWaitCount; ++j) {
+			waitSemaphores[waitCount++] = frameBuffer->computeWaits[j];
+		}
+		if (frameBuffer->signalCompute) {
+			signalSemaphores[signalCount++] = frameBuffer->computeSignalSemaphore;
+		}
+	}
 
-	Render_Queue* queue = Render_QueueHandleToPtr(frameBuffer->presentQueue);
+	Render_Queue* queue = Render_QueueHandleToPtr(first->presentQueue);
+	double const submitStartMs = NowMs();
 	TheForge_QueueSubmit(queue->queue,
-											 1,
-											 &encoder->cmd,
-											 frameBuffer->renderCompleteFences[frameIndex],
-											 1,
-											 &frameBuffer->imageAcquiredSemaphore,
-											 1,
-											 &frameBuffer->renderCompleteSemaphores[frameIndex]);
-
-	TheForge_QueuePresent(queue->queue,
+											 count,
+											 cmds,
+											 fence,
+											 waitCount,
+											 waitSemaphores,
+											 signalCount,
+											 signalSemaphores);
+	first->renderer->frameIndexFences[frameIndex] = fence;
+	RenderTF_ReadbackSubmitted(first->renderer, fence);
+	RenderTF_TexturePoolFrameSubmitted(first->renderer, fence);
+	double const submitMs = NowMs() - submitStartMs;
+
+	for (uint32_t i = 0; i < count; ++i) {
+		Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(frameBuffers[i]);
+		frameBuffer->slotFences[frameIndex] = fence;
+		// uploads made while recording are in this frame
+		frameBuffer->seenResourceUpdateCount = frameBuffer->renderer->resourceUpdateCount;
+		frameBuffer->computeWaitCount = 0;
+		if (frameBuffer->signalCompute) {
+			frameBuffer->signalCompute = false;
+			frameBuffer->computeSignalPending = true;
+		}
+		frameBuffer->timing.submitMs = submitMs;
+	}
+}
+
+void PresentFrame(Render_FrameBuffer *frameBuffer, uint32_t frameIndex) {
+	if (!frameBuffer->swapChain) {
+		frameBuffer->timing.presentMs = 0.0;
+		return;
+	}
+	double const presentStartMs = NowMs();
+	TheForge_QueuePresent(Render_QueueHandleToPtr(frameBuffer->presentQueue)->queue,
 												frameBuffer->swapChain,
-												frameIndex,
+												frameBuffer->imageIndex,
 												1,
 												&frameBuffer->renderCompleteSemaphores[frameIndex]);
+	frameBuffer->timing.presentMs = NowMs() - presentStartMs;
+}
+
+} // end anon namespace
+
+void RenderTF_FrameBufferAcquireImage(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (!frameBuffer->imageAcquirePending) {
+		return;
+	}
+	AcquireImage(handle, frameBuffer->renderer->frameIndex);
+	if (!frameBuffer->scaledRendering) {
+		Render_Texture *tex = Render_TextureHandleToPtr(frameBuffer->currentColourTarget);
+		tex->renderTarget = frameBuffer->outputRenderTarget;
+		tex->texture = TheForge_RenderTargetGetTexture(tex->renderTarget);
+		PrepareColourTarget(frameBuffer);
+	}
+}
+
+Render_Texture *RenderTF_TextureAcquire(Render_TextureHandle handle) {
+	Render_Texture *tex = Render_TextureHandleToPtr(handle);
+	if (tex->texture == nullptr && tex->frameBuffer.handle != 0) {
+		RenderTF_FrameBufferAcquireImage(tex->frameBuffer);
+	}
+	ASSERT(tex->texture);
+	return tex;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferNewFrame(Render_FrameBufferHandle handle) {
+
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	Render_RendererHandle renderer = frameBuffer->renderer;
+
+	double const startMs = NowMs();
+	StartFrame(frameBuffer, startMs);
+
+	// windows presenting on their own share the renderer frame, the first one to come
+	// round again starts the next
+	if (renderer->frameCount == 0 || frameBuffer->rendererFrame == renderer->frameCount) {
+		AdvanceRendererFrame(renderer);
+	}
+	frameBuffer->rendererFrame = renderer->frameCount;
+	uint32_t const frameIndex = renderer->frameIndex;
+
+	WaitForFrameSlot(frameBuffer, frameIndex);
+	frameBuffer->timing.waitMs = NowMs() - startMs;
+
+	BeginImageAcquire(handle, frameIndex);
+	BeginFrameRecording(frameBuffer, frameIndex);
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferPresent(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+
+	auto frameIndex = frameBuffer->renderer->frameIndex;
+
+	EndFrameRecording(handle, frameIndex);
+	SubmitFrames(1, &handle, frameIndex, frameBuffer->renderCompleteFences[frameIndex]);
+	PresentFrame(frameBuffer, frameIndex);
+}
+
+AL2O3_EXTERN_C void Render_FrameBuffersNewFrame(Render_RendererHandle renderer,
+																								uint32_t count,
+																								Render_FrameBufferHandle const *frameBuffers) {
+	if (count == 0) {
+		return;
+	}
+	double const startMs = NowMs();
+	AdvanceRendererFrame(renderer);
+	uint32_t const frameIndex = renderer->frameIndex;
+
+	// batched frame buffers share the slots fence, the renderer frame already waited for it
+	for (uint32_t i = 0; i < count; ++i) {
+		Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(frameBuffers[i]);
+		ASSERT(frameBuffer->renderer == renderer);
+		StartFrame(frameBuffer, startMs);
+		WaitForFrameSlot(frameBuffer, frameIndex);
+		frameBuffer->timing.waitMs = NowMs() - startMs;
+		frameBuffer->rendererFrame = renderer->frameCount;
+		BeginImageAcquire(frameBuffers[i], frameIndex);
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		BeginFrameRecording(Render_FrameBufferHandleToPtr(frameBuffers[i]), frameIndex);
+	}
+}
+
+AL2O3_EXTERN_C void Render_FrameBuffersPresent(Render_RendererHandle renderer,
+																							 uint32_t count,
+																							 Render_FrameBufferHandle const *frameBuffers) {
+	if (count == 0) {
+		return;
+	}
+	uint32_t const frameIndex = renderer->frameIndex;
+
+	for (uint32_t i = 0; i < count; ++i) {
+		EndFrameRecording(frameBuffers[i], frameIndex);
+	}
+	SubmitFrames(count, frameBuffers, frameIndex, renderer->frameFences[frameIndex]);
+	// TheForge presents a single swap chain per call
+	for (uint32_t i = 0; i < count; ++i) {
+		PresentFrame(Render_FrameBufferHandleToPtr(frameBuffers[i]), frameIndex);
+	}
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferSignalCompute(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
 
+	// a binary semaphore can't be signalled again until it has been waited on
+	if (frameBuffer->computeSignalPending) {
+		LOGWARNING("Frame buffer compute signal from a previous frame was never waited on, ignoring");
+		return;
+	}
+	frameBuffer->signalCompute = true;
 }
 
 AL2O3_EXTERN_C void Render_FrameBufferUpdate(Render_FrameBufferHandle handle,
@@ -320,17 +1004,17 @@ AL2O3_EXTERN_C TinyImageFormat Render_FrameBufferColourFormat(Render_FrameBuffer
 AL2O3_EXTERN_C void Render_SetFrameBufferDebugView(Render_FrameBufferHandle handle, Render_View const *view) {
 	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
 
-	frameBuffer->debugGpuView->worldToViewMatrix =	Math_LookAtMat4F(view->position, view->lookAt, view->upVector);
+	frameBuffer->latchedView->worldToViewMatrix =	Math_LookAtMat4F(view->position, view->lookAt, view->upVector);
 
 	float const f = 1.0f / tanf(view->perspectiveFOV / 2.0f);
-	frameBuffer->debugGpuView->viewToNDCMatrix = {
+	frameBuffer->latchedView->viewToNDCMatrix = {
 			f / view->perspectiveAspectWoverH, 0.0f, 0.0f, 0.0f,
 			0.0f, f, 0.0f, 0.0f,
 			0.0f, 0.0f, 0.0f, 1.0f,
 			0.0f, 0.0f, view->nearOffset, 0.0f
 	};
 
-	frameBuffer->debugGpuView->worldToNDCMatrix = Math_MultiplyMat4F(frameBuffer->debugGpuView->worldToViewMatrix, frameBuffer->debugGpuView->viewToNDCMatrix);
+	frameBuffer->latchedView->worldToNDCMatrix = Math_MultiplyMat4F(frameBuffer->latchedView->worldToViewMatrix, frameBuffer->latchedView->viewToNDCMatrix);
 }
 
 AL2O3_EXTERN_C Math_Vec4F Render_FrameBufferEntireViewport(Render_FrameBufferHandle handle) {
@@ -338,6 +1022,9 @@ AL2O3_EXTERN_C Math_Vec4F Render_FrameBufferEntireViewport(Render_FrameBufferHan
 
 	ASSERT(frameBuffer->entireViewport.z > 0);
 	ASSERT(frameBuffer->entireViewport.w > 0);
+	if (frameBuffer->scaledRendering) {
+		return RenderTF_DynamicResolutionViewport(frameBuffer->dynamicResolution);
+	}
 	return frameBuffer->entireViewport;
 }
 AL2O3_EXTERN_C Math_Vec4U32 Render_FrameBufferEntireScissor(Render_FrameBufferHandle handle) {
@@ -345,6 +1032,9 @@ AL2O3_EXTERN_C Math_Vec4U32 Render_FrameBufferEntireScissor(Render_FrameBufferHa
 
 	ASSERT(frameBuffer->entireScissor.z > 0);
 	ASSERT(frameBuffer->entireScissor.w > 0);
+	if (frameBuffer->scaledRendering) {
+		return RenderTF_DynamicResolutionScissor(frameBuffer->dynamicResolution);
+	}
 	return frameBuffer->entireScissor;
 }
 
@@ -369,4 +1059,140 @@ AL2O3_EXTERN_C void Render_FrameBufferDescribeROPLayout(Render_FrameBufferHandle
 	out->colourFormats[0] = frameBuffer->colourBufferFormat;
 	out->colourTypes[0] = Render_RCT_RGB_LDR; // TODO HDR + dest alpha?
 
-}
\ No newline at end of file
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferGetTimingStats(Render_FrameBufferHandle handle,
+																										 Render_FrameTimingStats *last,
+																										 Render_FrameTimingStats *average) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (last) {
+		*last = frameBuffer->timing;
+	}
+	if (average) {
+		*average = frameBuffer->averageTiming;
+	}
+}
+
+AL2O3_EXTERN_C bool Render_FrameBufferIsHeadless(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	return frameBuffer->headless != nullptr;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferSetReadbackCallback(Render_FrameBufferHandle handle,
+																													Render_FrameBufferReadbackFunc func,
+																													void *userData) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (!frameBuffer->headless) {
+		LOGERROR("Render_FrameBufferSetReadbackCallback requires a headless frame buffer");
+		return;
+	}
+	frameBuffer->headless->readbackFunc = func;
+	frameBuffer->headless->readbackUserData = userData;
+	for (uint32_t i = 0; i < frameBuffer->frameBufferCount; ++i) {
+		frameBuffer->headless->pending[i].valid = false;
+	}
+}
+
+AL2O3_EXTERN_C bool Render_FrameBufferEnableDynamicResolution(Render_FrameBufferHandle handle,
+																															Render_DynamicResolutionDesc const *desc) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (frameBuffer->dynamicResolution) {
+		RenderTF_DynamicResolutionSetDesc(frameBuffer->dynamicResolution, desc);
+		return true;
+	}
+	frameBuffer->dynamicResolution = RenderTF_DynamicResolutionCreate(frameBuffer->renderer,
+																																		frameBuffer->colourBufferFormat,
+																																		(uint32_t) frameBuffer->entireScissor.z,
+																																		(uint32_t) frameBuffer->entireScissor.w,
+																																		desc);
+	return frameBuffer->dynamicResolution != nullptr;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferDisableDynamicResolution(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (!frameBuffer->dynamicResolution) {
+		return;
+	}
+	// the upscale pipeline and set may still be in use
+	TheForge_WaitForFences(frameBuffer->renderer->renderer, frameBuffer->frameBufferCount, frameBuffer->slotFences);
+	RenderTF_DynamicResolutionDestroy(frameBuffer->dynamicResolution);
+	frameBuffer->dynamicResolution = nullptr;
+}
+
+AL2O3_EXTERN_C float Render_FrameBufferGetResolutionScale(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	return frameBuffer->dynamicResolution ? RenderTF_DynamicResolutionScale(frameBuffer->dynamicResolution) : 1.0f;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferLatchView(Render_FrameBufferHandle handle, Render_GpuView const *view) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	*frameBuffer->latchedView = *view;
+}
+
+AL2O3_EXTERN_C Render_BufferHandle Render_FrameBufferViewConstants(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	return frameBuffer->viewConstants;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferSetThrottle(Render_FrameBufferHandle handle,
+																									Render_FrameBufferThrottleDesc const *desc) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	frameBuffer->throttle = *desc;
+	frameBuffer->dirty = true;
+	UpdateVsync(frameBuffer);
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferSetWindowState(Render_FrameBufferHandle handle, bool focused, bool minimised) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (frameBuffer->focused != focused || frameBuffer->minimised != minimised) {
+		frameBuffer->dirty = true;
+	}
+	frameBuffer->focused = focused;
+	frameBuffer->minimised = minimised;
+	UpdateVsync(frameBuffer);
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferMarkDirty(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	frameBuffer->dirty = true;
+}
+
+AL2O3_EXTERN_C bool Render_FrameBufferShouldRender(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	Render_FrameBufferThrottleDesc const *throttle = &frameBuffer->throttle;
+
+	if (frameBuffer->minimised) {
+		return false;
+	}
+	if (!frameBuffer->focused && throttle->backgroundFps > 0.0) {
+		if (NowMs() - frameBuffer->lastRenderMs < 1000.0 / throttle->backgroundFps) {
+			return false;
+		}
+	}
+	return !throttle->onDemand || IsDirty(frameBuffer);
+}
+
+AL2O3_EXTERN_C bool Render_FrameBufferRecorderStart(Render_FrameBufferHandle handle,
+																										Render_FrameBufferRecorderDesc const *desc) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	Render_FrameBufferRecorderStop(handle);
+	frameBuffer->recorder = RenderTF_RecorderCreate(frameBuffer->renderer,
+																									frameBuffer->colourBufferFormat,
+																									frameBuffer->frameBufferCount,
+																									desc);
+	return frameBuffer->recorder != nullptr;
+}
+
+AL2O3_EXTERN_C void Render_FrameBufferRecorderStop(Render_FrameBufferHandle handle) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	RenderTF_RecorderDestroy(frameBuffer->recorder);
+	frameBuffer->recorder = nullptr;
+}
+
+AL2O3_EXTERN_C bool Render_FrameBufferRecorderDump(Render_FrameBufferHandle handle, char const *path) {
+	Render_FrameBuffer* frameBuffer = Render_FrameBufferHandleToPtr(handle);
+	if (!frameBuffer->recorder) {
+		return false;
+	}
+	return RenderTF_RecorderDump(frameBuffer->recorder, path);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+// acquires this frames swap chain image if NewFrame deferred it and, unless the frame is
+// rendering at a dynamic resolution, points the colour target at it. Called the first time
+// anything binds, transitions, copies, reads back or queries the colour target
+void RenderTF_FrameBufferAcquireImage(Render_FrameBufferHandle handle);
+
+// every path that reads or writes a texture goes through this, a frame buffers colour
+// target has no image behind it until the acquire
+Render_Texture *RenderTF_TextureAcquire(Render_TextureHandle handle);
@@ -0,0 +1,352 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "render_basics/graphicsencoder.h"
+#include "render_basics/theforge/framegraph.h"
+#include "render_basics/theforge/texturepool.h"
+#include "framegraphcompile.hpp"
+#include "texturepool.hpp"
+
+namespace {
+
+struct Resource {
+	bool isBuffer;
+	Render_TextureHandle texture;
+	Render_BufferHandle buffer;
+	Render_TextureCreateDesc desc; ///< transients only
+};
+
+struct Pass {
+	char name[32];
+	Render_FrameGraphExecuteFunc execute;
+	void *userData;
+};
+
+// pooled textures backing the alias slots, held across frames so a graph that
+// doesn't change reuses the same ones without waiting for the pool to retire them
+struct Transient {
+	uint64_t key;
+	Render_TextureHandle texture;
+	bool claimed;
+};
+
+} // end anon namespace
+
+typedef struct Render_FrameGraph {
+	Render_RendererHandle renderer;
+
+	uint32_t resourceCount;
+	Resource resources[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	RenderTF_FrameGraphResourceDecl resourceDecls[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+
+	uint32_t passCount;
+	Pass passes[RENDERTF_FRAMEGRAPH_MAX_PASSES];
+	RenderTF_FrameGraphPassDecl passDecls[RENDERTF_FRAMEGRAPH_MAX_PASSES];
+
+	bool compiled;
+	bool declError; ///< a pass declared a bad access, Compile fails until Reset
+	RenderTF_FrameGraphCompiled compile;
+
+	CADT_VectorHandle transients; // Transient
+} Render_FrameGraph;
+
+namespace {
+
+void AddAccess(Render_FrameGraph *graph,
+							 Render_FrameGraphPass pass,
+							 Render_FrameGraphResource resource,
+							 uint32_t state,
+							 bool write) {
+	// usually a pass or resource whose add failed and returned RENDER_FRAMEGRAPH_INVALID
+	graph->compiled = false;
+	if (pass >= graph->passCount) {
+		LOGERROR("Frame graph access to resource %u by an invalid pass", resource);
+		graph->declError = true;
+		return;
+	}
+	if (resource >= graph->resourceCount) {
+		LOGERROR("Frame graph pass %s accesses an invalid resource", graph->passes[pass].name);
+		graph->declError = true;
+		return;
+	}
+	RenderTF_FrameGraphPassDecl &decl = graph->passDecls[pass];
+	if (decl.accessCount >= RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES) {
+		LOGERROR("Frame graph pass %s uses more than %u resources", graph->passes[pass].name,
+						 RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES);
+		graph->declError = true;
+		return;
+	}
+	decl.accesses[decl.accessCount++] = RenderTF_FrameGraphAccess{resource, state, write};
+}
+
+Render_FrameGraphResource AddResource(Render_FrameGraph *graph) {
+	if (graph->resourceCount >= RENDERTF_FRAMEGRAPH_MAX_RESOURCES) {
+		LOGERROR("Frame graph has more than %u resources", RENDERTF_FRAMEGRAPH_MAX_RESOURCES);
+		return RENDER_FRAMEGRAPH_INVALID;
+	}
+	uint32_t const index = graph->resourceCount++;
+	graph->resources[index] = Resource{};
+	graph->resourceDecls[index] = RenderTF_FrameGraphResourceDecl{};
+	graph->compiled = false;
+	return index;
+}
+
+// a transient texture for each alias slot, reusing last frames where the desc matches.
+// Ones no longer needed go back to the pool
+bool AssignTransients(Render_FrameGraph *graph) {
+	size_t const existingCount = CADT_VectorSize(graph->transients);
+	auto existing = (Transient *) CADT_VectorData(graph->transients);
+	for (size_t i = 0; i < existingCount; ++i) {
+		existing[i].claimed = false;
+	}
+
+	uint32_t slotTransients[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	for (uint32_t s = 0; s < graph->compile.aliasSlotCount; ++s) {
+		slotTransients[s] = RENDERTF_FRAMEGRAPH_NO_SLOT;
+	}
+
+	for (uint32_t r = 0; r < graph->resourceCount; ++r) {
+		uint32_t const slot = graph->compile.aliasSlot[r];
+		if (slot == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+			continue;
+		}
+		if (slotTransients[slot] == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+			uint64_t const key = graph->compile.aliasSlotKey[slot];
+			auto transients = (Transient *) CADT_VectorData(graph->transients);
+			for (size_t i = 0; i < CADT_VectorSize(graph->transients); ++i) {
+				if (!transients[i].claimed && transients[i].key == key) {
+					slotTransients[slot] = (uint32_t) i;
+					break;
+				}
+			}
+			if (slotTransients[slot] == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+				Transient const transient{key, Render_TextureAcquireTransient(graph->renderer, &graph->resources[r].desc), false};
+				if (!Render_TextureHandleIsValid(transient.texture)) {
+					LOGERROR("Frame graph transient texture creation failed");
+					return false;
+				}
+				slotTransients[slot] = (uint32_t) CADT_VectorPushElement(graph->transients, (void *) &transient);
+			}
+			Transient *transient = ((Transient *) CADT_VectorData(graph->transients)) + slotTransients[slot];
+			transient->claimed = true;
+		}
+		graph->resources[r].texture = ((Transient *) CADT_VectorData(graph->transients))[slotTransients[slot]].texture;
+	}
+
+	size_t i = 0;
+	while (i < CADT_VectorSize(graph->transients)) {
+		auto transients = (Transient *) CADT_VectorData(graph->transients);
+		if (!transients[i].claimed) {
+			Render_TextureReleaseTransient(graph->renderer, transients[i].texture);
+			size_t const last = CADT_VectorSize(graph->transients) - 1;
+			transients[i] = transients[last];
+			CADT_VectorResize(graph->transients, last);
+		} else {
+			++i;
+		}
+	}
+	return true;
+}
+
+} // end anon namespace
+
+AL2O3_EXTERN_C Render_FrameGraphHandle Render_FrameGraphCreate(Render_RendererHandle renderer) {
+	auto graph = (Render_FrameGraph *) MEMORY_CALLOC(1, sizeof(Render_FrameGraph));
+	if (!graph) {
+		return nullptr;
+	}
+	graph->renderer = renderer;
+	graph->transients = CADT_VectorCreate(sizeof(Transient));
+	return graph;
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphDestroy(Render_RendererHandle renderer, Render_FrameGraphHandle graph) {
+	if (!renderer || !graph) {
+		return;
+	}
+	auto transients = (Transient *) CADT_VectorData(graph->transients);
+	for (size_t i = 0; i < CADT_VectorSize(graph->transients); ++i) {
+		Render_TextureReleaseTransient(renderer, transients[i].texture);
+	}
+	CADT_VectorDestroy(graph->transients);
+	MEMORY_FREE(graph);
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphReset(Render_FrameGraphHandle graph) {
+	graph->resourceCount = 0;
+	graph->passCount = 0;
+	graph->compiled = false;
+	graph->declError = false;
+}
+
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphImportTexture(Render_FrameGraphHandle graph,
+																																				Render_TextureHandle texture,
+																																				Render_TextureTransitionType currentState,
+																																				bool output) {
+	Render_FrameGraphResource const index = AddResource(graph);
+	if (index == RENDER_FRAMEGRAPH_INVALID) {
+		return index;
+	}
+	graph->resources[index].texture = texture;
+	graph->resourceDecls[index].initialState = currentState;
+	graph->resourceDecls[index].unorderedState = Render_TTT_UNORDERED_ACCESS;
+	graph->resourceDecls[index].output = output;
+	return index;
+}
+
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphImportBuffer(Render_FrameGraphHandle graph,
+																																			 Render_BufferHandle buffer,
+																																			 Render_BufferTransitionType currentState,
+																																			 bool output) {
+	Render_FrameGraphResource const index = AddResource(graph);
+	if (index == RENDER_FRAMEGRAPH_INVALID) {
+		return index;
+	}
+	graph->resources[index].isBuffer = true;
+	graph->resources[index].buffer = buffer;
+	graph->resourceDecls[index].initialState = currentState;
+	graph->resourceDecls[index].unorderedState = Render_BTT_UNORDERED_ACCESS;
+	graph->resourceDecls[index].output = output;
+	return index;
+}
+
+AL2O3_EXTERN_C Render_FrameGraphResource Render_FrameGraphCreateTexture(Render_FrameGraphHandle graph,
+																																				Render_TextureCreateDesc const *desc) {
+	ASSERT(desc->initialData == nullptr);
+	Render_FrameGraphResource const index = AddResource(graph);
+	if (index == RENDER_FRAMEGRAPH_INVALID) {
+		return index;
+	}
+	graph->resources[index].desc = *desc;
+	graph->resourceDecls[index].aliasKey = RenderTF_TextureDescKey(desc);
+	graph->resourceDecls[index].unorderedState = Render_TTT_UNORDERED_ACCESS;
+	graph->resourceDecls[index].transient = true;
+	return index;
+}
+
+AL2O3_EXTERN_C Render_FrameGraphPass Render_FrameGraphAddPass(Render_FrameGraphHandle graph,
+																															char const *name,
+																															Render_FrameGraphExecuteFunc execute,
+																															void *userData,
+																															Render_FrameGraphPassFlags flags) {
+	if (graph->passCount >= RENDERTF_FRAMEGRAPH_MAX_PASSES) {
+		LOGERROR("Frame graph has more than %u passes", RENDERTF_FRAMEGRAPH_MAX_PASSES);
+		return RENDER_FRAMEGRAPH_INVALID;
+	}
+	uint32_t const index = graph->passCount++;
+	Pass &pass = graph->passes[index];
+	strncpy(pass.name, name ? name : "", sizeof(pass.name) - 1);
+	pass.name[sizeof(pass.name) - 1] = 0;
+	pass.execute = execute;
+	pass.userData = userData;
+	graph->passDecls[index] = RenderTF_FrameGraphPassDecl{};
+	graph->passDecls[index].sideEffects = (flags & Render_FGPF_SIDE_EFFECTS) != 0;
+	graph->compiled = false;
+	return index;
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphPassReadTexture(Render_FrameGraphHandle graph,
+																										 Render_FrameGraphPass pass,
+																										 Render_FrameGraphResource resource,
+																										 Render_TextureTransitionType state) {
+	AddAccess(graph, pass, resource, state, false);
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphPassWriteTexture(Render_FrameGraphHandle graph,
+																											Render_FrameGraphPass pass,
+																											Render_FrameGraphResource resource,
+																											Render_TextureTransitionType state) {
+	AddAccess(graph, pass, resource, state, true);
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphPassReadBuffer(Render_FrameGraphHandle graph,
+																										Render_FrameGraphPass pass,
+																										Render_FrameGraphResource resource,
+																										Render_BufferTransitionType state) {
+	AddAccess(graph, pass, resource, state, false);
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphPassWriteBuffer(Render_FrameGraphHandle graph,
+																										 Render_FrameGraphPass pass,
+																										 Render_FrameGraphResource resource,
+																										 Render_BufferTransitionType state) {
+	AddAccess(graph, pass, resource, state, true);
+}
+
+AL2O3_EXTERN_C bool Render_FrameGraphCompile(Render_FrameGraphHandle graph) {
+	if (graph->declError) {
+		LOGERROR("Frame graph has invalid pass declarations, not compiling");
+		graph->compiled = false;
+		return false;
+	}
+	graph->compiled = RenderTF_FrameGraphCompile(graph->passDecls, graph->passCount,
+																							 graph->resourceDecls, graph->resourceCount,
+																							 &graph->compile);
+	if (!graph->compiled) {
+		return false;
+	}
+
+	graph->compiled = AssignTransients(graph);
+	return graph->compiled;
+}
+
+AL2O3_EXTERN_C void Render_FrameGraphExecute(Render_FrameGraphHandle graph, Render_GraphicsEncoderHandle encoder) {
+	if (!graph->compiled) {
+		LOGERROR("Frame graph executed without a successful compile");
+		return;
+	}
+
+	Render_BufferHandle buffers[RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+	Render_BufferTransitionType bufferStates[RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+	Render_TextureHandle textures[RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+	Render_TextureTransitionType textureStates[RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+
+	RenderTF_FrameGraphCompiled const &compile = graph->compile;
+	for (uint32_t i = 0; i < compile.passCount; ++i) {
+		uint32_t bufferCount = 0;
+		uint32_t textureCount = 0;
+		for (uint32_t b = compile.barrierStart[i]; b < compile.barrierStart[i + 1]; ++b) {
+			Resource const &resource = graph->resources[compile.barriers[b].resource];
+			if (resource.isBuffer) {
+				buffers[bufferCount] = resource.buffer;
+				bufferStates[bufferCount++] = (Render_BufferTransitionType) compile.barriers[b].state;
+			} else {
+				textures[textureCount] = resource.texture;
+				textureStates[textureCount++] = (Render_TextureTransitionType) compile.barriers[b].state;
+			}
+		}
+		Render_GraphicsEncoderTransition(encoder, bufferCount, buffers, bufferStates, textureCount, textures, textureStates);
+
+		Pass const &pass = graph->passes[compile.passes[i]];
+		if (pass.execute) {
+			pass.execute(graph, encoder, pass.userData);
+		}
+	}
+}
+
+AL2O3_EXTERN_C Render_TextureHandle Render_FrameGraphGetTexture(Render_FrameGraphHandle graph,
+																																Render_FrameGraphResource resource) {
+	ASSERT(resource < graph->resourceCount);
+	ASSERT(!graph->resources[resource].isBuffer);
+	return graph->resources[resource].texture;
+}
+
+AL2O3_EXTERN_C Render_BufferHandle Render_FrameGraphGetBuffer(Render_FrameGraphHandle graph,
+																															Render_FrameGraphResource resource) {
+	ASSERT(resource < graph->resourceCount);
+	ASSERT(graph->resources[resource].isBuffer);
+	return graph->resources[resource].buffer;
+}
+
+AL2O3_EXTERN_C bool Render_FrameGraphIsPassCulled(Render_FrameGraphHandle graph, Render_FrameGraphPass pass) {
+	for (uint32_t i = 0; i < graph->compile.passCount; ++i) {
+		if (graph->compile.passes[i] == pass) {
+			return false;
+		}
+	}
+	return true;
+}
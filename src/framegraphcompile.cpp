@@ -0,0 +1,232 @@
+#include "al2o3_platform/platform.h"
+#include "framegraphcompile.hpp"
+
+static_assert(RENDERTF_FRAMEGRAPH_MAX_PASSES <= 64, "pass sets are 64 bit masks");
+
+namespace {
+
+uint64_t const One = 1;
+
+// a pass is live if it has side effects or writes a resource a later live pass reads
+// (or an output). Walk backwards tracking which resource contents are still needed
+uint64_t FindLivePasses(RenderTF_FrameGraphPassDecl const *passes,
+												uint32_t passCount,
+												RenderTF_FrameGraphResourceDecl const *resources,
+												uint32_t resourceCount) {
+	bool needed[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	for (uint32_t i = 0; i < resourceCount; ++i) {
+		needed[i] = resources[i].output;
+	}
+
+	uint64_t live = 0;
+	for (uint32_t p = passCount; p-- > 0;) {
+		RenderTF_FrameGraphPassDecl const &pass = passes[p];
+		bool isLive = pass.sideEffects;
+		for (uint32_t a = 0; a < pass.accessCount && !isLive; ++a) {
+			isLive = pass.accesses[a].write && needed[pass.accesses[a].resource];
+		}
+		if (!isLive) {
+			continue;
+		}
+		live |= One << p;
+
+		// writes satisfy later reads, then this pass's own reads need earlier writers
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			if (pass.accesses[a].write) {
+				needed[pass.accesses[a].resource] = false;
+			}
+		}
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			if (!pass.accesses[a].write) {
+				needed[pass.accesses[a].resource] = true;
+			}
+		}
+	}
+	return live;
+}
+
+// read after write, write after read and write after write edges between live passes
+void FindDependencies(RenderTF_FrameGraphPassDecl const *passes,
+											uint32_t passCount,
+											uint32_t resourceCount,
+											uint64_t live,
+											uint64_t *dependencies) {
+	uint32_t lastWriter[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	uint64_t readers[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	for (uint32_t i = 0; i < resourceCount; ++i) {
+		lastWriter[i] = RENDERTF_FRAMEGRAPH_NO_SLOT;
+		readers[i] = 0;
+	}
+
+	for (uint32_t p = 0; p < passCount; ++p) {
+		dependencies[p] = 0;
+		if (!(live & (One << p))) {
+			continue;
+		}
+		RenderTF_FrameGraphPassDecl const &pass = passes[p];
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			uint32_t const r = pass.accesses[a].resource;
+			if (lastWriter[r] != RENDERTF_FRAMEGRAPH_NO_SLOT) {
+				dependencies[p] |= One << lastWriter[r];
+			}
+			if (pass.accesses[a].write) {
+				dependencies[p] |= readers[r];
+			}
+		}
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			uint32_t const r = pass.accesses[a].resource;
+			if (pass.accesses[a].write) {
+				lastWriter[r] = p;
+				readers[r] = 0;
+			} else {
+				readers[r] |= One << p;
+			}
+		}
+		dependencies[p] &= ~(One << p);
+	}
+}
+
+} // end anon namespace
+
+bool RenderTF_FrameGraphCompile(RenderTF_FrameGraphPassDecl const *passes,
+																uint32_t passCount,
+																RenderTF_FrameGraphResourceDecl const *resources,
+																uint32_t resourceCount,
+																RenderTF_FrameGraphCompiled *out) {
+	if (passCount > RENDERTF_FRAMEGRAPH_MAX_PASSES) {
+		LOGERROR("Frame graph has %u passes, max is %u", passCount, RENDERTF_FRAMEGRAPH_MAX_PASSES);
+		return false;
+	}
+	if (resourceCount > RENDERTF_FRAMEGRAPH_MAX_RESOURCES) {
+		LOGERROR("Frame graph has %u resources, max is %u", resourceCount, RENDERTF_FRAMEGRAPH_MAX_RESOURCES);
+		return false;
+	}
+	for (uint32_t p = 0; p < passCount; ++p) {
+		if (passes[p].accessCount > RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES) {
+			LOGERROR("Frame graph pass %u has too many resource accesses", p);
+			return false;
+		}
+		for (uint32_t a = 0; a < passes[p].accessCount; ++a) {
+			if (passes[p].accesses[a].resource >= resourceCount) {
+				LOGERROR("Frame graph pass %u uses an invalid resource", p);
+				return false;
+			}
+		}
+	}
+
+	uint64_t const live = FindLivePasses(passes, passCount, resources, resourceCount);
+
+	uint64_t dependencies[RENDERTF_FRAMEGRAPH_MAX_PASSES];
+	FindDependencies(passes, passCount, resourceCount, live, dependencies);
+
+	// topological order, lowest declared pass first among the ready ones
+	out->passCount = 0;
+	uint64_t done = 0;
+	while (done != live) {
+		uint32_t next = RENDERTF_FRAMEGRAPH_NO_SLOT;
+		for (uint32_t p = 0; p < passCount; ++p) {
+			uint64_t const bit = One << p;
+			if ((live & bit) && !(done & bit) && (dependencies[p] & ~done) == 0) {
+				next = p;
+				break;
+			}
+		}
+		if (next == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+			LOGERROR("Frame graph has a dependency cycle");
+			return false;
+		}
+		done |= One << next;
+		out->passes[out->passCount++] = next;
+	}
+
+	// lifetimes in execution order
+	uint32_t firstUse[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	uint32_t lastUse[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	for (uint32_t r = 0; r < resourceCount; ++r) {
+		firstUse[r] = RENDERTF_FRAMEGRAPH_NO_SLOT;
+		lastUse[r] = 0;
+		out->finalState[r] = resources[r].transient ? 0 : resources[r].initialState;
+	}
+	for (uint32_t i = 0; i < out->passCount; ++i) {
+		RenderTF_FrameGraphPassDecl const &pass = passes[out->passes[i]];
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			uint32_t const r = pass.accesses[a].resource;
+			if (firstUse[r] == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+				firstUse[r] = i;
+			}
+			lastUse[r] = i;
+		}
+	}
+
+	// barriers, only when the state changes or a write in the unordered state needs
+	// to finish before the next access. All of a pass's are batched before it
+	bool unorderedWrite[RENDERTF_FRAMEGRAPH_MAX_RESOURCES] = {};
+	out->barrierCount = 0;
+	for (uint32_t i = 0; i < out->passCount; ++i) {
+		RenderTF_FrameGraphPassDecl const &pass = passes[out->passes[i]];
+		out->barrierStart[i] = out->barrierCount;
+
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			uint32_t const r = pass.accesses[a].resource;
+			bool seen = false;
+			for (uint32_t b = 0; b < a && !seen; ++b) {
+				seen = pass.accesses[b].resource == r;
+			}
+			if (seen) {
+				continue;
+			}
+
+			uint32_t state = 0;
+			for (uint32_t b = a; b < pass.accessCount; ++b) {
+				if (pass.accesses[b].resource == r) {
+					state |= pass.accesses[b].state;
+				}
+			}
+			bool const unorderedHazard = unorderedWrite[r] && (state & resources[r].unorderedState);
+			if (out->finalState[r] != state || unorderedHazard) {
+				out->barriers[out->barrierCount++] = RenderTF_FrameGraphBarrier{r, state};
+				out->finalState[r] = state;
+				unorderedWrite[r] = false;
+			}
+		}
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			RenderTF_FrameGraphAccess const &access = pass.accesses[a];
+			if (access.write && (access.state & resources[access.resource].unorderedState)) {
+				unorderedWrite[access.resource] = true;
+			}
+		}
+	}
+	out->barrierStart[out->passCount] = out->barrierCount;
+
+	// alias slots, first fit in order of first use
+	uint32_t slotLastUse[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	out->aliasSlotCount = 0;
+	for (uint32_t r = 0; r < resourceCount; ++r) {
+		out->aliasSlot[r] = RENDERTF_FRAMEGRAPH_NO_SLOT;
+	}
+	for (uint32_t i = 0; i < out->passCount; ++i) {
+		RenderTF_FrameGraphPassDecl const &pass = passes[out->passes[i]];
+		for (uint32_t a = 0; a < pass.accessCount; ++a) {
+			uint32_t const r = pass.accesses[a].resource;
+			if (!resources[r].transient || firstUse[r] != i || out->aliasSlot[r] != RENDERTF_FRAMEGRAPH_NO_SLOT) {
+				continue;
+			}
+
+			uint32_t slot = RENDERTF_FRAMEGRAPH_NO_SLOT;
+			for (uint32_t s = 0; s < out->aliasSlotCount; ++s) {
+				if (out->aliasSlotKey[s] == resources[r].aliasKey && slotLastUse[s] < i) {
+					slot = s;
+					break;
+				}
+			}
+			if (slot == RENDERTF_FRAMEGRAPH_NO_SLOT) {
+				slot = out->aliasSlotCount++;
+				out->aliasSlotKey[slot] = resources[r].aliasKey;
+			}
+			slotLastUse[slot] = lastUse[r];
+			out->aliasSlot[r] = slot;
+		}
+	}
+
+	return true;
+}
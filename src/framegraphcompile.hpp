@@ -0,0 +1,58 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// cpu side of the frame graph, no gpu objects so it can be unit tested.
+// Resource states are opaque bitmasks (the Render_*TransitionType values), 0 is undefined
+
+#define RENDERTF_FRAMEGRAPH_MAX_PASSES 64
+#define RENDERTF_FRAMEGRAPH_MAX_RESOURCES 128
+#define RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES 16
+#define RENDERTF_FRAMEGRAPH_NO_SLOT (~0u)
+
+typedef struct RenderTF_FrameGraphAccess {
+	uint32_t resource;
+	uint32_t state;
+	bool write;          ///< writes replace the contents, add a read as well to load them
+} RenderTF_FrameGraphAccess;
+
+typedef struct RenderTF_FrameGraphPassDecl {
+	uint32_t accessCount;
+	RenderTF_FrameGraphAccess accesses[RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+	bool sideEffects;    ///< never culled (presents, readbacks etc.)
+} RenderTF_FrameGraphPassDecl;
+
+typedef struct RenderTF_FrameGraphResourceDecl {
+	uint64_t aliasKey;     ///< transients can only share a slot with an equal key
+	uint32_t initialState; ///< imported resources, transients always start undefined
+	uint32_t unorderedState; ///< state bit(s) where a write must finish before the next access even without a state change
+	bool transient;
+	bool output;           ///< contents are needed after the graph, keeps its writers alive
+} RenderTF_FrameGraphResourceDecl;
+
+typedef struct RenderTF_FrameGraphBarrier {
+	uint32_t resource;
+	uint32_t state;
+} RenderTF_FrameGraphBarrier;
+
+typedef struct RenderTF_FrameGraphCompiled {
+	uint32_t passCount;                                         ///< live passes
+	uint32_t passes[RENDERTF_FRAMEGRAPH_MAX_PASSES];            ///< execution order, indices of declared passes
+	uint32_t barrierStart[RENDERTF_FRAMEGRAPH_MAX_PASSES + 1];  ///< barriers for passes[i] are [barrierStart[i], barrierStart[i+1])
+	uint32_t barrierCount;
+	RenderTF_FrameGraphBarrier barriers[RENDERTF_FRAMEGRAPH_MAX_PASSES * RENDERTF_FRAMEGRAPH_MAX_PASS_ACCESSES];
+
+	uint32_t aliasSlotCount;
+	uint32_t aliasSlot[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];      ///< NO_SLOT for imported or unused resources
+	uint64_t aliasSlotKey[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+	uint32_t finalState[RENDERTF_FRAMEGRAPH_MAX_RESOURCES];
+} RenderTF_FrameGraphCompiled;
+
+// orders the passes by their dependencies (declaration order breaks ties), culls
+// passes that contribute nothing to an output or side effect, works out the barriers
+// each pass needs and assigns transients to alias slots by lifetime
+bool RenderTF_FrameGraphCompile(RenderTF_FrameGraphPassDecl const *passes,
+																uint32_t passCount,
+																RenderTF_FrameGraphResourceDecl const *resources,
+																uint32_t resourceCount,
+																RenderTF_FrameGraphCompiled *out);
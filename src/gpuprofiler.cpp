@@ -0,0 +1,437 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "render_basics/theforge/gpuprofiler.h"
+#include "gpuprofiler.hpp"
+
+namespace {
+
+uint32_t const MaxRegions = 128;          ///< per command buffer recording
+uint32_t const MaxQueries = MaxRegions * 2;
+uint32_t const MaxDepth = 16;
+uint32_t const FrameHistory = RENDER_MAX_FRAMES_IN_FLIGHT + 2;
+uint32_t const NoRegion = ~0u;
+uint32_t const MaxStatisticsScopes = 32;
+// every counter is resolved in d3d12 D3D12_QUERY_DATA_PIPELINE_STATISTICS order
+uint32_t const StatisticsPerQuery = 11;
+
+enum StatisticsCounter {
+	SC_IA_VERTICES = 0,
+	SC_IA_PRIMITIVES = 1,
+	SC_VS_INVOCATIONS = 2,
+	SC_C_INVOCATIONS = 5,
+	SC_C_PRIMITIVES = 6,
+	SC_PS_INVOCATIONS = 7,
+};
+
+struct Region {
+	char name[32];
+	uint32_t parent;
+	uint32_t depth;
+};
+
+// regions harvested from every command buffer recorded in one frame
+struct Frame {
+	uint64_t frame;
+	CADT_VectorHandle regions;    // Render_GpuTimedRegion
+	CADT_VectorHandle statistics; // Render_GpuPipelineStatistics
+};
+
+} // end anon namespace
+
+struct RenderTF_GpuProfiler {
+	Frame frames[FrameHistory];
+};
+
+struct RenderTF_GpuTimer {
+	Render_RendererHandle renderer;
+	Render_QueueType queueType;
+	double ticksToMs;
+
+	TheForge_QueryPoolHandle queryPool;
+	TheForge_BufferHandle buffer;
+	uint64_t const *timestamps;  ///< persistently mapped, resolved queries
+
+	uint64_t frame;              ///< renderer frame count the recording began in
+	double lastRootMs;           ///< top level regions of the last harvested recording
+	bool recording;
+	bool resolved;               ///< results pending harvest
+
+	uint32_t regionCount;
+	Region regions[MaxRegions];
+
+	uint32_t stackDepth;
+	uint32_t stack[MaxDepth];    ///< NoRegion when out of regions
+	uint32_t ignoredDepth;       ///< begins past MaxDepth
+
+	// pipeline statistics, graphics only
+	TheForge_QueryPoolHandle statisticsPool;
+	TheForge_BufferHandle statisticsBuffer;
+	uint64_t const *statistics;
+	uint32_t scopeCount;
+	bool scopeOpen;
+	char scopeNames[MaxStatisticsScopes][32];
+};
+
+namespace {
+
+// the previous recording has completed, copy it to its frame
+void Harvest(RenderTF_GpuTimer *timer) {
+	timer->resolved = false;
+	timer->lastRootMs = 0.0;
+	for (uint32_t i = 0; i < timer->regionCount; ++i) {
+		uint64_t const begin = timer->timestamps[i * 2 + 0];
+		uint64_t const end = timer->timestamps[i * 2 + 1];
+		if (timer->regions[i].parent == NoRegion && end > begin) {
+			timer->lastRootMs += (double) (end - begin) * timer->ticksToMs;
+		}
+	}
+
+	RenderTF_GpuProfiler *profiler = timer->renderer->gpuProfiler;
+	Frame &frame = profiler->frames[timer->frame % FrameHistory];
+	if (frame.frame != timer->frame) {
+		if (frame.frame > timer->frame) {
+			return; // too old to be asked for
+		}
+		frame.frame = timer->frame;
+		CADT_VectorResize(frame.regions, 0);
+		CADT_VectorResize(frame.statistics, 0);
+	}
+
+	uint32_t const base = (uint32_t) CADT_VectorSize(frame.regions);
+	for (uint32_t i = 0; i < timer->regionCount; ++i) {
+		Region const &region = timer->regions[i];
+		uint64_t const begin = timer->timestamps[i * 2 + 0];
+		uint64_t const end = timer->timestamps[i * 2 + 1];
+
+		Render_GpuTimedRegion result{};
+		memcpy(result.name, region.name, sizeof(result.name));
+		result.parent = region.parent == NoRegion ? RENDER_GPU_TIMED_REGION_NO_PARENT : base + region.parent;
+		result.depth = region.depth;
+		result.queue = timer->queueType;
+		result.milliseconds = end > begin ? (double) (end - begin) * timer->ticksToMs : 0.0;
+		CADT_VectorPushElement(frame.regions, &result);
+	}
+
+	for (uint32_t i = 0; i < timer->scopeCount; ++i) {
+		uint64_t const *counters = timer->statistics + i * StatisticsPerQuery;
+
+		Render_GpuPipelineStatistics result{};
+		memcpy(result.name, timer->scopeNames[i], sizeof(result.name));
+		result.inputVertices = counters[SC_IA_VERTICES];
+		result.inputPrimitives = counters[SC_IA_PRIMITIVES];
+		result.vertexShaderInvocations = counters[SC_VS_INVOCATIONS];
+		result.clippingInvocations = counters[SC_C_INVOCATIONS];
+		result.clippingPrimitives = counters[SC_C_PRIMITIVES];
+		result.fragmentShaderInvocations = counters[SC_PS_INVOCATIONS];
+		CADT_VectorPushElement(frame.statistics, &result);
+	}
+}
+
+// the most recent frame all command buffers have been collected for
+Frame const *CompleteFrame(Render_RendererHandle renderer, uint64_t *frame) {
+	*frame = 0;
+	if (renderer->frameCount < renderer->maxFramesAhead) {
+		return nullptr;
+	}
+
+	*frame = renderer->frameCount - renderer->maxFramesAhead;
+	Frame const &history = renderer->gpuProfiler->frames[*frame % FrameHistory];
+	return history.frame == *frame ? &history : nullptr;
+}
+
+} // end anon namespace
+
+RenderTF_GpuProfiler *RenderTF_GpuProfilerCreate(Render_RendererHandle renderer) {
+	ASSERT(renderer->maxFramesAhead + 1 < FrameHistory);
+	auto profiler = (RenderTF_GpuProfiler *) MEMORY_CALLOC(1, sizeof(RenderTF_GpuProfiler));
+	if (!profiler) {
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < FrameHistory; ++i) {
+		profiler->frames[i].regions = CADT_VectorCreate(sizeof(Render_GpuTimedRegion));
+		profiler->frames[i].statistics = CADT_VectorCreate(sizeof(Render_GpuPipelineStatistics));
+	}
+	return profiler;
+}
+
+void RenderTF_GpuProfilerDestroy(Render_RendererHandle renderer, RenderTF_GpuProfiler *profiler) {
+	if (!profiler) {
+		return;
+	}
+	for (uint32_t i = 0; i < FrameHistory; ++i) {
+		CADT_VectorDestroy(profiler->frames[i].regions);
+		CADT_VectorDestroy(profiler->frames[i].statistics);
+	}
+	MEMORY_FREE(profiler);
+}
+
+RenderTF_GpuTimer *RenderTF_GpuTimerCreate(Render_RendererHandle renderer, Render_QueueType queueType) {
+	auto timer = (RenderTF_GpuTimer *) MEMORY_CALLOC(1, sizeof(RenderTF_GpuTimer));
+	if (!timer) {
+		return nullptr;
+	}
+	timer->renderer = renderer;
+	timer->queueType = queueType;
+
+	double frequency = 0.0;
+	Render_QueueHandle queue = Render_RendererGetPrimaryQueue(renderer, queueType);
+	TheForge_GetTimestampFrequency(Render_QueueHandleToPtr(queue)->queue, &frequency);
+	timer->ticksToMs = frequency > 0.0 ? 1000.0 / frequency : 0.0;
+
+	TheForge_QueryPoolDesc queryPoolDesc{};
+	queryPoolDesc.type = TheForge_QT_TIMESTAMP;
+	queryPoolDesc.queryCount = MaxQueries;
+	TheForge_AddQueryPool(renderer->renderer, &queryPoolDesc, &timer->queryPool);
+
+	TheForge_BufferDesc bufferDesc{};
+	bufferDesc.size = MaxQueries * sizeof(uint64_t);
+	bufferDesc.memoryUsage = TheForge_RMU_GPU_TO_CPU;
+	bufferDesc.flags = TheForge_BCF_PERSISTENT_MAP_BIT;
+	bufferDesc.startState = TheForge_RS_COPY_DEST;
+	TheForge_AddBuffer(renderer->renderer, &bufferDesc, &timer->buffer);
+
+	if (!timer->queryPool || !timer->buffer) {
+		LOGERROR("Gpu timer creation failed");
+		RenderTF_GpuTimerDestroy(renderer, timer);
+		return nullptr;
+	}
+	timer->timestamps = (uint64_t const *) TheForge_BufferGetCpuMappedAddress(timer->buffer);
+
+	if (queueType == Render_QT_GRAPHICS) {
+		queryPoolDesc.type = TheForge_QT_PIPELINE_STATISTICS;
+		queryPoolDesc.queryCount = MaxStatisticsScopes;
+		TheForge_AddQueryPool(renderer->renderer, &queryPoolDesc, &timer->statisticsPool);
+
+		bufferDesc.size = MaxStatisticsScopes * StatisticsPerQuery * sizeof(uint64_t);
+		TheForge_AddBuffer(renderer->renderer, &bufferDesc, &timer->statisticsBuffer);
+
+		// not fatal, scopes are ignored without them
+		if (timer->statisticsPool && timer->statisticsBuffer) {
+			timer->statistics = (uint64_t const *) TheForge_BufferGetCpuMappedAddress(timer->statisticsBuffer);
+		} else {
+			LOGWARNING("Pipeline statistics queries unavailable");
+		}
+	}
+	return timer;
+}
+
+void RenderTF_GpuTimerDestroy(Render_RendererHandle renderer, RenderTF_GpuTimer *timer) {
+	if (!timer) {
+		return;
+	}
+	if (timer->buffer) {
+		TheForge_RemoveBuffer(renderer->renderer, timer->buffer);
+	}
+	if (timer->queryPool) {
+		TheForge_RemoveQueryPool(renderer->renderer, timer->queryPool);
+	}
+	if (timer->statisticsBuffer) {
+		TheForge_RemoveBuffer(renderer->renderer, timer->statisticsBuffer);
+	}
+	if (timer->statisticsPool) {
+		TheForge_RemoveQueryPool(renderer->renderer, timer->statisticsPool);
+	}
+	MEMORY_FREE(timer);
+}
+
+void RenderTF_GpuTimerBegin(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd) {
+	if (!timer) {
+		return;
+	}
+	if (timer->resolved) {
+		Harvest(timer);
+	}
+
+	TheForge_CmdResetQueryPool(cmd, timer->queryPool, 0, MaxQueries);
+	if (timer->statistics) {
+		TheForge_CmdResetQueryPool(cmd, timer->statisticsPool, 0, MaxStatisticsScopes);
+	}
+	timer->frame = timer->renderer->frameCount;
+	timer->recording = true;
+	timer->regionCount = 0;
+	timer->stackDepth = 0;
+	timer->ignoredDepth = 0;
+	timer->scopeCount = 0;
+	timer->scopeOpen = false;
+}
+
+void RenderTF_GpuTimerEnd(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd) {
+	if (!timer || !timer->recording) {
+		return;
+	}
+	if (timer->stackDepth || timer->ignoredDepth) {
+		LOGWARNING("Timed region(s) not ended before submit, closing them");
+		while (timer->stackDepth) {
+			RenderTF_GpuTimerEndRegion(timer, cmd);
+		}
+		timer->ignoredDepth = 0;
+	}
+	if (timer->scopeOpen) {
+		LOGWARNING("Statistics scope not ended before submit, closing it");
+		RenderTF_GpuTimerEndStatistics(timer, cmd);
+	}
+	timer->recording = false;
+	if (timer->regionCount == 0 && timer->scopeCount == 0) {
+		return;
+	}
+
+	// resolves aren't allowed inside a render pass
+	if (timer->queueType == Render_QT_GRAPHICS) {
+		TheForge_CmdBindRenderTargets(cmd, 0, nullptr, nullptr, nullptr, nullptr, nullptr, -1, -1);
+	}
+	if (timer->regionCount) {
+		TheForge_CmdResolveQuery(cmd, timer->queryPool, timer->buffer, 0, timer->regionCount * 2);
+	}
+	if (timer->scopeCount) {
+		TheForge_CmdResolveQuery(cmd, timer->statisticsPool, timer->statisticsBuffer, 0, timer->scopeCount);
+	}
+	timer->resolved = true;
+}
+
+double RenderTF_GpuTimerLastRootMilliseconds(RenderTF_GpuTimer const *timer) {
+	return timer ? timer->lastRootMs : 0.0;
+}
+
+void RenderTF_GpuTimerBeginRegion(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd, char const *name) {
+	if (!timer || !timer->recording) {
+		return;
+	}
+	if (timer->stackDepth >= MaxDepth) {
+		timer->ignoredDepth++;
+		return;
+	}
+
+	uint32_t index = NoRegion;
+	if (timer->regionCount < MaxRegions) {
+		index = timer->regionCount++;
+		Region &region = timer->regions[index];
+		strncpy(region.name, name ? name : "", sizeof(region.name) - 1);
+		region.name[sizeof(region.name) - 1] = 0;
+		region.parent = timer->stackDepth ? timer->stack[timer->stackDepth - 1] : NoRegion;
+		region.depth = timer->stackDepth;
+
+		TheForge_QueryDesc const query{index * 2 + 0};
+		TheForge_CmdBeginQuery(cmd, timer->queryPool, &query);
+	}
+	timer->stack[timer->stackDepth++] = index;
+}
+
+void RenderTF_GpuTimerEndRegion(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd) {
+	if (!timer || !timer->recording) {
+		return;
+	}
+	if (timer->ignoredDepth) {
+		timer->ignoredDepth--;
+		return;
+	}
+	if (timer->stackDepth == 0) {
+		LOGWARNING("EndTimedRegion without a matching BeginTimedRegion");
+		return;
+	}
+
+	uint32_t const index = timer->stack[--timer->stackDepth];
+	if (index != NoRegion) {
+		TheForge_QueryDesc const query{index * 2 + 1};
+		TheForge_CmdEndQuery(cmd, timer->queryPool, &query);
+	}
+}
+
+void RenderTF_GpuTimerBeginStatistics(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd, char const *name) {
+	if (!timer || !timer->recording || !timer->statistics) {
+		return;
+	}
+	if (timer->scopeOpen) {
+		LOGWARNING("Statistics scopes can't nest, %s ignored", name ? name : "");
+		return;
+	}
+	if (timer->scopeCount >= MaxStatisticsScopes) {
+		return;
+	}
+
+	uint32_t const index = timer->scopeCount++;
+	strncpy(timer->scopeNames[index], name ? name : "", sizeof(timer->scopeNames[index]) - 1);
+	timer->scopeNames[index][sizeof(timer->scopeNames[index]) - 1] = 0;
+	timer->scopeOpen = true;
+
+	TheForge_QueryDesc const query{index};
+	TheForge_CmdBeginQuery(cmd, timer->statisticsPool, &query);
+}
+
+void RenderTF_GpuTimerEndStatistics(RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd) {
+	if (!timer || !timer->scopeOpen) {
+		return;
+	}
+	timer->scopeOpen = false;
+
+	TheForge_QueryDesc const query{timer->scopeCount - 1};
+	TheForge_CmdEndQuery(cmd, timer->statisticsPool, &query);
+}
+
+AL2O3_EXTERN_C void Render_GraphicsEncoderBeginTimedRegion(Render_GraphicsEncoderHandle handle, char const *name) {
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerBeginRegion(encoder->timer, encoder->cmd, name);
+}
+
+AL2O3_EXTERN_C void Render_GraphicsEncoderEndTimedRegion(Render_GraphicsEncoderHandle handle) {
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerEndRegion(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_GraphicsEncoderBeginStatisticsScope(Render_GraphicsEncoderHandle handle, char const *name) {
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerBeginStatistics(encoder->timer, encoder->cmd, name);
+}
+
+AL2O3_EXTERN_C void Render_GraphicsEncoderEndStatisticsScope(Render_GraphicsEncoderHandle handle) {
+	Render_GraphicsEncoder *encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerEndStatistics(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderBeginTimedRegion(Render_ComputeEncoderHandle handle, char const *name) {
+	Render_ComputeEncoder *encoder = Render_ComputeEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerBeginRegion(encoder->timer, encoder->cmd, name);
+}
+
+AL2O3_EXTERN_C void Render_ComputeEncoderEndTimedRegion(Render_ComputeEncoderHandle handle) {
+	Render_ComputeEncoder *encoder = Render_ComputeEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerEndRegion(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderBeginTimedRegion(Render_BlitEncoderHandle handle, char const *name) {
+	Render_BlitEncoder *encoder = Render_BlitEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerBeginRegion(encoder->timer, encoder->cmd, name);
+}
+
+AL2O3_EXTERN_C void Render_BlitEncoderEndTimedRegion(Render_BlitEncoderHandle handle) {
+	Render_BlitEncoder *encoder = Render_BlitEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerEndRegion(encoder->timer, encoder->cmd);
+}
+
+AL2O3_EXTERN_C uint32_t Render_RendererGetGpuTimings(Render_RendererHandle renderer,
+																										 uint64_t *frame,
+																										 Render_GpuTimedRegion const **regions) {
+	Frame const *history = CompleteFrame(renderer, frame);
+	if (!history) {
+		*regions = nullptr;
+		return 0;
+	}
+	*regions = (Render_GpuTimedRegion const *) CADT_VectorData(history->regions);
+	return (uint32_t) CADT_VectorSize(history->regions);
+}
+
+AL2O3_EXTERN_C uint32_t Render_RendererGetGpuPipelineStatistics(Render_RendererHandle renderer,
+																																uint64_t *frame,
+																																Render_GpuPipelineStatistics const **scopes) {
+	Frame const *history = CompleteFrame(renderer, frame);
+	if (!history) {
+		*scopes = nullptr;
+		return 0;
+	}
+	*scopes = (Render_GpuPipelineStatistics const *) CADT_VectorData(history->statistics);
+	return (uint32_t) CADT_VectorSize(history->statistics);
+}
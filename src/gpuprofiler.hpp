@@ -0,0 +1,25 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+struct RenderTF_GpuProfiler *RenderTF_GpuProfilerCreate(Render_RendererHandle renderer);
+void RenderTF_GpuProfilerDestroy(Render_RendererHandle renderer, struct RenderTF_GpuProfiler *profiler);
+
+// timestamp queries for one command buffer
+struct RenderTF_GpuTimer *RenderTF_GpuTimerCreate(Render_RendererHandle renderer, Render_QueueType queueType);
+void RenderTF_GpuTimerDestroy(Render_RendererHandle renderer, struct RenderTF_GpuTimer *timer);
+
+// call straight after the cmd begins, the previous recording must have finished on the gpu
+void RenderTF_GpuTimerBegin(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd);
+// call before the cmd ends
+void RenderTF_GpuTimerEnd(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd);
+// sum of the top level regions of the last recording collected by Begin, 0 if none
+double RenderTF_GpuTimerLastRootMilliseconds(struct RenderTF_GpuTimer const *timer);
+
+void RenderTF_GpuTimerBeginRegion(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd, char const *name);
+void RenderTF_GpuTimerEndRegion(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd);
+
+// graphics timers only
+void RenderTF_GpuTimerBeginStatistics(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd, char const *name);
+void RenderTF_GpuTimerEndStatistics(struct RenderTF_GpuTimer *timer, TheForge_CmdHandle cmd);
@@ -7,12 +7,32 @@
 #include "render_basics/theforge/handlemanager.h"
 #include "render_basics/api.h"
 #include "render_basics/graphicsencoder.h"
+#include "render_basics/theforge/pipeline.h"
+#include "encoder.hpp"
+#include "framebuffer.hpp"
+#include "gpuprofiler.hpp"
+
+namespace {
+
+// the frame buffers image is acquired lazily, the first use of its colour target needs it
+void AcquireIfFrameBufferTarget(uint32_t count, Render_TextureHandle const *textures) {
+	for (uint32_t i = 0; i < count; ++i) {
+		RenderTF_TextureAcquire(textures[i]);
+	}
+}
+
+} // end anon namespace
 
 AL2O3_EXTERN_C Render_GraphicsEncoderHandle Render_GraphicsEncoderCreate(Render_RendererHandle renderer) {
 
 	Render_GraphicsEncoderHandle handle = Render_GraphicsEncoderHandleAlloc();
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	encoder->renderer = renderer;
 	TheForge_AddCmd(renderer->graphicsCmdPool, false, &encoder->cmd);
+	encoder->skipDraws = false;
+	encoder->timer = RenderTF_GpuTimerCreate(renderer, Render_QT_GRAPHICS);
+	encoder->pendingClear = nullptr;
+	RenderTF_GraphicsEncoderRenderPassEnded(encoder);
 	return handle;
 
 }
@@ -21,11 +41,17 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderDestroy(Render_RendererHandle renderer
 																									Render_GraphicsEncoderHandle handle) {
 
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	RenderTF_GpuTimerDestroy(renderer, encoder->timer);
 	TheForge_RemoveCmd(renderer->graphicsCmdPool, encoder->cmd);
 	Render_GraphicsEncoderHandleRelease(handle);
 
 }
 
+void RenderTF_GraphicsEncoderRenderPassEnded(Render_GraphicsEncoder *encoder) {
+	encoder->boundColourCount = 0;
+	encoder->boundDepth = nullptr;
+}
+
 
 AL2O3_EXTERN_C void Render_GraphicsEncoderBindRenderTargets(Render_GraphicsEncoderHandle handle,
 																														uint32_t count,
@@ -33,11 +59,16 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderBindRenderTargets(Render_GraphicsEncod
 																														bool clear,
 																														bool setViewports,
 																														bool setScissors) {
+	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+
 	if (count == 0) {
+		if (encoder->boundColourCount || encoder->boundDepth) {
+			TheForge_CmdBindRenderTargets(encoder->cmd, 0, nullptr, nullptr, nullptr, nullptr, nullptr, -1, -1);
+			RenderTF_GraphicsEncoderRenderPassEnded(encoder);
+		}
 		return;
 	}
-
-	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	AcquireIfFrameBufferTarget(count, targets);
 
 	TheForge_LoadActionsDesc loadActions{};
 	TheForge_RenderTargetHandle colourTargets[16];
@@ -46,6 +77,7 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderBindRenderTargets(Render_GraphicsEncod
 
 	uint32_t width = 0;
 	uint32_t height = 0;
+	bool clearsPending = false;
 
 	{
 		for (uint32_t i = 0; i < count; ++i) {
@@ -61,27 +93,45 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderBindRenderTargets(Render_GraphicsEncod
 				height = renderTargetDesc->height;
 			}
 
+			// not clearing keeps the contents, overlays and later passes draw over them
+			bool const clearTarget = clear || rth == encoder->pendingClear;
+			clearsPending |= rth == encoder->pendingClear;
 			uint64_t formatCode = TinyImageFormat_Code(renderTargetDesc->format);
 			if ((formatCode & TinyImageFormat_NAMESPACE_MASK) != TinyImageFormat_NAMESPACE_DEPTH_STENCIL) {
+				loadActions.loadActionsColor[colourTargetCount] = clearTarget ? TheForge_LA_CLEAR : TheForge_LA_LOAD;
+				loadActions.clearColorValues[colourTargetCount] = renderTargetDesc->clearValue;
 				colourTargets[colourTargetCount++] = rth;
-				loadActions.loadActionsColor[i] = clear ? TheForge_LA_CLEAR : TheForge_LA_DONTCARE;
-				loadActions.clearColorValues[i] = renderTargetDesc->clearValue;
 			} else {
 				ASSERT(depthTarget == nullptr);
 				depthTarget = rth;
-				loadActions.loadActionDepth = clear ? TheForge_LA_CLEAR : TheForge_LA_DONTCARE;
+				loadActions.loadActionDepth = clearTarget ? TheForge_LA_CLEAR : TheForge_LA_LOAD;
 				loadActions.clearDepth = renderTargetDesc->clearValue;
 			}
 		}
 	}
 
-	TheForge_CmdBindRenderTargets(encoder->cmd,
-																colourTargetCount,
-																colourTargets,
-																depthTarget,
-																&loadActions,
-																nullptr, nullptr,
-																-1, -1);
+	// still bound and nothing to clear, append to the open render pass rather than
+	// paying for another store and load of every target
+	bool const alreadyBound = !clear && !clearsPending &&
+			colourTargetCount == encoder->boundColourCount &&
+			depthTarget == encoder->boundDepth &&
+			memcmp(colourTargets, encoder->boundColour, sizeof(TheForge_RenderTargetHandle) * colourTargetCount) == 0;
+
+	if (!alreadyBound) {
+		TheForge_CmdBindRenderTargets(encoder->cmd,
+																	colourTargetCount,
+																	colourTargets,
+																	depthTarget,
+																	&loadActions,
+																	nullptr, nullptr,
+																	-1, -1);
+		memcpy(encoder->boundColour, colourTargets, sizeof(TheForge_RenderTargetHandle) * colourTargetCount);
+		encoder->boundColourCount = colourTargetCount;
+		encoder->boundDepth = depthTarget;
+		if (clearsPending) {
+			encoder->pendingClear = nullptr;
+		}
+	}
 	if (setViewports) {
 		TheForge_CmdSetViewport(encoder->cmd, 0.0f, 0.0f,
 														(float) width, (float) height,
@@ -171,6 +221,22 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderSetViewport(Render_GraphicsEncoderHand
 AL2O3_EXTERN_C void Render_GraphicsEncoderBindPipeline(Render_GraphicsEncoderHandle handle,
 																											 Render_PipelineHandle pipelineHandle) {
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	if (!Render_PipelineHandleIsValid(pipelineHandle)) {
+		LOGERROR("Render_GraphicsEncoderBindPipeline called with an invalid pipeline");
+		encoder->skipDraws = true;
+		return;
+	}
+
+	// async pipelines that are still compiling never block, use the fallback or skip draws
+	if (!Render_PipelineIsReady(pipelineHandle)) {
+		Render_PipelineHandle fallback = Render_PipelineHandleToPtr(pipelineHandle)->fallback;
+		if (!Render_PipelineIsReady(fallback)) {
+			encoder->skipDraws = true;
+			return;
+		}
+		pipelineHandle = fallback;
+	}
+	encoder->skipDraws = false;
 
 	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(pipelineHandle);
 
@@ -194,6 +260,9 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderDraw(Render_GraphicsEncoderHandle hand
 																							 uint32_t vertexCount,
 																							 uint32_t firstVertex) {
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	if (encoder->skipDraws) {
+		return;
+	}
 	TheForge_CmdDraw(encoder->cmd, vertexCount, firstVertex);
 }
 
@@ -203,6 +272,9 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderDrawInstanced(Render_GraphicsEncoderHa
 																												uint32_t instanceCount,
 																												uint32_t firstInstance) {
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	if (encoder->skipDraws) {
+		return;
+	}
 	TheForge_CmdDrawInstanced(encoder->cmd, vertexCount, firstVertex, instanceCount, firstInstance);
 }
 AL2O3_EXTERN_C void Render_GraphicsEncoderDrawIndexed(Render_GraphicsEncoderHandle handle,
@@ -210,6 +282,9 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderDrawIndexed(Render_GraphicsEncoderHand
 																											uint32_t firstIndex,
 																											uint32_t firstVertex) {
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	if (encoder->skipDraws) {
+		return;
+	}
 	TheForge_CmdDrawIndexed(encoder->cmd, indexCount, firstIndex, firstVertex);
 }
 AL2O3_EXTERN_C void Render_GraphicsEncoderDrawIndexedInstanced(Render_GraphicsEncoderHandle handle,
@@ -219,6 +294,9 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderDrawIndexedInstanced(Render_GraphicsEn
 																															 uint32_t firstVertex,
 																															 uint32_t firstInstance) {
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
+	if (encoder->skipDraws) {
+		return;
+	}
 	TheForge_CmdDrawIndexedInstanced(encoder->cmd, indexCount, firstIndex, instanceCount, firstVertex, firstInstance);
 }
 
@@ -229,68 +307,14 @@ AL2O3_EXTERN_C void Render_GraphicsEncoderTransition(Render_GraphicsEncoderHandl
 																										 uint32_t numTextures,
 																										 Render_TextureHandle const *textures,
 																										 Render_TextureTransitionType const *textureTransitions) {
-	if (!numBuffers && !numTextures) {
-		return;
-	}
-
 	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(handle);
-
-	auto bufferBarriers = (TheForge_BufferBarrier *) STACK_ALLOC(sizeof(TheForge_BufferBarrier) * numBuffers);
-
-	for (uint32_t i = 0; i < numBuffers; ++i) {
-		bufferBarriers[i].buffer = Render_BufferHandleToPtr(buffers[i])->buffer;
-		uint32_t newState = 0;
-		for (uint32_t j = 0x1; j < Render_BTT_MAX; j = j << 1) {
-			switch ((Render_BufferTransitionType) ((uint32_t const) bufferTransitions[i] & j)) {
-				case Render_BTT_VERTEX_OR_CONSTANT_BUFFER: newState |= TheForge_RS_VERTEX_AND_CONSTANT_BUFFER;
-					break;
-				case Render_BTT_INDEX_BUFFER: newState |= TheForge_RS_INDEX_BUFFER;
-					break;
-				case Render_BTT_UNORDERED_ACCESS: newState |= TheForge_RS_UNORDERED_ACCESS;
-					break;
-				case Render_BTT_INDIRECT_ARGUMENT: newState |= TheForge_RS_INDIRECT_ARGUMENT;
-					break;
-				case Render_BTT_COPY_DEST: newState |= TheForge_RS_COPY_DEST;
-					break;
-				case Render_BTT_COPY_SOURCE: newState |= TheForge_RS_COPY_SOURCE;
-					break;
-
-				default:
-				case Render_BTT_UNDEFINED: break;
-			}
-		}
-		bufferBarriers[i].newState = (TheForge_ResourceState) newState;
-		bufferBarriers[i].split = false;
-	}
-	auto textureBarriers = (TheForge_TextureBarrier *) STACK_ALLOC(sizeof(TheForge_TextureBarrier) * numTextures);
-	for (uint32_t i = 0; i < numTextures; ++i) {
-		textureBarriers[i].texture = Render_TextureHandleToPtr(textures[i])->texture;
-		uint32_t newState = 0;
-		for (uint32_t j = 0x1; j < Render_TTT_MAX; j = j << 1) {
-			switch ((Render_TextureTransitionType) ((uint32_t const) textureTransitions[i] & j)) {
-				case Render_TTT_RENDER_TARGET: newState |= TheForge_RS_RENDER_TARGET;
-					break;
-				case Render_TTT_UNORDERED_ACCESS: newState |= TheForge_RS_UNORDERED_ACCESS;
-					break;
-				case Render_TTT_DEPTH_WRITE: newState |= TheForge_RS_DEPTH_WRITE;
-					break;
-				case Render_TTT_DEPTH_READ: newState |= TheForge_RS_DEPTH_READ;
-					break;
-				case Render_TTT_COPY_DEST: newState |= TheForge_RS_COPY_DEST;
-					break;
-				case Render_TTT_COPY_SOURCE: newState |= TheForge_RS_COPY_SOURCE;
-					break;
-				case Render_TTT_PRESENT: newState |= TheForge_RS_PRESENT;
-					break;
-				case RENDER_TTT_SHADER_ACCESS: newState |= TheForge_RS_SHADER_RESOURCE;
-					break;
-				default:
-				case Render_TTT_UNDEFINED:break;
-			}
-		}
-		textureBarriers[i].newState = (TheForge_ResourceState) newState;
-		textureBarriers[i].split = false;
+	if (numBuffers + numTextures == 0) {
+		return;
 	}
-
-	TheForge_CmdResourceBarrier(encoder->cmd, numBuffers, bufferBarriers, numTextures, textureBarriers);
-}
\ No newline at end of file
+	// RenderTF_CmdTransition acquires a frame buffers colour target
+	RenderTF_CmdTransition(encoder->cmd,
+												 numBuffers, buffers, bufferTransitions,
+												 numTextures, textures, textureTransitions);
+	// barriers aren't allowed inside a render pass, TheForge ends it
+	RenderTF_GraphicsEncoderRenderPassEnded(encoder);
+}
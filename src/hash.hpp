@@ -0,0 +1,28 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// 64 bit FNV-1a, used to key the caches of immutable render objects
+// always hash fields explicitly, struct padding isn't guarenteed to be zero
+static const uint64_t RenderTF_HashSeed = 0xcbf29ce484222325ULL;
+
+AL2O3_FORCE_INLINE uint64_t RenderTF_Hash(void const *data, size_t size, uint64_t seed = RenderTF_HashSeed) {
+	uint8_t const *bytes = (uint8_t const *) data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+AL2O3_FORCE_INLINE uint64_t RenderTF_HashU64(uint64_t value, uint64_t seed = RenderTF_HashSeed) {
+	return RenderTF_Hash(&value, sizeof(uint64_t), seed);
+}
+
+AL2O3_FORCE_INLINE uint64_t RenderTF_HashString(char const *str, uint64_t seed = RenderTF_HashSeed) {
+	if (str == nullptr) {
+		return RenderTF_HashU64(0, seed);
+	}
+	return RenderTF_Hash(str, strlen(str), seed);
+}
@@ -6,12 +6,20 @@
 #include "render_basics/pipeline.h"
 #include "render_basics/theforge/handlemanager.h"
 #include "render_basics/theforge/api.h"
-AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreate(Render_RendererHandle renderer,
-																																					 Render_GraphicsPipelineDesc const *desc) {
-	TheForge_PipelineDesc pipelineDesc{};
+#include "pipelinecache.hpp"
+#include "pipelinecompiler.hpp"
+
+bool RenderTF_GraphicsPipelineDescToTheForge(Render_GraphicsPipelineDesc const *desc, TheForge_PipelineDesc *out) {
+	TheForge_PipelineDesc &pipelineDesc = *out;
+	pipelineDesc = {};
 	pipelineDesc.type = TheForge_PT_GRAPHICS;
 	TheForge_GraphicsPipelineDesc &gfxPipeDesc = pipelineDesc.graphicsDesc;
 
+	// catch layout mismatches here rather than as garbage vertices
+	if (!Render_ShaderValidateVertexLayout(desc->shader, desc->vertexLayout)) {
+		return false;
+	}
+
 	gfxPipeDesc.shaderProgram = Render_ShaderHandleToPtr(desc->shader)->shader;
 	gfxPipeDesc.rootSignature = Render_RootSignatureHandleToPtr(desc->rootSignature)->signature;
 
@@ -27,9 +35,38 @@ AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreate(Render_Render
 
 	gfxPipeDesc.pVertexLayout = desc->vertexLayout;
 	gfxPipeDesc.primitiveTopo = (TheForge_PrimitiveTopology) desc->primitiveTopo;
+	return true;
+}
+
+bool RenderTF_ComputePipelineDescToTheForge(Render_ComputePipelineDesc const *desc, TheForge_PipelineDesc *out) {
+	TheForge_PipelineDesc &pipelineDesc = *out;
+	pipelineDesc = {};
+	pipelineDesc.type = TheForge_PT_COMPUTE;
+	TheForge_GraphicsPipelineDesc &gfxPipeDesc = pipelineDesc.graphicsDesc;
+
+	gfxPipeDesc.shaderProgram = Render_ShaderHandleToPtr(desc->shader)->shader;
+	gfxPipeDesc.rootSignature = Render_RootSignatureHandleToPtr(desc->rootSignature)->signature;
+	return true;
+}
+
+AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreate(Render_RendererHandle renderer,
+																																					 Render_GraphicsPipelineDesc const *desc) {
+	RenderTF_PipelineManifestEntry entry;
+	RenderTF_PipelineCacheMakeGraphicsEntry(renderer, desc, &entry);
+	Render_PipelineHandle prewarmed = RenderTF_PipelineCacheRecord(renderer, &entry);
+	if (Render_PipelineHandleIsValid(prewarmed)) {
+		return prewarmed;
+	}
+
+	TheForge_PipelineDesc pipelineDesc;
+	if (!RenderTF_GraphicsPipelineDescToTheForge(desc, &pipelineDesc)) {
+		return {0};
+	}
 
 	Render_PipelineHandle handle = Render_PipelineHandleAlloc();
 	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(handle);
+	pipeline->job = nullptr;
+	pipeline->fallback = {0};
 	TheForge_AddPipeline(renderer->renderer, &pipelineDesc, &pipeline->pipeline);
 	if(!pipeline->pipeline) {
 		Render_PipelineHandleRelease(handle);
@@ -40,15 +77,22 @@ AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreate(Render_Render
 
 AL2O3_EXTERN_C Render_PipelineHandle Render_ComputePipelineCreate(Render_RendererHandle renderer,
 																																				 Render_ComputePipelineDesc const *desc) {
-	TheForge_PipelineDesc pipelineDesc{};
-	pipelineDesc.type = TheForge_PT_COMPUTE;
-	TheForge_GraphicsPipelineDesc &gfxPipeDesc = pipelineDesc.graphicsDesc;
+	RenderTF_PipelineManifestEntry entry;
+	RenderTF_PipelineCacheMakeComputeEntry(desc, &entry);
+	Render_PipelineHandle prewarmed = RenderTF_PipelineCacheRecord(renderer, &entry);
+	if (Render_PipelineHandleIsValid(prewarmed)) {
+		return prewarmed;
+	}
 
-	gfxPipeDesc.shaderProgram = Render_ShaderHandleToPtr(desc->shader)->shader;
-	gfxPipeDesc.rootSignature = Render_RootSignatureHandleToPtr(desc->rootSignature)->signature;
+	TheForge_PipelineDesc pipelineDesc;
+	if (!RenderTF_ComputePipelineDescToTheForge(desc, &pipelineDesc)) {
+		return {0};
+	}
 
 	Render_PipelineHandle handle = Render_PipelineHandleAlloc();
 	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(handle);
+	pipeline->job = nullptr;
+	pipeline->fallback = {0};
 	TheForge_AddPipeline(renderer->renderer, &pipelineDesc, &pipeline->pipeline);
 	if(!pipeline->pipeline) {
 		Render_PipelineHandleRelease(handle);
@@ -58,13 +102,78 @@ AL2O3_EXTERN_C Render_PipelineHandle Render_ComputePipelineCreate(Render_Rendere
 	return handle;
 }
 
+AL2O3_EXTERN_C Render_PipelineHandle Render_GraphicsPipelineCreateAsync(Render_RendererHandle renderer,
+																																				Render_GraphicsPipelineDesc const *desc,
+																																				Render_PipelineHandle fallback) {
+	RenderTF_PipelineManifestEntry entry;
+	RenderTF_PipelineCacheMakeGraphicsEntry(renderer, desc, &entry);
+	Render_PipelineHandle prewarmed = RenderTF_PipelineCacheRecord(renderer, &entry);
+	if (Render_PipelineHandleIsValid(prewarmed)) {
+		return prewarmed;
+	}
+
+	if (!renderer->pipelineCompiler) {
+		renderer->pipelineCompiler = RenderTF_PipelineCompilerCreate(renderer);
+		if (!renderer->pipelineCompiler) {
+			LOGWARNING("RenderTF_PipelineCompilerCreate failed, creating pipeline synchronously");
+			return Render_GraphicsPipelineCreate(renderer, desc);
+		}
+	}
+
+	TheForge_PipelineDesc pipelineDesc;
+	if (!RenderTF_GraphicsPipelineDescToTheForge(desc, &pipelineDesc)) {
+		return {0};
+	}
+
+	Render_PipelineHandle handle = Render_PipelineHandleAlloc();
+	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(handle);
+	pipeline->pipeline = nullptr;
+	pipeline->fallback = fallback;
+	// the job holds the raw shader and root signature, which the app keeps alive until
+	// the pipeline is ready (see Render_GraphicsPipelineCreateAsync)
+	pipeline->job = RenderTF_PipelineCompilerQueue(renderer->pipelineCompiler, &pipelineDesc);
+	if (!pipeline->job) {
+		Render_PipelineHandleRelease(handle);
+		return {0};
+	}
+
+	return handle;
+}
+
+AL2O3_EXTERN_C bool Render_PipelineIsReady(Render_PipelineHandle handle) {
+	if (!Render_PipelineHandleIsValid(handle)) {
+		return false;
+	}
+	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(handle);
+	if (pipeline->job) {
+		TheForge_PipelineHandle compiled;
+		if (!RenderTF_PipelineJobComplete(pipeline->job, &compiled)) {
+			return false;
+		}
+		pipeline->job = nullptr;
+		pipeline->pipeline = compiled;
+		if (!compiled) {
+			LOGERROR("Async pipeline creation failed");
+		}
+	}
+
+	return pipeline->pipeline != nullptr;
+}
+
 AL2O3_EXTERN_C void Render_PipelineDestroy(Render_RendererHandle renderer,
 																									 Render_PipelineHandle handle) {
 	if (!renderer || !Render_PipelineHandleIsValid(handle)) {
 		return;
 	}
 	Render_Pipeline* pipeline = Render_PipelineHandleToPtr(handle);
+	if (pipeline->job) {
+		pipeline->pipeline = RenderTF_PipelineJobCancel(renderer->pipelineCompiler, pipeline->job);
+		pipeline->job = nullptr;
+	}
 
-	TheForge_RemovePipeline(renderer->renderer, pipeline->pipeline);
+	if (pipeline->pipeline) {
+		TheForge_RemovePipeline(renderer->renderer, pipeline->pipeline);
+	}
 	Render_PipelineHandleRelease(handle);
 }
+
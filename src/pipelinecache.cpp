@@ -0,0 +1,436 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_cadt/dictu64.h"
+#include "al2o3_thread/thread.hpp"
+#include "al2o3_vfile/vfile.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/theforge/pipeline.h"
+#include "render_basics/api.h"
+#include "pipelinecache.hpp"
+#include "hash.hpp"
+#include <atomic>
+
+namespace {
+
+static const uint32_t ManifestMagic = 0x4D504252; // RBPM
+static const uint32_t ManifestVersion = 2; // 2: entry and vertex layout hashes are per field
+static const uint32_t MaxPrewarmThreads = 16;
+
+struct ManifestHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entrySize;
+	uint32_t entryCount;
+};
+
+struct Prewarmed {
+	uint64_t hash;
+	Render_PipelineHandle pipeline; // invalid once claimed
+};
+
+struct PrewarmJob {
+	uint64_t hash;
+	TheForge_PipelineDesc desc;
+	TinyImageFormat colourFormats[8];
+	TheForge_PipelineHandle pipeline;
+};
+
+struct PrewarmContext {
+	TheForge_RendererHandle renderer;
+	PrewarmJob *jobs;
+	uint32_t jobCount;
+	std::atomic<uint32_t> nextJob;
+};
+
+void PrewarmWorker(void *data) {
+	auto ctx = (PrewarmContext *) data;
+	while (true) {
+		uint32_t const index = ctx->nextJob.fetch_add(1);
+		if (index >= ctx->jobCount) {
+			return;
+		}
+		PrewarmJob *job = &ctx->jobs[index];
+		TheForge_AddPipeline(ctx->renderer, &job->desc, &job->pipeline);
+	}
+}
+
+// field by field so padding never reaches the hash, manifests from another build must
+// hash the same
+uint64_t HashEntry(RenderTF_PipelineManifestEntry const *entry) {
+	uint64_t hash = RenderTF_HashU64(entry->type);
+	hash = RenderTF_HashU64(entry->colourRenderTargetCount, hash);
+	hash = RenderTF_HashU64(entry->shader, hash);
+	hash = RenderTF_HashU64(entry->rootSignature, hash);
+	hash = RenderTF_HashU64(entry->blendState, hash);
+	hash = RenderTF_HashU64(entry->depthState, hash);
+	hash = RenderTF_HashU64(entry->rasteriserState, hash);
+	hash = RenderTF_HashU64(entry->vertexLayout, hash);
+	for (uint32_t i = 0; i < 8; ++i) {
+		hash = RenderTF_HashU64(entry->colourFormats[i], hash);
+	}
+	hash = RenderTF_HashU64(entry->depthStencilFormat, hash);
+	hash = RenderTF_HashU64(entry->sampleCount, hash);
+	hash = RenderTF_HashU64(entry->sampleQuality, hash);
+	return RenderTF_HashU64(entry->primitiveTopo, hash);
+}
+
+// only the used attribs, names up to their length
+uint64_t HashVertexLayout(Render_VertexLayout const *layout) {
+	uint64_t hash = RenderTF_HashU64(layout->attribCount);
+	for (uint32_t i = 0; i < layout->attribCount; ++i) {
+		TheForge_VertexAttrib const *attrib = &layout->attribs[i];
+		hash = RenderTF_HashU64((uint64_t) attrib->semantic, hash);
+		hash = RenderTF_Hash(attrib->semanticName, attrib->semanticNameLength, hash);
+		hash = RenderTF_HashU64((uint64_t) attrib->format, hash);
+		hash = RenderTF_HashU64(attrib->binding, hash);
+		hash = RenderTF_HashU64(attrib->location, hash);
+		hash = RenderTF_HashU64(attrib->offset, hash);
+		hash = RenderTF_HashU64((uint64_t) attrib->rate, hash);
+	}
+	return hash;
+}
+
+} // end anon namespace
+
+struct RenderTF_PipelineCache {
+	Thread_Mutex mutex;
+
+	CADT_DictU64Handle registry[RenderTF_RT_COUNT];
+
+	CADT_VectorHandle manifest;       // RenderTF_PipelineManifestEntry
+	CADT_DictU64Handle manifestLookup; // entry hash -> manifest index
+
+	CADT_VectorHandle prewarmed;       // Prewarmed
+	CADT_DictU64Handle prewarmedLookup; // entry hash -> prewarmed index
+};
+
+RenderTF_PipelineCache *RenderTF_PipelineCacheCreate() {
+	auto cache = (RenderTF_PipelineCache *) MEMORY_CALLOC(1, sizeof(RenderTF_PipelineCache));
+	if (!cache) {
+		return nullptr;
+	}
+	Thread_MutexCreate(&cache->mutex);
+	for (uint32_t i = 0; i < RenderTF_RT_COUNT; ++i) {
+		cache->registry[i] = CADT_DictU64Create();
+	}
+	cache->manifest = CADT_VectorCreate(sizeof(RenderTF_PipelineManifestEntry));
+	cache->manifestLookup = CADT_DictU64Create();
+	cache->prewarmed = CADT_VectorCreate(sizeof(Prewarmed));
+	cache->prewarmedLookup = CADT_DictU64Create();
+
+	return cache;
+}
+
+void RenderTF_PipelineCacheDestroy(Render_RendererHandle renderer, RenderTF_PipelineCache *cache) {
+	if (!cache) {
+		return;
+	}
+
+	// any prewarmed pipelines that were never claimed are still owned by the cache
+	Prewarmed *prewarmed = (Prewarmed *) CADT_VectorData(cache->prewarmed);
+	for (size_t i = 0; i < CADT_VectorSize(cache->prewarmed); ++i) {
+		Render_PipelineDestroy(renderer, prewarmed[i].pipeline);
+	}
+
+	CADT_DictU64Destroy(cache->prewarmedLookup);
+	CADT_VectorDestroy(cache->prewarmed);
+	CADT_DictU64Destroy(cache->manifestLookup);
+	CADT_VectorDestroy(cache->manifest);
+	for (uint32_t i = 0; i < RenderTF_RT_COUNT; ++i) {
+		CADT_DictU64Destroy(cache->registry[i]);
+	}
+	Thread_MutexDestroy(&cache->mutex);
+
+	MEMORY_FREE(cache);
+}
+
+void RenderTF_PipelineCacheRegister(Render_RendererHandle renderer,
+																		RenderTF_RegistryType type,
+																		uint64_t hash,
+																		uint64_t object) {
+	RenderTF_PipelineCache *cache = renderer->pipelineCache;
+	if (!cache) {
+		return; // renderer shutdown
+	}
+
+	Thread::MutexLock lock(&cache->mutex);
+
+	// equal objects are interchangable for prewarming, first one registered wins
+	if (!CADT_DictU64KeyExists(cache->registry[type], hash)) {
+		CADT_DictU64Add(cache->registry[type], hash, object);
+	}
+}
+
+void RenderTF_PipelineCacheUnregister(Render_RendererHandle renderer,
+																			RenderTF_RegistryType type,
+																			uint64_t hash,
+																			uint64_t object) {
+	RenderTF_PipelineCache *cache = renderer->pipelineCache;
+	if (!cache) {
+		return; // renderer shutdown
+	}
+
+	Thread::MutexLock lock(&cache->mutex);
+
+	if (CADT_DictU64KeyExists(cache->registry[type], hash) &&
+			CADT_DictU64Get(cache->registry[type], hash) == object) {
+		CADT_DictU64Remove(cache->registry[type], hash);
+	}
+}
+
+void RenderTF_PipelineCacheMakeGraphicsEntry(Render_RendererHandle renderer,
+																						 Render_GraphicsPipelineDesc const *desc,
+																						 RenderTF_PipelineManifestEntry *out) {
+	memset(out, 0, sizeof(RenderTF_PipelineManifestEntry));
+	out->type = TheForge_PT_GRAPHICS;
+	out->shader = Render_ShaderHandleToPtr(desc->shader)->hash;
+	out->rootSignature = Render_RootSignatureHandleToPtr(desc->rootSignature)->hash;
+	out->blendState = Render_BlendStateHandleToPtr(desc->blendState)->hash;
+	out->depthState = Render_DepthStateHandleToPtr(desc->depthState)->hash;
+	out->rasteriserState = Render_RasteriserStateHandleToPtr(desc->rasteriserState)->hash;
+	if (desc->vertexLayout) {
+		out->vertexLayout = HashVertexLayout(desc->vertexLayout);
+		RenderTF_PipelineCacheRegister(renderer, RenderTF_RT_VERTEXLAYOUT, out->vertexLayout, (uint64_t) desc->vertexLayout);
+	}
+
+	ASSERT(desc->colourRenderTargetCount <= 8);
+	out->colourRenderTargetCount = desc->colourRenderTargetCount;
+	for (uint32_t i = 0; i < desc->colourRenderTargetCount; ++i) {
+		out->colourFormats[i] = (uint32_t) desc->colourFormats[i];
+	}
+	out->depthStencilFormat = (uint32_t) desc->depthStencilFormat;
+	out->sampleCount = desc->sampleCount;
+	out->sampleQuality = desc->sampleQuality;
+	out->primitiveTopo = (uint32_t) desc->primitiveTopo;
+
+	out->hash = HashEntry(out);
+}
+
+void RenderTF_PipelineCacheMakeComputeEntry(Render_ComputePipelineDesc const *desc,
+																						RenderTF_PipelineManifestEntry *out) {
+	memset(out, 0, sizeof(RenderTF_PipelineManifestEntry));
+	out->type = TheForge_PT_COMPUTE;
+	out->shader = Render_ShaderHandleToPtr(desc->shader)->hash;
+	out->rootSignature = Render_RootSignatureHandleToPtr(desc->rootSignature)->hash;
+
+	out->hash = HashEntry(out);
+}
+
+Render_PipelineHandle RenderTF_PipelineCacheRecord(Render_RendererHandle renderer,
+																									 RenderTF_PipelineManifestEntry const *entry) {
+	RenderTF_PipelineCache *cache = renderer->pipelineCache;
+	Thread::MutexLock lock(&cache->mutex);
+
+	if (!CADT_DictU64KeyExists(cache->manifestLookup, entry->hash)) {
+		size_t const index = CADT_VectorPushElement(cache->manifest, (void *) entry);
+		CADT_DictU64Add(cache->manifestLookup, entry->hash, index);
+	}
+
+	if (!CADT_DictU64KeyExists(cache->prewarmedLookup, entry->hash)) {
+		return {0};
+	}
+
+	Prewarmed *prewarmed = (Prewarmed *) CADT_VectorData(cache->prewarmed);
+	size_t const index = CADT_DictU64Get(cache->prewarmedLookup, entry->hash);
+	Render_PipelineHandle handle = prewarmed[index].pipeline;
+	prewarmed[index].pipeline = {0};
+	CADT_DictU64Remove(cache->prewarmedLookup, entry->hash);
+
+	return handle;
+}
+
+AL2O3_EXTERN_C bool Render_RendererSavePipelineManifest(Render_RendererHandle renderer, VFile_Handle file) {
+	if (!renderer || !file) {
+		return false;
+	}
+	RenderTF_PipelineCache *cache = renderer->pipelineCache;
+	Thread::MutexLock lock(&cache->mutex);
+
+	ManifestHeader const header{
+			ManifestMagic,
+			ManifestVersion,
+			sizeof(RenderTF_PipelineManifestEntry),
+			(uint32_t) CADT_VectorSize(cache->manifest),
+	};
+	size_t const entriesSize = header.entryCount * sizeof(RenderTF_PipelineManifestEntry);
+
+	if (VFile_Write(file, &header, sizeof(ManifestHeader)) != sizeof(ManifestHeader)) {
+		return false;
+	}
+	return VFile_Write(file, CADT_VectorData(cache->manifest), entriesSize) == entriesSize;
+}
+
+AL2O3_EXTERN_C void Render_RendererRegisterVertexLayout(Render_RendererHandle renderer,
+																												Render_VertexLayoutHandle layout) {
+	if (!renderer || !layout) {
+		return;
+	}
+	uint64_t const hash = HashVertexLayout(layout);
+	RenderTF_PipelineCacheRegister(renderer, RenderTF_RT_VERTEXLAYOUT, hash, (uint64_t) layout);
+}
+
+static bool ResolveEntry(RenderTF_PipelineCache *cache,
+												 RenderTF_PipelineManifestEntry const *entry,
+												 PrewarmJob *job) {
+	auto resolve = [cache](RenderTF_RegistryType type, uint64_t hash, uint64_t *out) {
+		if (!CADT_DictU64KeyExists(cache->registry[type], hash)) {
+			return false;
+		}
+		*out = CADT_DictU64Get(cache->registry[type], hash);
+		return true;
+	};
+
+	uint64_t shader, rootSignature;
+	if (!resolve(RenderTF_RT_SHADER, entry->shader, &shader) ||
+			!resolve(RenderTF_RT_ROOTSIGNATURE, entry->rootSignature, &rootSignature)) {
+		return false;
+	}
+
+	memset(job, 0, sizeof(PrewarmJob));
+	job->hash = entry->hash;
+
+	if (entry->type == TheForge_PT_COMPUTE) {
+		Render_ComputePipelineDesc desc{};
+		desc.shader.handle = (Handle_Handle32) shader;
+		desc.rootSignature.handle = (Handle_Handle32) rootSignature;
+		return RenderTF_ComputePipelineDescToTheForge(&desc, &job->desc);
+	}
+
+	uint64_t blendState, depthState, rasteriserState;
+	uint64_t vertexLayout = 0;
+	if (!resolve(RenderTF_RT_BLENDSTATE, entry->blendState, &blendState) ||
+			!resolve(RenderTF_RT_DEPTHSTATE, entry->depthState, &depthState) ||
+			!resolve(RenderTF_RT_RASTERISERSTATE, entry->rasteriserState, &rasteriserState)) {
+		return false;
+	}
+	if (entry->vertexLayout && !resolve(RenderTF_RT_VERTEXLAYOUT, entry->vertexLayout, &vertexLayout)) {
+		return false;
+	}
+	if (entry->colourRenderTargetCount > 8) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < entry->colourRenderTargetCount; ++i) {
+		job->colourFormats[i] = (TinyImageFormat) entry->colourFormats[i];
+	}
+
+	Render_GraphicsPipelineDesc desc{};
+	desc.shader.handle = (Handle_Handle32) shader;
+	desc.rootSignature.handle = (Handle_Handle32) rootSignature;
+	desc.blendState.handle = (Handle_Handle32) blendState;
+	desc.depthState.handle = (Handle_Handle32) depthState;
+	desc.rasteriserState.handle = (Handle_Handle32) rasteriserState;
+	desc.vertexLayout = (Render_VertexLayoutHandle) vertexLayout;
+	desc.colourRenderTargetCount = entry->colourRenderTargetCount;
+	desc.colourFormats = job->colourFormats;
+	desc.depthStencilFormat = (TinyImageFormat) entry->depthStencilFormat;
+	desc.sampleCount = entry->sampleCount;
+	desc.sampleQuality = entry->sampleQuality;
+	desc.primitiveTopo = (decltype(desc.primitiveTopo)) entry->primitiveTopo;
+	return RenderTF_GraphicsPipelineDescToTheForge(&desc, &job->desc);
+}
+
+AL2O3_EXTERN_C uint32_t Render_RendererPrewarmPipelines(Render_RendererHandle renderer, VFile_Handle manifest) {
+	if (!renderer || !manifest) {
+		return 0;
+	}
+
+	ManifestHeader header;
+	if (VFile_Read(manifest, &header, sizeof(ManifestHeader)) != sizeof(ManifestHeader) ||
+			header.magic != ManifestMagic ||
+			header.version != ManifestVersion ||
+			header.entrySize != sizeof(RenderTF_PipelineManifestEntry)) {
+		LOGWARNING("Pipeline manifest %s is not valid or an old version, ignoring", VFile_GetName(manifest));
+		return 0;
+	}
+	if (header.entryCount == 0) {
+		return 0;
+	}
+
+	size_t const entriesSize = header.entryCount * sizeof(RenderTF_PipelineManifestEntry);
+	auto entries = (RenderTF_PipelineManifestEntry *) MEMORY_MALLOC(entriesSize);
+	auto jobs = (PrewarmJob *) MEMORY_CALLOC(header.entryCount, sizeof(PrewarmJob));
+	if (!entries || !jobs || VFile_Read(manifest, entries, entriesSize) != entriesSize) {
+		MEMORY_FREE(jobs);
+		MEMORY_FREE(entries);
+		return 0;
+	}
+
+	RenderTF_PipelineCache *cache = renderer->pipelineCache;
+	uint32_t jobCount = 0;
+	{
+		Thread::MutexLock lock(&cache->mutex);
+		for (uint32_t i = 0; i < header.entryCount; ++i) {
+			RenderTF_PipelineManifestEntry const *entry = &entries[i];
+			// skip corrupt, already used or already prewarmed entries
+			if (entry->hash != HashEntry(entry) ||
+					CADT_DictU64KeyExists(cache->manifestLookup, entry->hash) ||
+					CADT_DictU64KeyExists(cache->prewarmedLookup, entry->hash)) {
+				continue;
+			}
+			// resolved in place as the desc points at the jobs colour formats
+			if (ResolveEntry(cache, entry, &jobs[jobCount])) {
+				jobCount++;
+			}
+		}
+	}
+
+	if (jobCount != header.entryCount) {
+		LOGINFO("Pipeline manifest: %u of %u entries can't be prewarmed", header.entryCount - jobCount, header.entryCount);
+	}
+
+	// the jobs now hold raw TheForge objects, the caller guarantees they stay alive until
+	// the workers are joined (see Render_RendererPrewarmPipelines)
+	PrewarmContext ctx;
+	ctx.renderer = renderer->renderer;
+	ctx.jobs = jobs;
+	ctx.jobCount = jobCount;
+	ctx.nextJob = 0;
+
+	// the calling thread works as well, so one less worker than cores
+	uint32_t threadCount = Thread_CPUCoreCount();
+	threadCount = threadCount > 1 ? threadCount - 1 : 1;
+	threadCount = threadCount > MaxPrewarmThreads ? MaxPrewarmThreads : threadCount;
+	threadCount = threadCount > jobCount ? jobCount : threadCount;
+
+	Thread_Thread threads[MaxPrewarmThreads];
+	uint32_t threadsStarted = 0;
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		if (Thread_ThreadCreate(&threads[threadsStarted], &PrewarmWorker, &ctx)) {
+			threadsStarted++;
+		}
+	}
+	PrewarmWorker(&ctx);
+	for (uint32_t i = 0; i < threadsStarted; ++i) {
+		Thread_ThreadJoin(&threads[i]);
+		Thread_ThreadDestroy(&threads[i]);
+	}
+
+	uint32_t prewarmedCount = 0;
+	{
+		Thread::MutexLock lock(&cache->mutex);
+		for (uint32_t i = 0; i < jobCount; ++i) {
+			if (!jobs[i].pipeline) {
+				continue;
+			}
+			Render_PipelineHandle handle = Render_PipelineHandleAlloc();
+			Render_Pipeline *pipeline = Render_PipelineHandleToPtr(handle);
+			pipeline->pipeline = jobs[i].pipeline;
+			pipeline->job = nullptr;
+			pipeline->fallback = {0};
+
+			Prewarmed const prewarmed{jobs[i].hash, handle};
+			size_t const index = CADT_VectorPushElement(cache->prewarmed, (void *) &prewarmed);
+			CADT_DictU64Add(cache->prewarmedLookup, jobs[i].hash, index);
+			prewarmedCount++;
+		}
+	}
+
+	MEMORY_FREE(jobs);
+	MEMORY_FREE(entries);
+
+	return prewarmedCount;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/pipeline.h"
+
+// objects that a pipeline manifest entry refers to by hash, must be alive
+// (and so registered) when a manifest is prewarmed
+enum RenderTF_RegistryType {
+	RenderTF_RT_SHADER,
+	RenderTF_RT_ROOTSIGNATURE,
+	RenderTF_RT_BLENDSTATE,
+	RenderTF_RT_DEPTHSTATE,
+	RenderTF_RT_RASTERISERSTATE,
+	RenderTF_RT_VERTEXLAYOUT,
+
+	RenderTF_RT_COUNT
+};
+
+// POD record written to the manifest file, all fields are naturally aligned
+// so there is no padding and the hash can be taken over the raw bytes
+struct RenderTF_PipelineManifestEntry {
+	uint64_t hash; // of everything after this field
+
+	uint32_t type; // TheForge_PipelineType
+	uint32_t colourRenderTargetCount;
+
+	uint64_t shader;
+	uint64_t rootSignature;
+	uint64_t blendState;
+	uint64_t depthState;
+	uint64_t rasteriserState;
+	uint64_t vertexLayout;
+
+	uint32_t colourFormats[8];
+	uint32_t depthStencilFormat;
+	uint32_t sampleCount;
+	uint32_t sampleQuality;
+	uint32_t primitiveTopo;
+};
+
+struct RenderTF_PipelineCache *RenderTF_PipelineCacheCreate();
+void RenderTF_PipelineCacheDestroy(Render_RendererHandle renderer, struct RenderTF_PipelineCache *cache);
+
+void RenderTF_PipelineCacheRegister(Render_RendererHandle renderer, RenderTF_RegistryType type, uint64_t hash, uint64_t object);
+void RenderTF_PipelineCacheUnregister(Render_RendererHandle renderer, RenderTF_RegistryType type, uint64_t hash, uint64_t object);
+
+// graphics entries also register the vertex layout so manifests can find it again
+void RenderTF_PipelineCacheMakeGraphicsEntry(Render_RendererHandle renderer,
+																						 Render_GraphicsPipelineDesc const *desc,
+																						 RenderTF_PipelineManifestEntry *out);
+void RenderTF_PipelineCacheMakeComputeEntry(Render_ComputePipelineDesc const *desc, RenderTF_PipelineManifestEntry *out);
+
+// records the entry in the usage manifest and returns a prewarmed pipeline if one matches
+// ownership of the returned pipeline passes to the caller
+Render_PipelineHandle RenderTF_PipelineCacheRecord(Render_RendererHandle renderer, RenderTF_PipelineManifestEntry const *entry);
+
+// implemented in pipeline.cpp, shared so prewarming builds exactly what the create functions would
+bool RenderTF_GraphicsPipelineDescToTheForge(Render_GraphicsPipelineDesc const *desc, TheForge_PipelineDesc *out);
+bool RenderTF_ComputePipelineDescToTheForge(Render_ComputePipelineDesc const *desc, TheForge_PipelineDesc *out);
@@ -0,0 +1,184 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/thread.hpp"
+
+#include "render_basics/theforge/api.h"
+#include "pipelinecompiler.hpp"
+#include <atomic>
+
+namespace {
+
+enum class JobState : uint32_t {
+	Queued,
+	Compiling,
+	Done
+};
+
+} // end anon namespace
+
+struct RenderTF_PipelineJob {
+	RenderTF_PipelineJob *next;
+
+	TheForge_PipelineDesc desc;
+	TinyImageFormat colourFormats[8];
+
+	TheForge_PipelineHandle pipeline;
+	std::atomic<JobState> state;
+};
+
+struct RenderTF_PipelineCompiler {
+	TheForge_RendererHandle renderer;
+
+	Thread_Thread thread;
+	Thread_Mutex mutex;
+	Thread_ConditionalVariable workAvailable;
+	Thread_ConditionalVariable jobDone;
+
+	// FIFO protected by mutex
+	RenderTF_PipelineJob *head;
+	RenderTF_PipelineJob *tail;
+	bool quit;
+};
+
+static void CompilerWorker(void *data) {
+	auto compiler = (RenderTF_PipelineCompiler *) data;
+
+	while (true) {
+		Thread_MutexAcquire(&compiler->mutex);
+		while (compiler->head == nullptr && !compiler->quit) {
+			Thread_CondVarWait(&compiler->workAvailable, &compiler->mutex, ~0ull);
+		}
+		if (compiler->quit) {
+			Thread_MutexRelease(&compiler->mutex);
+			return;
+		}
+
+		RenderTF_PipelineJob *job = compiler->head;
+		compiler->head = job->next;
+		if (compiler->head == nullptr) {
+			compiler->tail = nullptr;
+		}
+		job->state.store(JobState::Compiling, std::memory_order_relaxed);
+		Thread_MutexRelease(&compiler->mutex);
+
+		TheForge_AddPipeline(compiler->renderer, &job->desc, &job->pipeline);
+
+		Thread_MutexAcquire(&compiler->mutex);
+		job->state.store(JobState::Done, std::memory_order_release);
+		Thread_CondVarWakeAll(&compiler->jobDone);
+		Thread_MutexRelease(&compiler->mutex);
+	}
+}
+
+RenderTF_PipelineCompiler *RenderTF_PipelineCompilerCreate(Render_RendererHandle renderer) {
+	auto compiler = (RenderTF_PipelineCompiler *) MEMORY_CALLOC(1, sizeof(RenderTF_PipelineCompiler));
+	if (!compiler) {
+		return nullptr;
+	}
+	compiler->renderer = renderer->renderer;
+	Thread_MutexCreate(&compiler->mutex);
+	Thread_CondVarCreate(&compiler->workAvailable);
+	Thread_CondVarCreate(&compiler->jobDone);
+
+	if (!Thread_ThreadCreate(&compiler->thread, &CompilerWorker, compiler)) {
+		Thread_CondVarDestroy(&compiler->jobDone);
+		Thread_CondVarDestroy(&compiler->workAvailable);
+		Thread_MutexDestroy(&compiler->mutex);
+		MEMORY_FREE(compiler);
+		return nullptr;
+	}
+
+	return compiler;
+}
+
+void RenderTF_PipelineCompilerDestroy(RenderTF_PipelineCompiler *compiler) {
+	if (!compiler) {
+		return;
+	}
+
+	Thread_MutexAcquire(&compiler->mutex);
+	compiler->quit = true;
+	Thread_CondVarWakeAll(&compiler->workAvailable);
+	Thread_MutexRelease(&compiler->mutex);
+
+	Thread_ThreadJoin(&compiler->thread);
+	Thread_ThreadDestroy(&compiler->thread);
+
+	// pipelines own their jobs so should have been destroyed before the renderer
+	ASSERT(compiler->head == nullptr);
+
+	Thread_CondVarDestroy(&compiler->jobDone);
+	Thread_CondVarDestroy(&compiler->workAvailable);
+	Thread_MutexDestroy(&compiler->mutex);
+	MEMORY_FREE(compiler);
+}
+
+RenderTF_PipelineJob *RenderTF_PipelineCompilerQueue(RenderTF_PipelineCompiler *compiler,
+																										 TheForge_PipelineDesc const *desc) {
+	auto job = (RenderTF_PipelineJob *) MEMORY_CALLOC(1, sizeof(RenderTF_PipelineJob));
+	if (!job) {
+		return nullptr;
+	}
+	job->desc = *desc;
+	if (desc->type == TheForge_PT_GRAPHICS) {
+		ASSERT(desc->graphicsDesc.renderTargetCount <= 8);
+		memcpy(job->colourFormats, desc->graphicsDesc.pColorFormats,
+					 sizeof(TinyImageFormat) * desc->graphicsDesc.renderTargetCount);
+		job->desc.graphicsDesc.pColorFormats = job->colourFormats;
+	}
+	job->state.store(JobState::Queued, std::memory_order_relaxed);
+
+	Thread::MutexLock lock(&compiler->mutex);
+	if (compiler->tail) {
+		compiler->tail->next = job;
+	} else {
+		compiler->head = job;
+	}
+	compiler->tail = job;
+	Thread_CondVarWakeOne(&compiler->workAvailable);
+
+	return job;
+}
+
+bool RenderTF_PipelineJobComplete(RenderTF_PipelineJob *job, TheForge_PipelineHandle *out) {
+	if (job->state.load(std::memory_order_acquire) != JobState::Done) {
+		return false;
+	}
+	*out = job->pipeline;
+	MEMORY_FREE(job);
+	return true;
+}
+
+TheForge_PipelineHandle RenderTF_PipelineJobCancel(RenderTF_PipelineCompiler *compiler, RenderTF_PipelineJob *job) {
+	Thread_MutexAcquire(&compiler->mutex);
+
+	if (job->state.load(std::memory_order_relaxed) == JobState::Queued) {
+		// unlink, the worker hasn't seen it yet
+		RenderTF_PipelineJob *prev = nullptr;
+		RenderTF_PipelineJob *cur = compiler->head;
+		while (cur != job) {
+			prev = cur;
+			cur = cur->next;
+		}
+		if (prev) {
+			prev->next = job->next;
+		} else {
+			compiler->head = job->next;
+		}
+		if (compiler->tail == job) {
+			compiler->tail = prev;
+		}
+		Thread_MutexRelease(&compiler->mutex);
+		MEMORY_FREE(job);
+		return nullptr;
+	}
+
+	while (job->state.load(std::memory_order_acquire) != JobState::Done) {
+		Thread_CondVarWait(&compiler->jobDone, &compiler->mutex, ~0ull);
+	}
+	Thread_MutexRelease(&compiler->mutex);
+
+	TheForge_PipelineHandle pipeline = job->pipeline;
+	MEMORY_FREE(job);
+	return pipeline;
+}
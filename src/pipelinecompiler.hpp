@@ -0,0 +1,25 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+// single background thread that runs TheForge_AddPipeline for async pipeline creation
+// jobs are owned by the Render_Pipeline that queued them and must only be polled
+// or cancelled from one thread (normally the render thread)
+struct RenderTF_PipelineCompiler;
+struct RenderTF_PipelineJob;
+
+RenderTF_PipelineCompiler *RenderTF_PipelineCompilerCreate(Render_RendererHandle renderer);
+void RenderTF_PipelineCompilerDestroy(RenderTF_PipelineCompiler *compiler);
+
+// takes a copy of the desc (including the colour formats)
+RenderTF_PipelineJob *RenderTF_PipelineCompilerQueue(RenderTF_PipelineCompiler *compiler,
+																										 TheForge_PipelineDesc const *desc);
+
+// returns true once the job has finished, the job is then freed and out holds
+// the pipeline (nullptr if creation failed)
+bool RenderTF_PipelineJobComplete(RenderTF_PipelineJob *job, TheForge_PipelineHandle *out);
+
+// removes the job if not started else waits for it, the job is freed and any pipeline
+// that was built is returned for the caller to remove
+TheForge_PipelineHandle RenderTF_PipelineJobCancel(RenderTF_PipelineCompiler *compiler, RenderTF_PipelineJob *job);
@@ -1,11 +1,11 @@
 #include "al2o3_platform/platform.h"
-#include "al2o3_platform/utf8.h"
 #include "al2o3_cadt/vector.h"
 #include "render_basics/buffer.h"
 #include "render_basics/pipeline.h"
 #include "render_basics/framebuffer.h"
 #include "render_basics/graphicsencoder.h"
 #include "visdebug.hpp"
+#include "embeddedshaders.hpp"
 #include "render_basics/theforge/handlemanager.h"
 
 struct Solid {
@@ -48,74 +48,7 @@ struct Instance {
 };
 
 static Render_ShaderHandle CreateShaders(RenderTF_VisualDebug *vd) {
-	static char const *const VertexShader = "cbuffer uniformBlock : register(b0, space1)\n"
-																					"{\n"
-																					"\tfloat4x4 worldToViewMatrix;\n"
-																					"\tfloat4x4 viewToNDCMatrix;\n"
-																					"\tfloat4x4 worldToNDCMatrix;\n"
-																					"};\n"
-																					"struct VSInput\n"
-																					"{\n"
-																					"\tfloat4 Position : POSITION;\n"
-																					"\tfloat3 Normal   : NORMAL;\n"
-																					"\tfloat4 Colour   : COLOR;\n"
-																					"};\n"
-																					"\n"
-																					"struct InstanceInput\n"
-																					"{\n"
-																					"\tfloat4 localToWorldMatrixRow0 : INSTANCEROW0;\n"
-																					"\tfloat4 localToWorldMatrixRow1 : INSTANCEROW1;\n"
-																					"\tfloat4 localToWorldMatrixRow2 : INSTANCEROW2;\n"
-																					"};\n"
-																					"\n"
-																					"struct VSOutput {\n"
-																					"\tfloat4 Position : SV_POSITION;\n"
-																					"\tfloat4 Colour   : COLOR;\n"
-																					"};\n"
-																					"\n"
-																					"VSOutput VS_main(VSInput input, InstanceInput instance)\n"
-																					"{\n"
-																					"    VSOutput result;\n"
-																					"\n"
-																				 "\tfloat4x4 localToWorldMatrix;\n"
-																					"\tlocalToWorldMatrix[0] = instance.localToWorldMatrixRow0;\n"
-																					"\tlocalToWorldMatrix[1] = instance.localToWorldMatrixRow1;\n"
-																					"\tlocalToWorldMatrix[2] = instance.localToWorldMatrixRow2;\n"
-																					"\tlocalToWorldMatrix[3] = float4(0,0,0,1);\n"
-																					"\tfloat4 pos = mul(localToWorldMatrix, input.Position);\n"
-																					"\tresult.Position = mul(worldToNDCMatrix, pos);\n"
-																					"\tresult.Colour = float4((input.Normal*0.5)+float3(0.5,0.5,0.5),1);\n//input.Colour;\n"
-																					"\treturn result;\n"
-																					"}\n";
-
-	static char const *const FragmentShader = "struct FSInput {\n"
-																						"\tfloat4 Position : SV_POSITION;\n"
-																						"\tfloat4 Colour   : COLOR;\n"
-																						"};\n"
-																						"\n"
-																						"float4 FS_main(FSInput input) : SV_Target\n"
-																						"{\n"
-																						"\treturn input.Colour;\n"
-																						"}\n";
-
-	static char const *const vertEntryPoint = "VS_main";
-	static char const *const fragEntryPoint = "FS_main";
-
-	VFile_Handle vfile = VFile_FromMemory(VertexShader, utf8size(VertexShader) + 1, false);
-	if (!vfile) {
-		return {0};
-	}
-	VFile_Handle ffile = VFile_FromMemory(FragmentShader, utf8size(FragmentShader) + 1, false);
-	if (!ffile) {
-		VFile_Close(vfile);
-		return {0};
-	}
-	auto shader = Render_CreateShaderFromVFile(vd->renderer, vfile, "VS_main", ffile, "FS_main");
-
-	VFile_Close(vfile);
-	VFile_Close(ffile);
-
-	return shader;
+	return RenderTF_ShaderCreateEmbedded(vd->renderer, "platonicsolids_vertex", "copycolour_fragment");
 }
 
 uint32_t CreateTetrahedon(CADT_VectorHandle outPos) {
@@ -606,6 +539,16 @@ void RenderTF_PlatonicSolidsRender(RenderTF_VisualDebug *vd, Render_GraphicsEnco
 	}
 }
 
+bool RenderTF_PlatonicSolidsHasInstances(RenderTF_VisualDebug const *vd) {
+	RenderTF_PlatonicSolids const *ps = vd->platonicSolids;
+	for (auto i = 0; i < (int) SolidType::COUNT; ++i) {
+		if (CADT_VectorSize(ps->solids[i].instanceData)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 
 void RenderTF_PlatonicSolidsAddTetrahedron(RenderTF_VisualDebug* vd, Math_Mat4F transform) {
 	RenderTF_PlatonicSolids *ps = vd->platonicSolids;
@@ -0,0 +1,397 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "render_basics/graphicsencoder.h"
+#include "render_basics/theforge/readback.h"
+#include "readback.hpp"
+#include "framebuffer.hpp"
+
+namespace {
+
+uint64_t const MinBufferSize = 1024 * 1024;
+uint64_t const CopyAlignment = 512;     ///< satisfies d3d12 texture placement, fine for everything else
+uint32_t const RowPitchAlignment = 256;
+
+struct Request {
+	uint8_t const *data;
+	uint64_t size;
+	uint32_t rowPitch;
+	uint32_t slicePitch;
+	bool submitted;
+	TheForge_FenceHandle fence;   ///< of the submit after it was recorded, not owned
+};
+
+// a slot's previous frame, kept when the slot came round again while the gpu was still
+// writing it or a holder was reading it. Its requests stay pollable until it's released
+struct Generation {
+	uint64_t frame;
+	uint32_t slot;
+	TheForge_FenceHandle fence;
+	uint32_t holds;
+	CADT_VectorHandle buffers;    // TheForge_BufferHandle
+	CADT_VectorHandle requests;   // Request
+};
+
+struct Slot {
+	uint64_t frame;               ///< renderer frame count this slot's requests belong to
+	TheForge_FenceHandle fence;   ///< the last submit with requests, graphics queue fences complete in order
+	uint32_t holds;               ///< ready requests still being read, see RenderTF_ReadbackHold
+
+	TheForge_BufferHandle buffer;
+	uint8_t *data;
+	uint64_t capacity;
+	uint64_t used;
+
+	CADT_VectorHandle requests;   // Request
+	CADT_VectorHandle retired;    // TheForge_BufferHandle outgrown this frame, still holding data
+};
+
+} // end anon namespace
+
+struct RenderTF_Readback {
+	uint32_t slotCount;
+	Slot *slots;
+	CADT_VectorHandle generations; // Generation
+};
+
+namespace {
+
+bool IsComplete(Render_RendererHandle renderer, TheForge_FenceHandle fence) {
+	if (!fence) {
+		return true;
+	}
+	TheForge_FenceStatus fenceStatus;
+	TheForge_GetFenceStatus(renderer->renderer, fence, &fenceStatus);
+	return fenceStatus != TheForge_FS_INCOMPLETE;
+}
+
+void ReleaseRetired(Render_RendererHandle renderer, Slot *slot) {
+	auto retired = (TheForge_BufferHandle *) CADT_VectorData(slot->retired);
+	for (size_t i = 0; i < CADT_VectorSize(slot->retired); ++i) {
+		TheForge_RemoveBuffer(renderer->renderer, retired[i]);
+	}
+	CADT_VectorResize(slot->retired, 0);
+}
+
+// a finished generation is kept for another ring of frames so whoever is waiting on its
+// requests gets a chance to poll them
+void ReleaseGenerations(Render_RendererHandle renderer, RenderTF_Readback *readback, bool force) {
+	size_t i = 0;
+	while (i < CADT_VectorSize(readback->generations)) {
+		auto generations = (Generation *) CADT_VectorData(readback->generations);
+		Generation &generation = generations[i];
+		if (!force && (generation.holds ||
+				renderer->frameCount - generation.frame < 2 * readback->slotCount ||
+				!IsComplete(renderer, generation.fence))) {
+			++i;
+			continue;
+		}
+		auto buffers = (TheForge_BufferHandle *) CADT_VectorData(generation.buffers);
+		for (size_t j = 0; j < CADT_VectorSize(generation.buffers); ++j) {
+			TheForge_RemoveBuffer(renderer->renderer, buffers[j]);
+		}
+		CADT_VectorDestroy(generation.buffers);
+		CADT_VectorDestroy(generation.requests);
+		size_t const last = CADT_VectorSize(readback->generations) - 1;
+		generations[i] = generations[last];
+		CADT_VectorResize(readback->generations, last);
+	}
+}
+
+Generation *FindGeneration(RenderTF_Readback *readback, Render_ReadbackTicket ticket) {
+	auto generations = (Generation *) CADT_VectorData(readback->generations);
+	for (size_t i = 0; i < CADT_VectorSize(readback->generations); ++i) {
+		if (generations[i].frame == ticket.frame && generations[i].slot == ticket.slot) {
+			return &generations[i];
+		}
+	}
+	return nullptr;
+}
+
+// the slot is reused for a new frame, anything in it is from maxFramesAhead frames ago.
+// Frame buffer submits have been waited on by then but a standalone submit may not
+// have been, so the slot's buffers and requests move to a generation until it finishes
+// rather than waiting for it. Held requests are kept the same way until they're released
+Slot *CurrentSlot(Render_RendererHandle renderer) {
+	RenderTF_Readback *readback = renderer->readback;
+	uint32_t const slotIndex = renderer->frameIndex % readback->slotCount;
+	Slot *slot = &readback->slots[slotIndex];
+	if (slot->frame == renderer->frameCount) {
+		return slot;
+	}
+
+	ReleaseGenerations(renderer, readback, false);
+	if (slot->holds == 0 && IsComplete(renderer, slot->fence)) {
+		ReleaseRetired(renderer, slot);
+		CADT_VectorResize(slot->requests, 0);
+	} else {
+		Generation const generation{slot->frame, slotIndex, slot->fence, slot->holds, slot->retired, slot->requests};
+		if (slot->buffer) {
+			CADT_VectorPushElement(generation.buffers, &slot->buffer);
+		}
+		CADT_VectorPushElement(readback->generations, (void *) &generation);
+		slot->retired = CADT_VectorCreate(sizeof(TheForge_BufferHandle));
+		slot->requests = CADT_VectorCreate(sizeof(Request));
+		slot->buffer = nullptr;
+		slot->data = nullptr;
+		slot->capacity = 0;
+	}
+
+	slot->frame = renderer->frameCount;
+	slot->fence = nullptr;
+	slot->holds = 0;
+	slot->used = 0;
+	return slot;
+}
+
+// returns the offset into slot->buffer, which may have been replaced by a bigger one
+bool Alloc(Render_RendererHandle renderer, Slot *slot, uint64_t size, uint64_t *offset) {
+	uint64_t const alignedUsed = (slot->used + CopyAlignment - 1) & ~(CopyAlignment - 1);
+	if (!slot->buffer || alignedUsed + size > slot->capacity) {
+		uint64_t capacity = slot->capacity * 2;
+		if (capacity < size) {
+			capacity = size;
+		}
+		if (capacity < MinBufferSize) {
+			capacity = MinBufferSize;
+		}
+
+		TheForge_BufferDesc bufferDesc{};
+		bufferDesc.size = capacity;
+		bufferDesc.memoryUsage = TheForge_RMU_GPU_TO_CPU;
+		bufferDesc.flags = TheForge_BCF_PERSISTENT_MAP_BIT;
+		bufferDesc.startState = TheForge_RS_COPY_DEST;
+		TheForge_BufferHandle buffer = nullptr;
+		TheForge_AddBuffer(renderer->renderer, &bufferDesc, &buffer);
+		if (!buffer) {
+			LOGERROR("Readback buffer of %llu bytes creation failed", (unsigned long long) capacity);
+			return false;
+		}
+
+		// earlier requests this frame still point into the old buffer
+		if (slot->buffer) {
+			CADT_VectorPushElement(slot->retired, &slot->buffer);
+		}
+		slot->buffer = buffer;
+		slot->data = (uint8_t *) TheForge_BufferGetCpuMappedAddress(buffer);
+		slot->capacity = capacity;
+		slot->used = 0;
+		*offset = 0;
+	} else {
+		*offset = alignedUsed;
+	}
+	slot->used = *offset + size;
+	return true;
+}
+
+Render_ReadbackTicket AddRequest(Render_RendererHandle renderer,
+																 Slot *slot,
+																 uint64_t offset,
+																 uint64_t size,
+																 uint32_t rowPitch,
+																 uint32_t slicePitch) {
+	Request const request{slot->data + offset, size, rowPitch, slicePitch, false, nullptr};
+	size_t const index = CADT_VectorPushElement(slot->requests, (void *) &request);
+	return Render_ReadbackTicket{slot->frame, (uint32_t) (slot - renderer->readback->slots), (uint32_t) index};
+}
+
+uint32_t MipDimension(uint32_t dimension, uint32_t mipLevel) {
+	dimension = dimension >> mipLevel;
+	return dimension ? dimension : 1;
+}
+
+} // end anon namespace
+
+RenderTF_Readback *RenderTF_ReadbackCreate(Render_RendererHandle renderer) {
+	auto readback = (RenderTF_Readback *) MEMORY_CALLOC(1, sizeof(RenderTF_Readback));
+	if (!readback) {
+		return nullptr;
+	}
+	readback->slotCount = renderer->maxFramesAhead;
+	readback->slots = (Slot *) MEMORY_CALLOC(readback->slotCount, sizeof(Slot));
+	if (!readback->slots) {
+		MEMORY_FREE(readback);
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < readback->slotCount; ++i) {
+		// frame count starts at 0 so no slot matches until it is first used
+		readback->slots[i].frame = ~0ull;
+		readback->slots[i].requests = CADT_VectorCreate(sizeof(Request));
+		readback->slots[i].retired = CADT_VectorCreate(sizeof(TheForge_BufferHandle));
+	}
+	readback->generations = CADT_VectorCreate(sizeof(Generation));
+	return readback;
+}
+
+void RenderTF_ReadbackDestroy(Render_RendererHandle renderer, RenderTF_Readback *readback) {
+	if (!readback) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < readback->slotCount; ++i) {
+		Slot *slot = &readback->slots[i];
+		ReleaseRetired(renderer, slot);
+		if (slot->buffer) {
+			TheForge_RemoveBuffer(renderer->renderer, slot->buffer);
+		}
+		CADT_VectorDestroy(slot->retired);
+		CADT_VectorDestroy(slot->requests);
+	}
+	ReleaseGenerations(renderer, readback, true);
+	CADT_VectorDestroy(readback->generations);
+	MEMORY_FREE(readback->slots);
+	MEMORY_FREE(readback);
+}
+
+void RenderTF_ReadbackSubmitted(Render_RendererHandle renderer, TheForge_FenceHandle fence) {
+	RenderTF_Readback *readback = renderer->readback;
+	Slot *slot = &readback->slots[renderer->frameIndex % readback->slotCount];
+	if (slot->frame != renderer->frameCount) {
+		return;
+	}
+
+	auto requests = (Request *) CADT_VectorData(slot->requests);
+	bool any = false;
+	for (size_t i = 0; i < CADT_VectorSize(slot->requests); ++i) {
+		if (!requests[i].submitted) {
+			requests[i].submitted = true;
+			requests[i].fence = fence;
+			any = true;
+		}
+	}
+	if (any) {
+		slot->fence = fence;
+	}
+}
+
+AL2O3_EXTERN_C Render_ReadbackTicket Render_ReadbackRequestBuffer(Render_RendererHandle renderer,
+																																	Render_GraphicsEncoderHandle encoderHandle,
+																																	Render_BufferHandle bufferHandle,
+																																	uint64_t offset,
+																																	uint64_t size) {
+	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(encoderHandle);
+	Render_Buffer* buffer = Render_BufferHandleToPtr(bufferHandle);
+	ASSERT(offset + size <= buffer->size);
+
+	uint64_t srcOffset = offset;
+	if (buffer->frequentlyUpdated) {
+		srcOffset += (renderer->frameIndex * buffer->size);
+	}
+
+	Slot *slot = CurrentSlot(renderer);
+	uint64_t dstOffset;
+	if (!Alloc(renderer, slot, size, &dstOffset)) {
+		return Render_ReadbackTicket{~0ull, 0, 0};
+	}
+
+	// copies aren't allowed inside a render pass
+	Render_GraphicsEncoderBindRenderTargets(encoderHandle, 0, nullptr, false, false, false);
+	TheForge_CmdUpdateBuffer(encoder->cmd, slot->buffer, dstOffset, buffer->buffer, srcOffset, size);
+	return AddRequest(renderer, slot, dstOffset, size, 0, 0);
+}
+
+AL2O3_EXTERN_C Render_ReadbackTicket Render_ReadbackRequestTexture(Render_RendererHandle renderer,
+																																	 Render_GraphicsEncoderHandle encoderHandle,
+																																	 Render_TextureHandle textureHandle,
+																																	 Render_TextureSubresource subresource) {
+	Render_GraphicsEncoder* encoder = Render_GraphicsEncoderHandleToPtr(encoderHandle);
+	Render_Texture* texture = RenderTF_TextureAcquire(textureHandle);
+
+	TinyImageFormat const format = TheForge_TextureGetFormat(texture->texture);
+	uint32_t const width = MipDimension(TheForge_TextureGetWidth(texture->texture), subresource.mipLevel);
+	uint32_t const height = MipDimension(TheForge_TextureGetHeight(texture->texture), subresource.mipLevel);
+	uint32_t const depth = MipDimension(TheForge_TextureGetDepth(texture->texture), subresource.mipLevel);
+
+	uint32_t const blockWidth = TinyImageFormat_WidthOfBlock(format);
+	uint32_t const blockHeight = TinyImageFormat_HeightOfBlock(format);
+	uint32_t const blockBytes = TinyImageFormat_BitSizeOfBlock(format) / 8;
+	uint32_t const rowBytes = ((width + blockWidth - 1) / blockWidth) * blockBytes;
+	uint32_t const rowPitch = (rowBytes + RowPitchAlignment - 1) & ~(RowPitchAlignment - 1);
+	uint32_t const slicePitch = rowPitch * ((height + blockHeight - 1) / blockHeight);
+	uint64_t const size = (uint64_t) slicePitch * depth;
+
+	Slot *slot = CurrentSlot(renderer);
+	uint64_t dstOffset;
+	if (!Alloc(renderer, slot, size, &dstOffset)) {
+		return Render_ReadbackTicket{~0ull, 0, 0};
+	}
+
+	TheForge_SubresourceDataDesc desc{};
+	desc.bufferOffset = dstOffset;
+	desc.mipLevel = subresource.mipLevel;
+	desc.arrayLayer = subresource.slice;
+	desc.rowPitch = rowPitch;
+	desc.slicePitch = slicePitch;
+	// copies aren't allowed inside a render pass
+	Render_GraphicsEncoderBindRenderTargets(encoderHandle, 0, nullptr, false, false, false);
+	TheForge_CmdCopySubresource(encoder->cmd, slot->buffer, texture->texture, &desc);
+
+	return AddRequest(renderer, slot, dstOffset, size, rowPitch, slicePitch);
+}
+
+AL2O3_EXTERN_C Render_ReadbackStatus Render_ReadbackPoll(Render_RendererHandle renderer,
+																												 Render_ReadbackTicket ticket,
+																												 Render_ReadbackData *out) {
+	RenderTF_Readback *readback = renderer->readback;
+	if (ticket.slot >= readback->slotCount) {
+		return Render_RS_EXPIRED;
+	}
+	Slot *slot = &readback->slots[ticket.slot];
+	CADT_VectorHandle requests = slot->requests;
+	if (slot->frame != ticket.frame) {
+		Generation const *generation = FindGeneration(readback, ticket);
+		if (!generation) {
+			return Render_RS_EXPIRED;
+		}
+		requests = generation->requests;
+	}
+	if (ticket.index >= CADT_VectorSize(requests)) {
+		return Render_RS_EXPIRED;
+	}
+
+	Request const *request = ((Request const *) CADT_VectorData(requests)) + ticket.index;
+	if (!request->submitted || !IsComplete(renderer, request->fence)) {
+		return Render_RS_PENDING;
+	}
+	out->data = request->data;
+	out->size = request->size;
+	out->rowPitch = request->rowPitch;
+	out->slicePitch = request->slicePitch;
+	return Render_RS_READY;
+}
+
+Render_ReadbackStatus RenderTF_ReadbackHold(Render_RendererHandle renderer,
+																						Render_ReadbackTicket ticket,
+																						Render_ReadbackData *out) {
+	Render_ReadbackStatus const status = Render_ReadbackPoll(renderer, ticket, out);
+	if (status != Render_RS_READY) {
+		return status;
+	}
+	Slot *slot = &renderer->readback->slots[ticket.slot];
+	if (slot->frame == ticket.frame) {
+		slot->holds++;
+	} else {
+		FindGeneration(renderer->readback, ticket)->holds++;
+	}
+	return status;
+}
+
+void RenderTF_ReadbackRelease(Render_RendererHandle renderer, Render_ReadbackTicket ticket) {
+	RenderTF_Readback *readback = renderer->readback;
+	Slot *slot = &readback->slots[ticket.slot];
+	if (slot->frame == ticket.frame) {
+		ASSERT(slot->holds);
+		slot->holds--;
+		return;
+	}
+
+	// the slot moved on, a held frame is always kept as a generation
+	Generation *generation = FindGeneration(readback, ticket);
+	ASSERT(generation && generation->holds);
+	generation->holds--;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/readback.h"
+
+struct RenderTF_Readback *RenderTF_ReadbackCreate(Render_RendererHandle renderer);
+void RenderTF_ReadbackDestroy(Render_RendererHandle renderer, struct RenderTF_Readback *readback);
+
+// called for every graphics submit (frame buffer or Render_QueueSubmit), requests
+// recorded since the last submit complete with fence
+void RenderTF_ReadbackSubmitted(Render_RendererHandle renderer, TheForge_FenceHandle fence);
+
+// Poll that also keeps the data valid past the slots reuse until it is released, so it can
+// be read off the render thread. Both are render thread only
+Render_ReadbackStatus RenderTF_ReadbackHold(Render_RendererHandle renderer,
+																						Render_ReadbackTicket ticket,
+																						Render_ReadbackData *out);
+void RenderTF_ReadbackRelease(Render_RendererHandle renderer, Render_ReadbackTicket ticket);
@@ -0,0 +1,479 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/thread.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+
+#include "render_basics/theforge/api.h"
+#include "recorder.hpp"
+#include "readback.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// enough for the worker to write one frame while the next is handed over
+uint32_t const StagingCount = 2;
+uint64_t const FramesAlignment = 64;
+size_t const MaxPathLength = 1024;
+
+struct PendingFrame {
+	Render_ReadbackTicket ticket;
+	uint64_t frame;
+	uint64_t timeMs;
+	uint32_t width;
+	uint32_t height;
+	bool valid;
+};
+
+// a held readback, read by the worker while full. The render thread releases it
+// once the worker is done, the worker never touches the readback ring
+struct StagingFrame {
+	Render_ReadbackTicket ticket;
+	uint8_t const *data;
+	uint32_t rowPitch;
+	bool held;
+	uint64_t frame;
+	uint64_t timeMs;
+	uint32_t width;
+	uint32_t height;
+	bool full;
+};
+
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+struct MappedFile {
+	HANDLE file;
+	HANDLE mapping;
+	uint8_t *base;
+	uint64_t size;
+};
+
+bool MapFile(MappedFile *mf, char const *path, uint64_t size) {
+	mf->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (mf->file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	mf->mapping = CreateFileMappingA(mf->file, nullptr, PAGE_READWRITE, (DWORD) (size >> 32), (DWORD) size, nullptr);
+	if (!mf->mapping) {
+		CloseHandle(mf->file);
+		return false;
+	}
+	mf->base = (uint8_t *) MapViewOfFile(mf->mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T) size);
+	if (!mf->base) {
+		CloseHandle(mf->mapping);
+		CloseHandle(mf->file);
+		return false;
+	}
+	mf->size = size;
+	return true;
+}
+
+void UnmapFile(MappedFile *mf) {
+	FlushViewOfFile(mf->base, 0);
+	UnmapViewOfFile(mf->base);
+	CloseHandle(mf->mapping);
+	CloseHandle(mf->file);
+}
+#else
+struct MappedFile {
+	int fd;
+	uint8_t *base;
+	uint64_t size;
+};
+
+bool MapFile(MappedFile *mf, char const *path, uint64_t size) {
+	mf->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (mf->fd < 0) {
+		return false;
+	}
+	if (ftruncate(mf->fd, (off_t) size) != 0) {
+		close(mf->fd);
+		return false;
+	}
+	void *base = mmap(nullptr, (size_t) size, PROT_READ | PROT_WRITE, MAP_SHARED, mf->fd, 0);
+	if (base == MAP_FAILED) {
+		close(mf->fd);
+		return false;
+	}
+	mf->base = (uint8_t *) base;
+	mf->size = size;
+	return true;
+}
+
+void UnmapFile(MappedFile *mf) {
+	msync(mf->base, (size_t) mf->size, MS_ASYNC);
+	munmap(mf->base, (size_t) mf->size);
+	close(mf->fd);
+}
+#endif
+
+uint64_t AlignUp(uint64_t v, uint64_t alignment) {
+	return (v + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t WallClockMs() {
+	using namespace std::chrono;
+	return (uint64_t) duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // end anon namespace
+
+struct RenderTF_Recorder {
+	Render_RendererHandle renderer;
+	TinyImageFormat format;
+	uint32_t bytesPerPixel;
+	uint32_t frameInterval;
+	uint32_t downscale;
+
+	MappedFile file;
+
+	// render thread only
+	uint32_t frameSlotCount;
+	PendingFrame *pending;
+
+	Thread_Thread thread;
+	Thread_Mutex mutex;
+	Thread_ConditionalVariable workAvailable;
+
+	// protected by mutex
+	StagingFrame staging[StagingCount];
+	char dumpPath[MaxPathLength];
+	bool dumpRequested;
+	bool quit;
+	uint64_t droppedFrames;
+};
+
+namespace {
+
+Render_FrameBufferRecorderFileHeader *Header(RenderTF_Recorder *recorder) {
+	return (Render_FrameBufferRecorderFileHeader *) recorder->file.base;
+}
+
+Render_FrameBufferRecorderIndexEntry *Index(RenderTF_Recorder *recorder) {
+	return (Render_FrameBufferRecorderIndexEntry *) (recorder->file.base + sizeof(Render_FrameBufferRecorderFileHeader));
+}
+
+// (re)starts the ring for frames of this size
+void Layout(RenderTF_Recorder *recorder, uint32_t width, uint32_t height) {
+	Render_FrameBufferRecorderFileHeader *header = Header(recorder);
+	uint64_t const frameSize = (uint64_t) width * height * recorder->bytesPerPixel;
+	uint64_t const available = recorder->file.size - sizeof(Render_FrameBufferRecorderFileHeader) - FramesAlignment;
+	uint64_t const slotCount = available / (sizeof(Render_FrameBufferRecorderIndexEntry) + frameSize);
+
+	header->magic = RENDER_FRAMEBUFFER_RECORDER_MAGIC;
+	header->version = RENDER_FRAMEBUFFER_RECORDER_VERSION;
+	header->formatCode = TinyImageFormat_Code(recorder->format);
+	header->width = width;
+	header->height = height;
+	header->slotCount = (uint32_t) slotCount;
+	header->padding = 0;
+	header->frameSize = frameSize;
+	header->framesOffset = AlignUp(sizeof(Render_FrameBufferRecorderFileHeader) +
+																		 slotCount * sizeof(Render_FrameBufferRecorderIndexEntry), FramesAlignment);
+	header->writeCount = 0;
+
+	if (slotCount == 0) {
+		LOGWARNING("Frame recorder file of %llu bytes can't hold a %ux%u frame",
+							 (unsigned long long) recorder->file.size, width, height);
+	}
+}
+
+void WriteFrame(RenderTF_Recorder *recorder, StagingFrame const *frame) {
+	uint32_t const width = frame->width / recorder->downscale ? frame->width / recorder->downscale : 1;
+	uint32_t const height = frame->height / recorder->downscale ? frame->height / recorder->downscale : 1;
+
+	Render_FrameBufferRecorderFileHeader *header = Header(recorder);
+	if (header->width != width || header->height != height) {
+		Layout(recorder, width, height);
+	}
+	if (header->slotCount == 0) {
+		return;
+	}
+
+	uint64_t const slot = header->writeCount % header->slotCount;
+	uint8_t *dst = recorder->file.base + header->framesOffset + slot * header->frameSize;
+	uint32_t const bpp = recorder->bytesPerPixel;
+	uint64_t const rowBytes = (uint64_t) width * bpp;
+
+	for (uint32_t y = 0; y < height; ++y) {
+		uint8_t const *src = frame->data + (uint64_t) y * recorder->downscale * frame->rowPitch;
+		if (recorder->downscale == 1) {
+			memcpy(dst, src, rowBytes);
+			dst += rowBytes;
+			continue;
+		}
+		for (uint32_t x = 0; x < width; ++x) {
+			memcpy(dst, src + (uint64_t) x * recorder->downscale * bpp, bpp);
+			dst += bpp;
+		}
+	}
+
+	// a reader trusts writeCount, so it moves on only once the slot is complete
+	Index(recorder)[slot] = Render_FrameBufferRecorderIndexEntry{frame->frame, frame->timeMs};
+	header->writeCount++;
+}
+
+// the frames oldest first, only the worker writes the ring so it can't change under us
+void WriteDump(RenderTF_Recorder *recorder, char const *path) {
+	Render_FrameBufferRecorderFileHeader const *ring = Header(recorder);
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		LOGERROR("Frame recorder couldn't open %s for the dump", path);
+		return;
+	}
+
+	uint64_t const count = ring->writeCount < ring->slotCount ? ring->writeCount : ring->slotCount;
+	Render_FrameBufferRecorderFileHeader header = *ring;
+	header.slotCount = (uint32_t) count;
+	header.writeCount = count;
+	header.framesOffset = AlignUp(sizeof(Render_FrameBufferRecorderFileHeader) +
+																	count * sizeof(Render_FrameBufferRecorderIndexEntry), FramesAlignment);
+	fwrite(&header, sizeof(header), 1, file);
+
+	uint64_t const oldest = ring->writeCount - count;
+	for (uint64_t i = 0; i < count; ++i) {
+		fwrite(&Index(recorder)[(oldest + i) % ring->slotCount], sizeof(Render_FrameBufferRecorderIndexEntry), 1, file);
+	}
+	uint8_t const zeros[FramesAlignment] = {};
+	uint64_t const written = sizeof(header) + count * sizeof(Render_FrameBufferRecorderIndexEntry);
+	fwrite(zeros, 1, (size_t) (header.framesOffset - written), file);
+
+	for (uint64_t i = 0; i < count; ++i) {
+		uint64_t const slot = (oldest + i) % ring->slotCount;
+		fwrite(recorder->file.base + ring->framesOffset + slot * ring->frameSize, 1, (size_t) ring->frameSize, file);
+	}
+	fclose(file);
+}
+
+StagingFrame *OldestFull(RenderTF_Recorder *recorder) {
+	StagingFrame *oldest = nullptr;
+	for (uint32_t i = 0; i < StagingCount; ++i) {
+		StagingFrame *staging = &recorder->staging[i];
+		if (staging->full && (!oldest || staging->frame < oldest->frame)) {
+			oldest = staging;
+		}
+	}
+	return oldest;
+}
+
+void RecorderWorker(void *data) {
+	auto recorder = (RenderTF_Recorder *) data;
+	char dumpPath[MaxPathLength];
+
+	while (true) {
+		Thread_MutexAcquire(&recorder->mutex);
+		while (!recorder->quit && !recorder->dumpRequested && !OldestFull(recorder)) {
+			Thread_CondVarWait(&recorder->workAvailable, &recorder->mutex, ~0ull);
+		}
+		if (recorder->quit) {
+			Thread_MutexRelease(&recorder->mutex);
+			return;
+		}
+		StagingFrame *frame = OldestFull(recorder);
+		bool const dump = recorder->dumpRequested;
+		if (dump) {
+			memcpy(dumpPath, recorder->dumpPath, MaxPathLength);
+		}
+		Thread_MutexRelease(&recorder->mutex);
+
+		if (frame) {
+			WriteFrame(recorder, frame);
+		}
+		if (dump) {
+			WriteDump(recorder, dumpPath);
+		}
+
+		Thread_MutexAcquire(&recorder->mutex);
+		if (frame) {
+			frame->full = false;
+		}
+		if (dump) {
+			recorder->dumpRequested = false;
+		}
+		Thread_MutexRelease(&recorder->mutex);
+	}
+}
+
+// readbacks the worker has written go back to the readback ring
+void ReleaseWritten(RenderTF_Recorder *recorder) {
+	Thread_MutexAcquire(&recorder->mutex);
+	for (uint32_t i = 0; i < StagingCount; ++i) {
+		StagingFrame *staging = &recorder->staging[i];
+		if (staging->held && !staging->full) {
+			RenderTF_ReadbackRelease(recorder->renderer, staging->ticket);
+			staging->held = false;
+		}
+	}
+	Thread_MutexRelease(&recorder->mutex);
+}
+
+// the render thread fills staging frames the worker isn't holding
+StagingFrame *AcquireStaging(RenderTF_Recorder *recorder) {
+	Thread_MutexAcquire(&recorder->mutex);
+	StagingFrame *staging = nullptr;
+	for (uint32_t i = 0; i < StagingCount; ++i) {
+		if (!recorder->staging[i].full && !recorder->staging[i].held) {
+			staging = &recorder->staging[i];
+			break;
+		}
+	}
+	if (!staging) {
+		recorder->droppedFrames++;
+	}
+	Thread_MutexRelease(&recorder->mutex);
+	return staging;
+}
+
+} // end anon namespace
+
+RenderTF_Recorder *RenderTF_RecorderCreate(Render_RendererHandle renderer,
+																					 TinyImageFormat format,
+																					 uint32_t frameSlotCount,
+																					 Render_FrameBufferRecorderDesc const *desc) {
+	if (!desc->path || desc->fileSize <= sizeof(Render_FrameBufferRecorderFileHeader) + FramesAlignment) {
+		LOGERROR("Frame recorder needs a path and a file big enough for at least one frame");
+		return nullptr;
+	}
+
+	auto recorder = (RenderTF_Recorder *) MEMORY_CALLOC(1, sizeof(RenderTF_Recorder));
+	if (!recorder) {
+		return nullptr;
+	}
+	recorder->renderer = renderer;
+	recorder->format = format;
+	recorder->bytesPerPixel = TinyImageFormat_BitSizeOfBlock(format) / 8;
+	recorder->frameInterval = desc->frameInterval ? desc->frameInterval : 1;
+	recorder->downscale = desc->downscale ? desc->downscale : 1;
+	recorder->frameSlotCount = frameSlotCount;
+
+	if (!MapFile(&recorder->file, desc->path, desc->fileSize)) {
+		LOGERROR("Frame recorder couldn't map %s", desc->path);
+		MEMORY_FREE(recorder);
+		return nullptr;
+	}
+	// nothing recorded yet, the first frame lays the ring out
+	memset(Header(recorder), 0, sizeof(Render_FrameBufferRecorderFileHeader));
+
+	recorder->pending = (PendingFrame *) MEMORY_CALLOC(frameSlotCount, sizeof(PendingFrame));
+
+	Thread_MutexCreate(&recorder->mutex);
+	Thread_CondVarCreate(&recorder->workAvailable);
+	if (!Thread_ThreadCreate(&recorder->thread, &RecorderWorker, recorder)) {
+		LOGERROR("Frame recorder worker thread creation failed");
+		Thread_CondVarDestroy(&recorder->workAvailable);
+		Thread_MutexDestroy(&recorder->mutex);
+		MEMORY_FREE(recorder->pending);
+		UnmapFile(&recorder->file);
+		MEMORY_FREE(recorder);
+		return nullptr;
+	}
+	return recorder;
+}
+
+void RenderTF_RecorderDestroy(RenderTF_Recorder *recorder) {
+	if (!recorder) {
+		return;
+	}
+
+	Thread_MutexAcquire(&recorder->mutex);
+	recorder->quit = true;
+	Thread_CondVarWakeAll(&recorder->workAvailable);
+	Thread_MutexRelease(&recorder->mutex);
+
+	Thread_ThreadJoin(&recorder->thread);
+	Thread_ThreadDestroy(&recorder->thread);
+	Thread_CondVarDestroy(&recorder->workAvailable);
+	Thread_MutexDestroy(&recorder->mutex);
+
+	if (recorder->droppedFrames) {
+		LOGINFO("Frame recorder dropped %llu frames", (unsigned long long) recorder->droppedFrames);
+	}
+
+	// the worker has gone, anything it was given is finished with
+	for (uint32_t i = 0; i < StagingCount; ++i) {
+		if (recorder->staging[i].held) {
+			RenderTF_ReadbackRelease(recorder->renderer, recorder->staging[i].ticket);
+		}
+	}
+	MEMORY_FREE(recorder->pending);
+	UnmapFile(&recorder->file);
+	MEMORY_FREE(recorder);
+}
+
+bool RenderTF_RecorderWantsFrame(RenderTF_Recorder const *recorder, uint64_t frame) {
+	return (frame % recorder->frameInterval) == 0;
+}
+
+void RenderTF_RecorderRequested(RenderTF_Recorder *recorder,
+																uint32_t frameSlot,
+																uint64_t frame,
+																Render_ReadbackTicket ticket,
+																uint32_t width,
+																uint32_t height) {
+	recorder->pending[frameSlot] = PendingFrame{ticket, frame, WallClockMs(), width, height, true};
+}
+
+void RenderTF_RecorderCollect(RenderTF_Recorder *recorder) {
+	ReleaseWritten(recorder);
+
+	for (uint32_t i = 0; i < recorder->frameSlotCount; ++i) {
+		PendingFrame &pending = recorder->pending[i];
+		if (!pending.valid) {
+			continue;
+		}
+		Render_ReadbackData data;
+		Render_ReadbackStatus const status = Render_ReadbackPoll(recorder->renderer, pending.ticket, &data);
+		if (status == Render_RS_PENDING) {
+			continue;
+		}
+		pending.valid = false;
+		if (status != Render_RS_READY) {
+			continue;
+		}
+
+		StagingFrame *staging = AcquireStaging(recorder);
+		if (!staging) {
+			continue;
+		}
+
+		// the worker reads (and downscales) straight out of the readback buffer
+		RenderTF_ReadbackHold(recorder->renderer, pending.ticket, &data);
+
+		Thread_MutexAcquire(&recorder->mutex);
+		staging->ticket = pending.ticket;
+		staging->data = (uint8_t const *) data.data;
+		staging->rowPitch = data.rowPitch;
+		staging->held = true;
+		staging->frame = pending.frame;
+		staging->timeMs = pending.timeMs;
+		staging->width = pending.width;
+		staging->height = pending.height;
+		staging->full = true;
+		Thread_CondVarWakeAll(&recorder->workAvailable);
+		Thread_MutexRelease(&recorder->mutex);
+	}
+}
+
+bool RenderTF_RecorderDump(RenderTF_Recorder *recorder, char const *path) {
+	if (strlen(path) >= MaxPathLength) {
+		LOGERROR("Frame recorder dump path is too long");
+		return false;
+	}
+	Thread_MutexAcquire(&recorder->mutex);
+	bool const queued = !recorder->dumpRequested;
+	if (queued) {
+		strcpy(recorder->dumpPath, path);
+		recorder->dumpRequested = true;
+		Thread_CondVarWakeAll(&recorder->workAvailable);
+	}
+	Thread_MutexRelease(&recorder->mutex);
+	return queued;
+}
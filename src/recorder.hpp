@@ -0,0 +1,26 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/readback.h"
+#include "render_basics/theforge/recorder.h"
+
+struct RenderTF_Recorder *RenderTF_RecorderCreate(Render_RendererHandle renderer,
+																									TinyImageFormat format,
+																									uint32_t frameSlotCount,
+																									Render_FrameBufferRecorderDesc const *desc);
+// joins the worker, unwritten frames are dropped
+void RenderTF_RecorderDestroy(struct RenderTF_Recorder *recorder);
+
+bool RenderTF_RecorderWantsFrame(struct RenderTF_Recorder const *recorder, uint64_t frame);
+// a readback of the frame was recorded in frame slot
+void RenderTF_RecorderRequested(struct RenderTF_Recorder *recorder,
+																uint32_t frameSlot,
+																uint64_t frame,
+																Render_ReadbackTicket ticket,
+																uint32_t width,
+																uint32_t height);
+// hands finished readbacks to the worker without copying them, never blocks
+void RenderTF_RecorderCollect(struct RenderTF_Recorder *recorder);
+
+bool RenderTF_RecorderDump(struct RenderTF_Recorder *recorder, char const *path);
@@ -6,23 +6,49 @@
 #include "render_basics/api.h"
 #include "render_basics/rootsignature.h"
 #include "render_basics/theforge/handlemanager.h"
+#include "pipelinecache.hpp"
+#include "shader.hpp"
+#include "hash.hpp"
 
 AL2O3_EXTERN_C Render_RootSignatureHandle Render_RootSignatureCreate(Render_RendererHandle renderer,
 																																		 Render_RootSignatureDesc const *desc) {
+	uint64_t hash = RenderTF_HashSeed;
+	Render_ShaderReflection reflection{};
+
 	TheForge_ShaderHandle* shaders = (TheForge_ShaderHandle*)STACK_ALLOC(sizeof(TheForge_ShaderHandle*) * desc->shaderCount);
 	for(uint32_t i = 0;i < desc->shaderCount;++i) {
 		if(!Render_ShaderHandleIsValid(desc->shaders[i])) {
 			return {0};
 		}
 
-		shaders[i] = Render_ShaderHandleToPtr(desc->shaders[i])->shader;
+		Render_Shader* shader = Render_ShaderHandleToPtr(desc->shaders[i]);
+		shaders[i] = shader->shader;
+		hash = RenderTF_HashU64(shader->hash, hash);
+		if (!RenderTF_ShaderReflectionMerge(&reflection, &shader->reflection, "Root signature")) {
+			return {0};
+		}
 	}
+	reflection.vertexInputCount = 0;
+
 	TheForge_SamplerHandle* samplers = (TheForge_SamplerHandle*) STACK_ALLOC(sizeof(TheForge_SamplerHandle) * desc->staticSamplerCount);
 	for(uint32_t i = 0; i < desc->staticSamplerCount;++i) {
 		if(!Render_SamplerHandleIsValid(desc->staticSamplers[i])) {
 			return {0};
 		}
 		samplers[i] = Render_SamplerHandleToPtr(desc->staticSamplers[i])->sampler;
+		hash = RenderTF_HashU64(Render_SamplerHandleToPtr(desc->staticSamplers[i])->hash, hash);
+		hash = RenderTF_HashString(desc->staticSamplerNames[i], hash);
+
+		bool found = false;
+		for (uint32_t j = 0; j < reflection.bindingCount; ++j) {
+			if (strcmp(reflection.bindings[j].name, desc->staticSamplerNames[i]) == 0) {
+				found = reflection.bindings[j].type == Render_SBT_SAMPLER;
+				break;
+			}
+		}
+		if (!found) {
+			LOGWARNING("Static sampler %s isn't a sampler used by the root signatures shaders", desc->staticSamplerNames[i]);
+		}
 	}
 	TheForge_RootSignatureDesc rootSignatureDesc{};
 	rootSignatureDesc.shaderCount = desc->shaderCount;
@@ -38,6 +64,16 @@ AL2O3_EXTERN_C Render_RootSignatureHandle Render_RootSignatureCreate(Render_Rend
 		Render_RootSignatureHandleRelease(handle);
 		return {0};
 	}
+	rootSig->hash = hash;
+
+	// resolve names once here so descriptor updates don't do string lookups
+	rootSig->reflection = reflection;
+	for (uint32_t i = 0; i < reflection.bindingCount; ++i) {
+		rootSig->descriptorIndices[i] = TheForge_GetDescriptorIndexFromName(rootSig->signature,
+																																				reflection.bindings[i].name);
+	}
+
+	RenderTF_PipelineCacheRegister(renderer, RenderTF_RT_ROOTSIGNATURE, rootSig->hash, handle.handle);
 
 	return handle;
 }
@@ -49,8 +85,23 @@ AL2O3_EXTERN_C void Render_RootSignatureDestroy(Render_RendererHandle renderer,
 	}
 
 	Render_RootSignature* rootSig = Render_RootSignatureHandleToPtr(handle);
+	RenderTF_PipelineCacheUnregister(renderer, RenderTF_RT_ROOTSIGNATURE, rootSig->hash, handle.handle);
 	TheForge_RemoveRootSignature(renderer->renderer, rootSig->signature);
 	Render_RootSignatureHandleRelease(handle);
 
 }
 
+
+AL2O3_EXTERN_C uint32_t Render_RootSignatureGetDescriptorIndex(Render_RootSignatureHandle handle, char const *name) {
+	if (!Render_RootSignatureHandleIsValid(handle)) {
+		return ~0u;
+	}
+
+	Render_RootSignature* rootSig = Render_RootSignatureHandleToPtr(handle);
+	for (uint32_t i = 0; i < rootSig->reflection.bindingCount; ++i) {
+		if (strcmp(rootSig->reflection.bindings[i].name, name) == 0) {
+			return rootSig->descriptorIndices[i];
+		}
+	}
+	return ~0u;
+}
@@ -1,13 +1,60 @@
 #include "al2o3_platform/platform.h"
 #include "al2o3_memory/memory.h"
+#include "al2o3_vfile/vfile.h"
+#include "al2o3_thread/thread.hpp"
 
 #include "render_basics/theforge/api.h"
 #include "render_basics/api.h"
 #include "render_basics/shader.h"
 #include "render_basics/theforge/handlemanager.h"
+#include "pipelinecache.hpp"
+#include "shader.hpp"
+#include "embeddedshaders.hpp"
+#include "hash.hpp"
 
-AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderObjectCreate(Render_RendererHandle renderer,
-																																	 Render_ShaderObjectDesc const *desc) {
+static void shaderStage(decltype(Render_ShaderObjectDesc::shaderType) type,
+												ShaderCompiler_ShaderType *scType,
+												TheForge_ShaderStage *stage) {
+	switch (type) {
+		case Render_ST_VERTEXSHADER: *scType = ShaderCompiler_ST_VertexShader;
+			*stage = TheForge_SS_VERT;
+			break;
+		case Render_ST_FRAGMENTSHADER: *scType = ShaderCompiler_ST_FragmentShader;
+			*stage = TheForge_SS_FRAG;
+			break;
+		case Render_ST_COMPUTESHADER: *scType = ShaderCompiler_ST_ComputeShader;
+			*stage = TheForge_SS_COMP;
+			break;
+		case Render_ST_GEOMETRYSHADER: *scType = ShaderCompiler_ST_GeometryShader;
+			*stage = TheForge_SS_GEOM;
+			break;
+		case Render_ST_TESSCONTROLSHADER: *scType = ShaderCompiler_ST_TessControlShader;
+			*stage = TheForge_SS_TESE;
+			break;
+		case Render_ST_TESSEVALUATIONSHADER: *scType = ShaderCompiler_ST_TessEvaluationShader;
+			*stage = TheForge_SS_TESC;
+			break;
+			/*		case Render_ST_TASKSHADER:
+						*scType = ShaderCompiler_ST_TaskShader;
+						*stage = TheForge_SS_TASK;
+						break;
+					case Render_ST_MESHSHADER:
+						*scType = ShaderCompiler_ST_MeshShader;
+						*stage = TheForge_SS_MESH;
+						break;
+					*/
+	}
+}
+
+static uint64_t objectHash(Render_ShaderObject const *shaderObject) {
+	uint64_t hash = RenderTF_Hash(shaderObject->output.shader, shaderObject->output.shaderSize);
+	hash = RenderTF_HashString(shaderObject->entryPoint, hash);
+	return RenderTF_HashU64(shaderObject->shaderType, hash);
+}
+
+Render_ShaderObjectHandle RenderTF_ShaderObjectCreate(Render_RendererHandle renderer,
+																											 Render_ShaderObjectDesc const *desc,
+																											 char const *name) {
 
 	Render_ShaderObjectHandle handle = Render_ShaderObjectHandleAlloc();
 
@@ -18,47 +65,24 @@ AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderObjectCreate(Render_Render
 
 	strncpy(shaderObject->entryPoint, desc->entryPoint, 63);
 	shaderObject->entryPoint[63] = 0;
-	strncpy(shaderObject->name, VFile_GetName(desc->file), 63);
+	strncpy(shaderObject->name, name, 63);
 	shaderObject->name[63] = 0;
 
 	ShaderCompiler_ShaderType scType = ShaderCompiler_ST_VertexShader;
-	switch (desc->shaderType) {
-		case Render_ST_VERTEXSHADER: scType = ShaderCompiler_ST_VertexShader;
-			shaderObject->shaderType = TheForge_SS_VERT;
-			break;
-		case Render_ST_FRAGMENTSHADER: scType = ShaderCompiler_ST_FragmentShader;
-			shaderObject->shaderType = TheForge_SS_FRAG;
-			break;
-		case Render_ST_COMPUTESHADER: scType = ShaderCompiler_ST_ComputeShader;
-			shaderObject->shaderType = TheForge_SS_COMP;
-			break;
-		case Render_ST_GEOMETRYSHADER: scType = ShaderCompiler_ST_GeometryShader;
-			shaderObject->shaderType = TheForge_SS_GEOM;
-			break;
-		case Render_ST_TESSCONTROLSHADER: scType = ShaderCompiler_ST_TessControlShader;
-			shaderObject->shaderType = TheForge_SS_TESE;
-			break;
-		case Render_ST_TESSEVALUATIONSHADER: scType = ShaderCompiler_ST_TessEvaluationShader;
-			shaderObject->shaderType = TheForge_SS_TESC;
-			break;
-			/*		case Render_ST_TASKSHADER:
-						scType = ShaderCompiler_ST_TaskShader;
-						shaderObject->shaderType = TheForge_SS_TASK;
-						break;
-					case Render_ST_MESHSHADER:
-						scType = ShaderCompiler_ST_MeshShader;
-						shaderObject->shaderType = TheForge_SS_MESH;
-						break;
-					*/
-	}
+	shaderStage(desc->shaderType, &scType, &shaderObject->shaderType);
 
-	bool vokay = ShaderCompiler_Compile(
-			renderer->shaderCompiler,
-			scType,
-			VFile_GetName(desc->file),
-			desc->entryPoint,
-			desc->file,
-			&shaderObject->output);
+	// permutations are compiled on whichever thread asks for them first
+	bool vokay;
+	{
+		Thread::MutexLock lock(&renderer->shaderCompilerMutex);
+		vokay = ShaderCompiler_Compile(
+				renderer->shaderCompiler,
+				scType,
+				shaderObject->name,
+				desc->entryPoint,
+				desc->file,
+				&shaderObject->output);
+	}
 
 	if (shaderObject->output.log != nullptr) {
 		LOGWARNING("Shader compiler : %s %s", vokay ? "warnings" : "ERROR", shaderObject->output.log);
@@ -70,8 +94,15 @@ AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderObjectCreate(Render_Render
 		return {0};
 	}
 
+	shaderObject->hash = objectHash(shaderObject);
+
 	return handle;
 }
+
+AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderObjectCreate(Render_RendererHandle renderer,
+																																	 Render_ShaderObjectDesc const *desc) {
+	return RenderTF_ShaderObjectCreate(renderer, desc, VFile_GetName(desc->file));
+}
 AL2O3_EXTERN_C Render_ShaderHandle Render_ShaderCreate(Render_RendererHandle renderer,
 																											 uint32_t count,
 																											 Render_ShaderObjectHandle *shaderObjects) {
@@ -80,9 +111,11 @@ AL2O3_EXTERN_C Render_ShaderHandle Render_ShaderCreate(Render_RendererHandle ren
 #else
 	TheForge_BinaryShaderDesc sdesc{};
 #endif
+	uint64_t hash = RenderTF_HashSeed;
 	for (uint32_t i = 0; i < count; ++i) {
 		Render_ShaderObject *shaderObject = Render_ShaderObjectHandleToPtr(shaderObjects[i]);
 		sdesc.stages = (TheForge_ShaderStage) (sdesc.stages | shaderObject->shaderType);
+		hash = RenderTF_HashU64(shaderObject->hash, hash);
 
 #if AL2O3_PLATFORM == AL2O3_PLATFORM_APPLE_MAC
 		TheForge_ShaderStageDesc ssdesc {};
@@ -124,6 +157,15 @@ AL2O3_EXTERN_C Render_ShaderHandle Render_ShaderCreate(Render_RendererHandle ren
 #else
 	TheForge_AddShaderBinary(renderer->renderer, &sdesc, &shader->shader);
 #endif
+	if (!shader->shader) {
+		Render_ShaderHandleRelease(shaderHandle);
+		return {0};
+	}
+	if (!RenderTF_ShaderReflect(shader->shader, &shader->reflection)) {
+		LOGWARNING("No reflection for shader, bindings and vertex layouts won't be validated");
+	}
+	shader->hash = hash;
+	RenderTF_PipelineCacheRegister(renderer, RenderTF_RT_SHADER, shader->hash, shaderHandle.handle);
 
 	return shaderHandle;
 }
@@ -145,6 +187,7 @@ AL2O3_EXTERN_C void Render_ShaderDestroy(Render_RendererHandle renderer, Render_
 
 	Render_Shader *shader = Render_ShaderHandleToPtr(handle);
 
+	RenderTF_PipelineCacheUnregister(renderer, RenderTF_RT_SHADER, shader->hash, handle.handle);
 	TheForge_RemoveShader(renderer->renderer, shader->shader);
 	Render_ShaderHandleRelease(handle);
 
@@ -188,4 +231,100 @@ AL2O3_EXTERN_C Render_ShaderHandle Render_CreateShaderFromVFile(Render_RendererH
 	Render_ShaderObjectDestroy(renderer, shaderObjects[1]);
 
 	return shader;
-}
\ No newline at end of file
+}
+
+Render_ShaderObjectHandle RenderTF_ShaderObjectCreateEmbedded(Render_RendererHandle renderer, char const *name) {
+	RenderTF_EmbeddedShader const *embedded = nullptr;
+	for (uint32_t i = 0; i < RenderTF_EmbeddedShaderCount; ++i) {
+		if (RenderTF_EmbeddedShaders[i].name && strcmp(RenderTF_EmbeddedShaders[i].name, name) == 0) {
+			embedded = &RenderTF_EmbeddedShaders[i];
+			break;
+		}
+	}
+	if (!embedded) {
+		LOGERROR("No embedded shader called %s", name);
+		return {0};
+	}
+
+	// the backend picks the binary not the platform, windows can run vulkan. Apple goes
+	// through the source path so only uses the source, as does a missing binary
+	uint8_t const *binary = nullptr;
+	size_t binarySize = 0;
+#if AL2O3_PLATFORM != AL2O3_PLATFORM_APPLE_MAC
+	if (TheForge_GetRendererApi(renderer->renderer) == TheForge_API_VULKAN) {
+		binary = embedded->spirv;
+		binarySize = embedded->spirvSize;
+	}
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+	else {
+		binary = embedded->dxil;
+		binarySize = embedded->dxilSize;
+	}
+#endif
+#endif
+
+	if (!binary) {
+		VFile_Handle file = VFile_FromMemory(embedded->source, embedded->sourceSize, false);
+		if (!file) {
+			return {0};
+		}
+		Render_ShaderObjectDesc desc{};
+		desc.shaderType = embedded->shaderType;
+		desc.file = file;
+		desc.entryPoint = embedded->entryPoint;
+		Render_ShaderObjectHandle handle = RenderTF_ShaderObjectCreate(renderer, &desc, embedded->name);
+		VFile_Close(file);
+		return handle;
+	}
+
+	Render_ShaderObjectHandle handle = Render_ShaderObjectHandleAlloc();
+	Render_ShaderObject *shaderObject = Render_ShaderObjectHandleToPtr(handle);
+	if (!shaderObject) {
+		return {0};
+	}
+
+	strncpy(shaderObject->entryPoint, embedded->entryPoint, 63);
+	shaderObject->entryPoint[63] = 0;
+	strncpy(shaderObject->name, embedded->name, 63);
+	shaderObject->name[63] = 0;
+
+	ShaderCompiler_ShaderType scType = ShaderCompiler_ST_VertexShader;
+	shaderStage(embedded->shaderType, &scType, &shaderObject->shaderType);
+
+	// objects own their output, copy so destroy doesn't need to know where it came from
+	void *shader = MEMORY_MALLOC(binarySize);
+	if (!shader) {
+		Render_ShaderObjectHandleRelease(handle);
+		return {0};
+	}
+	memcpy(shader, binary, binarySize);
+	shaderObject->output = {};
+	shaderObject->output.shader = shader;
+	shaderObject->output.shaderSize = binarySize;
+
+	shaderObject->hash = objectHash(shaderObject);
+
+	return handle;
+}
+
+Render_ShaderHandle RenderTF_ShaderCreateEmbedded(Render_RendererHandle renderer,
+																									char const *vertexName,
+																									char const *fragmentName) {
+	Render_ShaderObjectHandle shaderObjects[2]{};
+	shaderObjects[0] = RenderTF_ShaderObjectCreateEmbedded(renderer, vertexName);
+	shaderObjects[1] = RenderTF_ShaderObjectCreateEmbedded(renderer, fragmentName);
+
+	if (!Render_ShaderObjectHandleIsValid(shaderObjects[0]) ||
+			!Render_ShaderObjectHandleIsValid(shaderObjects[1])) {
+		Render_ShaderObjectDestroy(renderer, shaderObjects[0]);
+		Render_ShaderObjectDestroy(renderer, shaderObjects[1]);
+		return {0};
+	}
+
+	Render_ShaderHandle shader = Render_ShaderCreate(renderer, 2, shaderObjects);
+
+	Render_ShaderObjectDestroy(renderer, shaderObjects[0]);
+	Render_ShaderObjectDestroy(renderer, shaderObjects[1]);
+
+	return shader;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/shader.h"
+
+// desc->file is compiled but name is used for the object (and compiler errors),
+// lets generated source (permutations) keep the name of the file it came from
+Render_ShaderObjectHandle RenderTF_ShaderObjectCreate(Render_RendererHandle renderer,
+																											 Render_ShaderObjectDesc const *desc,
+																											 char const *name);
+
+struct RenderTF_ShaderPermutationCache *RenderTF_ShaderPermutationCacheCreate();
+void RenderTF_ShaderPermutationCacheDestroy(Render_RendererHandle renderer, struct RenderTF_ShaderPermutationCache *cache);
+// lays the defines out in the sets 64 bit key, from bit 0 in declaration order. False
+// (and logs) if a define has no bits or more than 32 or they need more than 64 in total
+bool RenderTF_ShaderPermutationPackDefines(Render_ShaderPermutationSet *set,
+																					uint32_t defineCount,
+																					Render_ShaderPermutationDefine const *defines);
+
+// fills out from TheForge's reflection of the compiled shader, false if it has none
+bool RenderTF_ShaderReflect(TheForge_ShaderHandle shader, Render_ShaderReflection *out);
+// adds src's bindings and vertex inputs to dst, returns false (and logs using name) if
+// the same binding is declared differently or two bindings share a register
+bool RenderTF_ShaderReflectionMerge(Render_ShaderReflection *dst,
+																		Render_ShaderReflection const *src,
+																		char const *name);
@@ -0,0 +1,282 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_cadt/dictu64.h"
+#include "al2o3_thread/thread.hpp"
+#include "al2o3_vfile/vfile.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/theforge/shader.h"
+#include "render_basics/api.h"
+#include "shader.hpp"
+#include "hash.hpp"
+#include <stdio.h>
+
+static_assert(RENDER_SHADER_PERMUTATION_MAX_DEFINES ==
+									sizeof(Render_ShaderPermutationSet::defines) / sizeof(Render_ShaderPermutationSet::defines[0]),
+							"Render_ShaderPermutationSet defines array size mismatch");
+
+namespace {
+
+struct CacheEntry {
+	Render_ShaderObjectHandle object;
+	uint32_t refCount;
+};
+
+} // end anon namespace
+
+// renderer wide so sets built from the same source share permutations
+struct RenderTF_ShaderPermutationCache {
+	Thread_Mutex mutex;
+	CADT_VectorHandle entries;    // CacheEntry
+	CADT_VectorHandle freeEntries; // uint32_t index of an entry whose refCount is 0
+	CADT_DictU64Handle lookup;    // hash(source hash, entry point, type, key) -> entry index
+};
+
+RenderTF_ShaderPermutationCache *RenderTF_ShaderPermutationCacheCreate() {
+	auto cache = (RenderTF_ShaderPermutationCache *) MEMORY_CALLOC(1, sizeof(RenderTF_ShaderPermutationCache));
+	if (!cache) {
+		return nullptr;
+	}
+	Thread_MutexCreate(&cache->mutex);
+	cache->entries = CADT_VectorCreate(sizeof(CacheEntry));
+	cache->freeEntries = CADT_VectorCreate(sizeof(uint32_t));
+	cache->lookup = CADT_DictU64Create();
+	return cache;
+}
+
+void RenderTF_ShaderPermutationCacheDestroy(Render_RendererHandle renderer, RenderTF_ShaderPermutationCache *cache) {
+	if (!cache) {
+		return;
+	}
+
+	CacheEntry *entries = (CacheEntry *) CADT_VectorData(cache->entries);
+	for (size_t i = 0; i < CADT_VectorSize(cache->entries); ++i) {
+		if (entries[i].refCount != 0) {
+			LOGWARNING("Shader permutation set leaked, permutation %s still referenced",
+								 Render_ShaderObjectHandleToPtr(entries[i].object)->name);
+			Render_ShaderObjectDestroy(renderer, entries[i].object);
+		}
+	}
+
+	CADT_DictU64Destroy(cache->lookup);
+	CADT_VectorDestroy(cache->freeEntries);
+	CADT_VectorDestroy(cache->entries);
+	Thread_MutexDestroy(&cache->mutex);
+	MEMORY_FREE(cache);
+}
+
+static uint64_t CacheKey(Render_ShaderPermutationSet const *set, uint64_t key) {
+	uint64_t hash = RenderTF_HashU64(set->sourceHash);
+	hash = RenderTF_HashString(set->entryPoint, hash);
+	hash = RenderTF_HashU64((uint64_t) set->objectDesc.shaderType, hash);
+	return RenderTF_HashU64(key, hash);
+}
+
+bool RenderTF_ShaderPermutationPackDefines(Render_ShaderPermutationSet *set,
+																					uint32_t defineCount,
+																					Render_ShaderPermutationDefine const *defines) {
+	if (defineCount > RENDER_SHADER_PERMUTATION_MAX_DEFINES) {
+		LOGERROR("Shader permutation sets can have at most %u defines", RENDER_SHADER_PERMUTATION_MAX_DEFINES);
+		return false;
+	}
+
+	uint32_t shift = 0;
+	for (uint32_t i = 0; i < defineCount; ++i) {
+		if (defines[i].bitCount == 0 || defines[i].bitCount > 32) {
+			LOGERROR("Shader permutation define %s must have between 1 and 32 bits", defines[i].name);
+			return false;
+		}
+		if (shift + defines[i].bitCount > 64) {
+			LOGERROR("Shader permutation defines need more than the 64 bits available");
+			return false;
+		}
+		strncpy(set->defines[i].name, defines[i].name, 63);
+		set->defines[i].name[63] = 0;
+		set->defines[i].shift = shift;
+		set->defines[i].mask = (1ull << defines[i].bitCount) - 1;
+		shift += defines[i].bitCount;
+	}
+	set->defineCount = defineCount;
+	return true;
+}
+
+static Render_ShaderObjectHandle CompilePermutation(Render_ShaderPermutationSet const *set, uint64_t key) {
+	// prepend the defines, #line keeps error line numbers matching the original file
+	size_t const maxPreambleSize = (set->defineCount * (64 + 32)) + 128;
+	size_t const bufferSize = maxPreambleSize + set->sourceSize + 1;
+	char *buffer = (char *) MEMORY_MALLOC(bufferSize);
+	if (!buffer) {
+		return {0};
+	}
+
+	size_t size = 0;
+	for (uint32_t i = 0; i < set->defineCount; ++i) {
+		uint64_t const value = (key >> set->defines[i].shift) & set->defines[i].mask;
+		size += snprintf(buffer + size, maxPreambleSize - size, "#define %s %llu\n",
+										 set->defines[i].name, (unsigned long long) value);
+	}
+	size += snprintf(buffer + size, maxPreambleSize - size, "#line 1\n");
+	memcpy(buffer + size, set->source, set->sourceSize);
+	size += set->sourceSize;
+	buffer[size] = 0;
+
+	VFile_Handle file = VFile_FromMemory(buffer, size + 1, false);
+	if (!file) {
+		MEMORY_FREE(buffer);
+		return {0};
+	}
+
+	Render_ShaderObjectDesc desc = set->objectDesc;
+	desc.file = file;
+	desc.entryPoint = set->entryPoint;
+	Render_ShaderObjectHandle object = RenderTF_ShaderObjectCreate(set->renderer, &desc, set->name);
+
+	VFile_Close(file);
+	MEMORY_FREE(buffer);
+	return object;
+}
+
+AL2O3_EXTERN_C Render_ShaderPermutationSetHandle Render_ShaderPermutationSetCreate(Render_RendererHandle renderer,
+																																									 Render_ShaderPermutationSetDesc const *desc) {
+	if (!renderer || !desc->shader.file) {
+		return nullptr;
+	}
+
+	auto set = (Render_ShaderPermutationSet *) MEMORY_CALLOC(1, sizeof(Render_ShaderPermutationSet));
+	if (!set) {
+		return nullptr;
+	}
+	if (!RenderTF_ShaderPermutationPackDefines(set, desc->defineCount, desc->defines)) {
+		MEMORY_FREE(set);
+		return nullptr;
+	}
+	set->renderer = renderer;
+	set->objectDesc = desc->shader;
+	set->objectDesc.file = nullptr;
+	strncpy(set->name, VFile_GetName(desc->shader.file), 63);
+	set->name[63] = 0;
+	strncpy(set->entryPoint, desc->shader.entryPoint, 63);
+	set->entryPoint[63] = 0;
+
+	set->sourceSize = VFile_Size(desc->shader.file);
+	set->source = (char *) MEMORY_MALLOC(set->sourceSize + 1);
+	if (!set->source || VFile_Read(desc->shader.file, set->source, set->sourceSize) != set->sourceSize) {
+		MEMORY_FREE(set->source);
+		MEMORY_FREE(set);
+		return nullptr;
+	}
+	// memory files include the null terminator, don't paste it into the middle of the source
+	while (set->sourceSize > 0 && set->source[set->sourceSize - 1] == 0) {
+		set->sourceSize--;
+	}
+	set->sourceHash = RenderTF_Hash(set->source, set->sourceSize);
+
+	set->permutations = CADT_DictU64Create();
+
+	return set;
+}
+
+AL2O3_EXTERN_C void Render_ShaderPermutationSetDestroy(Render_RendererHandle renderer,
+																											 Render_ShaderPermutationSetHandle set) {
+	if (!renderer || !set) {
+		return;
+	}
+
+	RenderTF_ShaderPermutationCache *cache = renderer->shaderPermutationCache;
+	{
+		Thread::MutexLock lock(&cache->mutex);
+		CacheEntry *entries = (CacheEntry *) CADT_VectorData(cache->entries);
+
+		for (size_t i = 0; i < CADT_VectorSize(cache->entries); ++i) {
+			if (entries[i].refCount == 0) {
+				continue;
+			}
+			uint64_t const objectKey = entries[i].object.handle;
+			if (!CADT_DictU64KeyExists(set->permutations, objectKey)) {
+				continue;
+			}
+			uint64_t const cacheKey = CADT_DictU64Get(set->permutations, objectKey);
+			CADT_DictU64Remove(set->permutations, objectKey);
+
+			entries[i].refCount--;
+			if (entries[i].refCount == 0) {
+				Render_ShaderObjectDestroy(renderer, entries[i].object);
+				CADT_DictU64Remove(cache->lookup, cacheKey);
+				uint32_t const freeIndex = (uint32_t) i;
+				CADT_VectorPushElement(cache->freeEntries, (void *) &freeIndex);
+			}
+		}
+	}
+
+	CADT_DictU64Destroy(set->permutations);
+	MEMORY_FREE(set->source);
+	MEMORY_FREE(set);
+}
+
+AL2O3_EXTERN_C uint64_t Render_ShaderPermutationSetKeyValue(Render_ShaderPermutationSetHandle set,
+																														uint64_t key,
+																														uint32_t defineIndex,
+																														uint32_t value) {
+	ASSERT(defineIndex < set->defineCount);
+	ASSERT(value <= set->defines[defineIndex].mask);
+
+	uint64_t const mask = set->defines[defineIndex].mask << set->defines[defineIndex].shift;
+	return (key & ~mask) | ((((uint64_t) value) << set->defines[defineIndex].shift) & mask);
+}
+
+AL2O3_EXTERN_C Render_ShaderObjectHandle Render_ShaderPermutationGet(Render_ShaderPermutationSetHandle set,
+																																		 uint64_t key) {
+	if (!set) {
+		return {0};
+	}
+	RenderTF_ShaderPermutationCache *cache = set->renderer->shaderPermutationCache;
+	uint64_t const cacheKey = CacheKey(set, key);
+
+	{
+		Thread::MutexLock lock(&cache->mutex);
+		if (CADT_DictU64KeyExists(cache->lookup, cacheKey)) {
+			CacheEntry *entry = ((CacheEntry *) CADT_VectorData(cache->entries)) + CADT_DictU64Get(cache->lookup, cacheKey);
+			if (!CADT_DictU64KeyExists(set->permutations, entry->object.handle)) {
+				CADT_DictU64Add(set->permutations, entry->object.handle, cacheKey);
+				entry->refCount++;
+			}
+			return entry->object;
+		}
+	}
+
+	// compile outside the cache lock so cached permutations can still be fetched, the
+	// compiler itself only does one at a time (Render_Renderer::shaderCompilerMutex)
+	Render_ShaderObjectHandle object = CompilePermutation(set, key);
+	if (!Render_ShaderObjectHandleIsValid(object)) {
+		return {0};
+	}
+
+	Thread::MutexLock lock(&cache->mutex);
+	if (CADT_DictU64KeyExists(cache->lookup, cacheKey)) {
+		// another thread beat us to it
+		Render_ShaderObjectDestroy(set->renderer, object);
+		CacheEntry *entry = ((CacheEntry *) CADT_VectorData(cache->entries)) + CADT_DictU64Get(cache->lookup, cacheKey);
+		if (!CADT_DictU64KeyExists(set->permutations, entry->object.handle)) {
+			CADT_DictU64Add(set->permutations, entry->object.handle, cacheKey);
+			entry->refCount++;
+		}
+		return entry->object;
+	}
+
+	CacheEntry const entry{object, 1};
+	size_t index;
+	size_t const freeCount = CADT_VectorSize(cache->freeEntries);
+	if (freeCount) {
+		index = ((uint32_t *) CADT_VectorData(cache->freeEntries))[freeCount - 1];
+		CADT_VectorResize(cache->freeEntries, freeCount - 1);
+		((CacheEntry *) CADT_VectorData(cache->entries))[index] = entry;
+	} else {
+		index = CADT_VectorPushElement(cache->entries, (void *) &entry);
+	}
+	CADT_DictU64Add(cache->lookup, cacheKey, index);
+	CADT_DictU64Add(set->permutations, object.handle, cacheKey);
+
+	return object;
+}
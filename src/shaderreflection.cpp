@@ -0,0 +1,208 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/shader.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "shader.hpp"
+#include <ctype.h>
+
+// TheForge reflects the compiled shader (SPIR-V, DXIL or metal) when it's added, so
+// this sees exactly what the compiler saw with every define applied
+namespace {
+
+bool BindingType(uint32_t type, Render_ShaderBindingType *out) {
+	if (type & TheForge_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+		*out = Render_SBT_CONSTANT_BUFFER;
+	} else if (type & TheForge_DESCRIPTOR_TYPE_RW_TEXTURE) {
+		*out = Render_SBT_RW_TEXTURE;
+	} else if (type & TheForge_DESCRIPTOR_TYPE_TEXTURE) {
+		*out = Render_SBT_TEXTURE;
+	} else if (type & (TheForge_DESCRIPTOR_TYPE_RW_BUFFER | TheForge_DESCRIPTOR_TYPE_RW_BUFFER_RAW)) {
+		*out = Render_SBT_RW_BUFFER;
+	} else if (type & (TheForge_DESCRIPTOR_TYPE_BUFFER | TheForge_DESCRIPTOR_TYPE_BUFFER_RAW)) {
+		*out = Render_SBT_BUFFER;
+	} else if (type & TheForge_DESCRIPTOR_TYPE_SAMPLER) {
+		*out = Render_SBT_SAMPLER;
+	} else {
+		// root constants, acceleration structures etc. aren't descriptors we update
+		return false;
+	}
+	return true;
+}
+
+void CopyName(char *dst, size_t dstSize, char const *src, uint32_t srcLength) {
+	size_t const length = srcLength < dstSize - 1 ? srcLength : dstSize - 1;
+	memcpy(dst, src, length);
+	dst[length] = 0;
+}
+
+// vertex inputs come back as the semantic with its index appended, spirv adds a
+// prefix ('in.var.') to the name which isn't part of the semantic
+void AddVertexInput(Render_ShaderReflection *out, char const *name, uint32_t nameLength) {
+	if (out->vertexInputCount >= RENDER_SHADER_REFLECTION_MAX_VERTEX_INPUTS) {
+		return;
+	}
+	for (uint32_t i = nameLength; i > 0; --i) {
+		if (name[i - 1] == '.') {
+			name += i;
+			nameLength -= i;
+			break;
+		}
+	}
+	uint32_t digits = nameLength;
+	while (digits > 0 && isdigit((unsigned char) name[digits - 1])) {
+		digits--;
+	}
+
+	Render_ShaderVertexInput *input = &out->vertexInputs[out->vertexInputCount++];
+	CopyName(input->semantic, sizeof(input->semantic), name, digits);
+	input->semanticIndex = 0;
+	for (uint32_t i = digits; i < nameLength; ++i) {
+		input->semanticIndex = input->semanticIndex * 10 + (name[i] - '0');
+	}
+}
+
+} // end anon namespace
+
+bool RenderTF_ShaderReflect(TheForge_ShaderHandle shader, Render_ShaderReflection *out) {
+	memset(out, 0, sizeof(Render_ShaderReflection));
+
+	TheForge_PipelineReflection const *reflection = TheForge_ShaderGetReflection(shader);
+	if (!reflection) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < reflection->shaderResourceCount; ++i) {
+		TheForge_ShaderResource const *resource = &reflection->shaderResources[i];
+
+		Render_ShaderBindingType type;
+		if (!BindingType(resource->type, &type)) {
+			continue;
+		}
+		if (out->bindingCount >= RENDER_SHADER_REFLECTION_MAX_BINDINGS) {
+			LOGERROR("Shader has more than %u bindings", RENDER_SHADER_REFLECTION_MAX_BINDINGS);
+			return false;
+		}
+
+		Render_ShaderBinding *binding = &out->bindings[out->bindingCount++];
+		CopyName(binding->name, sizeof(binding->name), resource->name, resource->nameSize);
+		binding->type = type;
+		binding->set = resource->set;
+		binding->binding = resource->reg;
+		// TheForge's size is the buffer size for constant buffers and the array size otherwise
+		if (type == Render_SBT_CONSTANT_BUFFER) {
+			binding->count = 1;
+			binding->size = resource->size;
+		} else {
+			binding->count = resource->size ? resource->size : 1;
+			binding->size = 0;
+		}
+	}
+
+	if (reflection->vertexStageIndex != ~0u) {
+		TheForge_ShaderReflection const *vertex = &reflection->stageReflections[reflection->vertexStageIndex];
+		for (uint32_t i = 0; i < vertex->vertexInputsCount; ++i) {
+			AddVertexInput(out, vertex->vertexInputs[i].name, vertex->vertexInputs[i].nameSize);
+		}
+	}
+
+	return true;
+}
+
+static bool BindingsMatch(Render_ShaderBinding const *a, Render_ShaderBinding const *b) {
+	return a->type == b->type && a->set == b->set && a->binding == b->binding && a->count == b->count &&
+			(a->size == 0 || b->size == 0 || a->size == b->size);
+}
+
+bool RenderTF_ShaderReflectionMerge(Render_ShaderReflection *dst,
+																		Render_ShaderReflection const *src,
+																		char const *name) {
+	for (uint32_t i = 0; i < src->bindingCount; ++i) {
+		Render_ShaderBinding const *binding = &src->bindings[i];
+
+		bool found = false;
+		for (uint32_t j = 0; j < dst->bindingCount; ++j) {
+			Render_ShaderBinding const *existing = &dst->bindings[j];
+			if (strcmp(existing->name, binding->name) == 0) {
+				if (!BindingsMatch(existing, binding)) {
+					LOGERROR("%s: %s is declared differently between stages", name, binding->name);
+					return false;
+				}
+				found = true;
+				break;
+			}
+			if (existing->binding != ~0u && existing->binding == binding->binding && existing->set == binding->set &&
+					existing->type == binding->type) {
+				LOGERROR("%s: %s and %s share register %u space %u",
+								 name, existing->name, binding->name, binding->binding, binding->set);
+				return false;
+			}
+		}
+		if (found) {
+			continue;
+		}
+		if (dst->bindingCount >= RENDER_SHADER_REFLECTION_MAX_BINDINGS) {
+			LOGERROR("%s: more than %u bindings", name, RENDER_SHADER_REFLECTION_MAX_BINDINGS);
+			return false;
+		}
+		dst->bindings[dst->bindingCount++] = *binding;
+	}
+
+	for (uint32_t i = 0; i < src->vertexInputCount && dst->vertexInputCount < RENDER_SHADER_REFLECTION_MAX_VERTEX_INPUTS;
+			 ++i) {
+		dst->vertexInputs[dst->vertexInputCount++] = src->vertexInputs[i];
+	}
+	return true;
+}
+
+AL2O3_EXTERN_C Render_ShaderReflection const *Render_ShaderGetReflection(Render_ShaderHandle handle) {
+	if (!Render_ShaderHandleIsValid(handle)) {
+		return nullptr;
+	}
+	return &Render_ShaderHandleToPtr(handle)->reflection;
+}
+
+AL2O3_EXTERN_C Render_ShaderReflection const *Render_RootSignatureGetReflection(Render_RootSignatureHandle handle) {
+	if (!Render_RootSignatureHandleIsValid(handle)) {
+		return nullptr;
+	}
+	return &Render_RootSignatureHandleToPtr(handle)->reflection;
+}
+
+static bool SemanticEqual(char const *a, char const *b, size_t bLength) {
+	size_t i = 0;
+	for (; i < bLength && a[i] != 0; ++i) {
+		if (toupper((unsigned char) a[i]) != toupper((unsigned char) b[i])) {
+			return false;
+		}
+	}
+	return a[i] == 0 && (i == bLength || b[i] == 0);
+}
+
+AL2O3_EXTERN_C bool Render_ShaderValidateVertexLayout(Render_ShaderHandle handle, Render_VertexLayoutHandle layout) {
+	if (!Render_ShaderHandleIsValid(handle)) {
+		return false;
+	}
+	Render_ShaderReflection const *reflection = &Render_ShaderHandleToPtr(handle)->reflection;
+	uint32_t const attribCount = layout ? layout->attribCount : 0;
+
+	bool okay = true;
+	for (uint32_t i = 0; i < reflection->vertexInputCount; ++i) {
+		Render_ShaderVertexInput const *input = &reflection->vertexInputs[i];
+
+		// attribs that share a semantic name are indexed in declaration order
+		uint32_t matches = 0;
+		for (uint32_t j = 0; j < attribCount; ++j) {
+			TheForge_VertexAttrib const *attrib = &layout->attribs[j];
+			if (SemanticEqual(input->semantic, attrib->semanticName, attrib->semanticNameLength)) {
+				matches++;
+			}
+		}
+		if (matches <= input->semanticIndex) {
+			LOGERROR("Vertex layout doesn't supply shader input %s%u", input->semantic, input->semanticIndex);
+			okay = false;
+		}
+	}
+	return okay;
+}
@@ -0,0 +1,436 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/dictu64.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_thread/thread.hpp"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/theforge/state.h"
+#include "render_basics/api.h"
+#include "pipelinecache.hpp"
+#include "statecache.hpp"
+#include "hash.hpp"
+
+namespace {
+
+struct StateTable {
+	CADT_DictU64Handle lookup; ///< desc hash -> handle of the interned object
+	CADT_VectorHandle live;    ///< every handle alive, including the odd uninterned collision
+};
+
+} // end anon namespace
+
+struct RenderTF_StateCache {
+	Thread_Mutex mutex;
+
+	StateTable blendStates;
+	StateTable depthStates;
+	StateTable rasteriserStates;
+	StateTable samplers;
+};
+
+namespace {
+
+void TableCreate(StateTable *table) {
+	table->lookup = CADT_DictU64Create();
+	table->live = CADT_VectorCreate(sizeof(uint32_t));
+}
+
+void TableDestroy(StateTable *table) {
+	CADT_VectorDestroy(table->live);
+	CADT_DictU64Destroy(table->lookup);
+}
+
+void TableRemoveLive(StateTable *table, uint32_t handle) {
+	uint32_t *live = (uint32_t *) CADT_VectorData(table->live);
+	size_t const count = CADT_VectorSize(table->live);
+	for (size_t i = 0; i < count; ++i) {
+		if (live[i] == handle) {
+			live[i] = live[count - 1];
+			CADT_VectorResize(table->live, count - 1);
+			return;
+		}
+	}
+}
+
+// the four state types only differ in the handle functions, TheForge calls used and how
+// their descs are hashed and compared
+template<typename Handle, typename Object, typename Desc>
+struct StateType {
+	uint64_t (*hash)(Desc const *);
+	bool (*equal)(Desc const *, Desc const *);
+	Handle (*alloc)();
+	Object *(*toPtr)(Handle);
+	bool (*isValid)(Handle);
+	void (*release)(Handle);
+	bool (*add)(TheForge_RendererHandle, Desc const *, Object *);
+	void (*remove)(TheForge_RendererHandle, Object *);
+	RenderTF_RegistryType registryType; ///< RenderTF_RT_COUNT if pipelines don't refer to it
+};
+
+template<typename Handle, typename Object, typename Desc>
+Handle Intern(Render_RendererHandle renderer,
+							StateTable *table,
+							Desc const *desc,
+							StateType<Handle, Object, Desc> const &type) {
+	uint64_t const hash = type.hash(desc);
+
+	RenderTF_StateCache *cache = renderer->stateCache;
+	Thread::MutexLock lock(&cache->mutex);
+
+	bool collision = false;
+	if (CADT_DictU64KeyExists(table->lookup, hash)) {
+		Handle handle;
+		handle.handle = (decltype(handle.handle)) CADT_DictU64Get(table->lookup, hash);
+		Object *object = type.toPtr(handle);
+		if (type.equal(&object->desc, desc)) {
+			object->refCount++;
+			return handle;
+		}
+		// different desc with the same hash, works but isn't shared
+		collision = true;
+	}
+
+	Handle handle = type.alloc();
+	Object *object = type.toPtr(handle);
+	if (!object) {
+		return {0};
+	}
+	memcpy(&object->desc, desc, sizeof(Desc));
+	object->hash = hash;
+	object->refCount = 1;
+	if (!type.add(renderer->renderer, desc, object)) {
+		type.release(handle);
+		return {0};
+	}
+
+	if (!collision) {
+		CADT_DictU64Add(table->lookup, hash, handle.handle);
+	}
+	uint32_t const liveHandle = handle.handle;
+	CADT_VectorPushElement(table->live, (void *) &liveHandle);
+	if (type.registryType != RenderTF_RT_COUNT) {
+		RenderTF_PipelineCacheRegister(renderer, type.registryType, hash, handle.handle);
+	}
+	return handle;
+}
+
+template<typename Handle, typename Object, typename Desc>
+void Release(Render_RendererHandle renderer,
+						 StateTable *table,
+						 Handle handle,
+						 StateType<Handle, Object, Desc> const &type) {
+	if (!renderer || !type.isValid(handle)) {
+		return;
+	}
+
+	RenderTF_StateCache *cache = renderer->stateCache;
+	Thread::MutexLock lock(&cache->mutex);
+
+	Object *object = type.toPtr(handle);
+	ASSERT(object->refCount > 0);
+	if (--object->refCount != 0) {
+		return;
+	}
+
+	if (CADT_DictU64KeyExists(table->lookup, object->hash) &&
+			CADT_DictU64Get(table->lookup, object->hash) == handle.handle) {
+		CADT_DictU64Remove(table->lookup, object->hash);
+	}
+	TableRemoveLive(table, handle.handle);
+	if (type.registryType != RenderTF_RT_COUNT) {
+		RenderTF_PipelineCacheUnregister(renderer, type.registryType, object->hash, handle.handle);
+	}
+	type.remove(renderer->renderer, object);
+	type.release(handle);
+}
+
+// used at shutdown, removes whatever is left regardless of references
+template<typename Handle, typename Object, typename Desc>
+void RemoveAll(Render_RendererHandle renderer,
+							 StateTable *table,
+							 StateType<Handle, Object, Desc> const &type,
+							 char const *name) {
+	uint32_t const *live = (uint32_t const *) CADT_VectorData(table->live);
+	size_t const count = CADT_VectorSize(table->live);
+	for (size_t i = 0; i < count; ++i) {
+		Handle handle;
+		handle.handle = live[i];
+		type.remove(renderer->renderer, type.toPtr(handle));
+		type.release(handle);
+	}
+	if (count) {
+		LOGWARNING("%u %s objects were not destroyed before the renderer", (uint32_t) count, name);
+	}
+}
+
+uint64_t HashFloat(float value, uint64_t seed) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(uint32_t));
+	return RenderTF_HashU64(bits, seed);
+}
+
+// descs are hashed and compared a field at a time, apps don't have to zero padding.
+// The hashes are also pipeline manifest keys so must stay stable between runs
+uint64_t HashBlendState(TheForge_BlendStateDesc const *desc) {
+	uint64_t hash = RenderTF_HashSeed;
+	uint32_t const count = sizeof(desc->srcFactors) / sizeof(desc->srcFactors[0]);
+	for (uint32_t i = 0; i < count; ++i) {
+		hash = RenderTF_HashU64((uint64_t) desc->srcFactors[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->dstFactors[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->srcAlphaFactors[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->dstAlphaFactors[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->blendModes[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->blendAlphaModes[i], hash);
+		hash = RenderTF_HashU64((uint64_t) desc->masks[i], hash);
+	}
+	hash = RenderTF_HashU64((uint64_t) desc->renderTargetMask, hash);
+	hash = RenderTF_HashU64(desc->alphaToCoverage, hash);
+	return RenderTF_HashU64(desc->independentBlend, hash);
+}
+
+bool EqualBlendState(TheForge_BlendStateDesc const *a, TheForge_BlendStateDesc const *b) {
+	uint32_t const count = sizeof(a->srcFactors) / sizeof(a->srcFactors[0]);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (a->srcFactors[i] != b->srcFactors[i] ||
+				a->dstFactors[i] != b->dstFactors[i] ||
+				a->srcAlphaFactors[i] != b->srcAlphaFactors[i] ||
+				a->dstAlphaFactors[i] != b->dstAlphaFactors[i] ||
+				a->blendModes[i] != b->blendModes[i] ||
+				a->blendAlphaModes[i] != b->blendAlphaModes[i] ||
+				a->masks[i] != b->masks[i]) {
+			return false;
+		}
+	}
+	return a->renderTargetMask == b->renderTargetMask &&
+			a->alphaToCoverage == b->alphaToCoverage &&
+			a->independentBlend == b->independentBlend;
+}
+
+uint64_t HashDepthState(TheForge_DepthStateDesc const *desc) {
+	uint64_t hash = RenderTF_HashU64(desc->depthTest);
+	hash = RenderTF_HashU64(desc->depthWrite, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->depthFunc, hash);
+	hash = RenderTF_HashU64(desc->stencilTest, hash);
+	hash = RenderTF_HashU64(desc->stencilReadMask, hash);
+	hash = RenderTF_HashU64(desc->stencilWriteMask, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->stencilFrontFunc, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->stencilFrontFail, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->depthFrontFail, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->stencilFrontPass, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->stencilBackFunc, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->stencilBackFail, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->depthBackFail, hash);
+	return RenderTF_HashU64((uint64_t) desc->stencilBackPass, hash);
+}
+
+bool EqualDepthState(TheForge_DepthStateDesc const *a, TheForge_DepthStateDesc const *b) {
+	return a->depthTest == b->depthTest &&
+			a->depthWrite == b->depthWrite &&
+			a->depthFunc == b->depthFunc &&
+			a->stencilTest == b->stencilTest &&
+			a->stencilReadMask == b->stencilReadMask &&
+			a->stencilWriteMask == b->stencilWriteMask &&
+			a->stencilFrontFunc == b->stencilFrontFunc &&
+			a->stencilFrontFail == b->stencilFrontFail &&
+			a->depthFrontFail == b->depthFrontFail &&
+			a->stencilFrontPass == b->stencilFrontPass &&
+			a->stencilBackFunc == b->stencilBackFunc &&
+			a->stencilBackFail == b->stencilBackFail &&
+			a->depthBackFail == b->depthBackFail &&
+			a->stencilBackPass == b->stencilBackPass;
+}
+
+uint64_t HashRasteriserState(TheForge_RasterizerStateDesc const *desc) {
+	uint64_t hash = RenderTF_HashU64((uint64_t) desc->cullMode);
+	hash = RenderTF_HashU64((uint64_t) desc->depthBias, hash);
+	hash = HashFloat(desc->slopeScaledDepthBias, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->fillMode, hash);
+	hash = RenderTF_HashU64(desc->multiSample, hash);
+	hash = RenderTF_HashU64(desc->scissor, hash);
+	return RenderTF_HashU64((uint64_t) desc->frontFace, hash);
+}
+
+bool EqualRasteriserState(TheForge_RasterizerStateDesc const *a, TheForge_RasterizerStateDesc const *b) {
+	return a->cullMode == b->cullMode &&
+			a->depthBias == b->depthBias &&
+			a->slopeScaledDepthBias == b->slopeScaledDepthBias &&
+			a->fillMode == b->fillMode &&
+			a->multiSample == b->multiSample &&
+			a->scissor == b->scissor &&
+			a->frontFace == b->frontFace;
+}
+
+uint64_t HashSampler(TheForge_SamplerDesc const *desc) {
+	uint64_t hash = RenderTF_HashU64((uint64_t) desc->minFilter);
+	hash = RenderTF_HashU64((uint64_t) desc->magFilter, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->mipMapMode, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->addressU, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->addressV, hash);
+	hash = RenderTF_HashU64((uint64_t) desc->addressW, hash);
+	hash = HashFloat(desc->mipLodBias, hash);
+	hash = HashFloat(desc->maxAnisotropy, hash);
+	return RenderTF_HashU64((uint64_t) desc->compareFunc, hash);
+}
+
+bool EqualSampler(TheForge_SamplerDesc const *a, TheForge_SamplerDesc const *b) {
+	return a->minFilter == b->minFilter &&
+			a->magFilter == b->magFilter &&
+			a->mipMapMode == b->mipMapMode &&
+			a->addressU == b->addressU &&
+			a->addressV == b->addressV &&
+			a->addressW == b->addressW &&
+			a->mipLodBias == b->mipLodBias &&
+			a->maxAnisotropy == b->maxAnisotropy &&
+			a->compareFunc == b->compareFunc;
+}
+
+StateType<Render_BlendStateHandle, Render_BlendState, TheForge_BlendStateDesc> const BlendStateType{
+		&HashBlendState,
+		&EqualBlendState,
+		&Render_BlendStateHandleAlloc,
+		&Render_BlendStateHandleToPtr,
+		&Render_BlendStateHandleIsValid,
+		&Render_BlendStateHandleRelease,
+		[](TheForge_RendererHandle renderer, TheForge_BlendStateDesc const *desc, Render_BlendState *object) {
+			TheForge_AddBlendState(renderer, desc, &object->state);
+			return object->state != nullptr;
+		},
+		[](TheForge_RendererHandle renderer, Render_BlendState *object) {
+			TheForge_RemoveBlendState(renderer, object->state);
+		},
+		RenderTF_RT_BLENDSTATE
+};
+
+StateType<Render_DepthStateHandle, Render_DepthState, TheForge_DepthStateDesc> const DepthStateType{
+		&HashDepthState,
+		&EqualDepthState,
+		&Render_DepthStateHandleAlloc,
+		&Render_DepthStateHandleToPtr,
+		&Render_DepthStateHandleIsValid,
+		&Render_DepthStateHandleRelease,
+		[](TheForge_RendererHandle renderer, TheForge_DepthStateDesc const *desc, Render_DepthState *object) {
+			TheForge_AddDepthState(renderer, desc, &object->state);
+			return object->state != nullptr;
+		},
+		[](TheForge_RendererHandle renderer, Render_DepthState *object) {
+			TheForge_RemoveDepthState(renderer, object->state);
+		},
+		RenderTF_RT_DEPTHSTATE
+};
+
+StateType<Render_RasteriserStateHandle, Render_RasteriserState, TheForge_RasterizerStateDesc> const RasteriserStateType{
+		&HashRasteriserState,
+		&EqualRasteriserState,
+		&Render_RasteriserStateHandleAlloc,
+		&Render_RasteriserStateHandleToPtr,
+		&Render_RasteriserStateHandleIsValid,
+		&Render_RasteriserStateHandleRelease,
+		[](TheForge_RendererHandle renderer, TheForge_RasterizerStateDesc const *desc, Render_RasteriserState *object) {
+			TheForge_AddRasterizerState(renderer, desc, &object->state);
+			return object->state != nullptr;
+		},
+		[](TheForge_RendererHandle renderer, Render_RasteriserState *object) {
+			TheForge_RemoveRasterizerState(renderer, object->state);
+		},
+		RenderTF_RT_RASTERISERSTATE
+};
+
+// samplers are baked into root signatures not pipelines so aren't registered
+StateType<Render_SamplerHandle, Render_Sampler, TheForge_SamplerDesc> const SamplerType{
+		&HashSampler,
+		&EqualSampler,
+		&Render_SamplerHandleAlloc,
+		&Render_SamplerHandleToPtr,
+		&Render_SamplerHandleIsValid,
+		&Render_SamplerHandleRelease,
+		[](TheForge_RendererHandle renderer, TheForge_SamplerDesc const *desc, Render_Sampler *object) {
+			TheForge_AddSampler(renderer, desc, &object->sampler);
+			return object->sampler != nullptr;
+		},
+		[](TheForge_RendererHandle renderer, Render_Sampler *object) {
+			TheForge_RemoveSampler(renderer, object->sampler);
+		},
+		RenderTF_RT_COUNT
+};
+
+} // end anon namespace
+
+RenderTF_StateCache *RenderTF_StateCacheCreate() {
+	auto cache = (RenderTF_StateCache *) MEMORY_CALLOC(1, sizeof(RenderTF_StateCache));
+	if (!cache) {
+		return nullptr;
+	}
+	Thread_MutexCreate(&cache->mutex);
+	TableCreate(&cache->blendStates);
+	TableCreate(&cache->depthStates);
+	TableCreate(&cache->rasteriserStates);
+	TableCreate(&cache->samplers);
+	return cache;
+}
+
+void RenderTF_StateCacheDestroy(Render_RendererHandle renderer, RenderTF_StateCache *cache) {
+	if (!cache) {
+		return;
+	}
+
+	RemoveAll(renderer, &cache->blendStates, BlendStateType, "blend state");
+	RemoveAll(renderer, &cache->depthStates, DepthStateType, "depth state");
+	RemoveAll(renderer, &cache->rasteriserStates, RasteriserStateType, "rasteriser state");
+	RemoveAll(renderer, &cache->samplers, SamplerType, "sampler");
+
+	TableDestroy(&cache->samplers);
+	TableDestroy(&cache->rasteriserStates);
+	TableDestroy(&cache->depthStates);
+	TableDestroy(&cache->blendStates);
+	Thread_MutexDestroy(&cache->mutex);
+	MEMORY_FREE(cache);
+}
+
+AL2O3_EXTERN_C Render_BlendStateHandle Render_BlendStateCreate(Render_RendererHandle renderer,
+																															 Render_BlendStateDesc const *desc) {
+	return Intern(renderer, &renderer->stateCache->blendStates, desc, BlendStateType);
+}
+
+AL2O3_EXTERN_C void Render_BlendStateDestroy(Render_RendererHandle renderer, Render_BlendStateHandle handle) {
+	if (!renderer) {
+		return;
+	}
+	Release(renderer, &renderer->stateCache->blendStates, handle, BlendStateType);
+}
+
+AL2O3_EXTERN_C Render_DepthStateHandle Render_DepthStateCreate(Render_RendererHandle renderer,
+																															 Render_DepthStateDesc const *desc) {
+	return Intern(renderer, &renderer->stateCache->depthStates, desc, DepthStateType);
+}
+
+AL2O3_EXTERN_C void Render_DepthStateDestroy(Render_RendererHandle renderer, Render_DepthStateHandle handle) {
+	if (!renderer) {
+		return;
+	}
+	Release(renderer, &renderer->stateCache->depthStates, handle, DepthStateType);
+}
+
+AL2O3_EXTERN_C Render_RasteriserStateHandle Render_RasteriserStateCreate(Render_RendererHandle renderer,
+																																				 Render_RasteriserStateDesc const *desc) {
+	return Intern(renderer, &renderer->stateCache->rasteriserStates, desc, RasteriserStateType);
+}
+
+AL2O3_EXTERN_C void Render_RasteriserStateDestroy(Render_RendererHandle renderer, Render_RasteriserStateHandle handle) {
+	if (!renderer) {
+		return;
+	}
+	Release(renderer, &renderer->stateCache->rasteriserStates, handle, RasteriserStateType);
+}
+
+AL2O3_EXTERN_C Render_SamplerHandle Render_SamplerCreate(Render_RendererHandle renderer, Render_SamplerDesc const *desc) {
+	return Intern(renderer, &renderer->stateCache->samplers, desc, SamplerType);
+}
+
+AL2O3_EXTERN_C void Render_SamplerDestroy(Render_RendererHandle renderer, Render_SamplerHandle handle) {
+	if (!renderer) {
+		return;
+	}
+	Release(renderer, &renderer->stateCache->samplers, handle, SamplerType);
+}
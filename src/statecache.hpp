@@ -0,0 +1,9 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+
+// interns blend, depth, rasteriser and sampler states by descriptor
+struct RenderTF_StateCache *RenderTF_StateCacheCreate();
+// removes any states still alive, call once all pipelines are gone
+void RenderTF_StateCacheDestroy(Render_RendererHandle renderer, struct RenderTF_StateCache *cache);
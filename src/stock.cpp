@@ -5,397 +5,326 @@
 #include "render_basics/theforge/api.h"
 #include "render_basics/theforge/handlemanager.h"
 #include "render_basics/api.h"
-
-AL2O3_EXTERN_C Render_BlendStateHandle Render_GetStockBlendState(Render_RendererHandle renderer,
-																																 Render_StockBlendStateType stock) {
-
-	if (Render_BlendStateHandleIsValid(renderer->stockBlendState[stock])) {
-		return renderer->stockBlendState[stock];
-	}
-
-	TheForge_BlendStateDesc const *blendDesc;
-	switch (stock) {
-
-		case Render_SBS_OPAQUE: {
-			TheForge_BlendStateDesc const desc{
-					{TheForge_BC_ONE},
-					{TheForge_BC_ZERO},
-					{TheForge_BC_ONE},
-					{TheForge_BC_ZERO},
-					{TheForge_BM_ADD},
-					{TheForge_BM_ADD},
-					{0xF},
-					TheForge_BST_0,
-					false, false
-			};
-			blendDesc = &desc;
-			break;
+#include "render_basics/theforge/pipeline.h"
+#include "render_basics/theforge/state.h"
+
+// Stock descriptors, indexed by the stock enums.
+// Each entry carries its enum so a reordered enum fails to compile rather than
+// silently handing out the wrong state
+
+namespace {
+
+struct StockBlendState {
+	Render_StockBlendStateType type;
+	TheForge_BlendStateDesc desc;
+};
+
+struct StockDepthState {
+	Render_StockDepthStateType type;
+	TheForge_DepthStateDesc desc;
+};
+
+struct StockRasteriserState {
+	Render_StockRasterState type;
+	TheForge_RasterizerStateDesc desc;
+};
+
+struct StockSampler {
+	Render_StockSamplerType type;
+	TheForge_SamplerDesc desc;
+};
+
+struct StockVertexLayout {
+	Render_StockVertexLayouts type;
+	TheForge_VertexLayout const *layout;
+};
+
+constexpr StockBlendState StockBlendStates[] = {
+		{Render_SBS_OPAQUE, {
+				{TheForge_BC_ONE},
+				{TheForge_BC_ZERO},
+				{TheForge_BC_ONE},
+				{TheForge_BC_ZERO},
+				{TheForge_BM_ADD},
+				{TheForge_BM_ADD},
+				{0xF},
+				TheForge_BST_0,
+				false, false
+		}},
+		{Render_SBS_PORTER_DUFF, {
+				{TheForge_BC_SRC_ALPHA},
+				{TheForge_BC_ONE_MINUS_SRC_ALPHA},
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE},
+				{TheForge_BM_ADD},
+				{TheForge_BM_ADD},
+				{0xF},
+				TheForge_BST_0,
+				false, false
+		}},
+		{Render_SBS_ADDITIVE, {
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE},
+				{TheForge_BM_ADD},
+				{TheForge_BM_ADD},
+				{0xF},
+				TheForge_BST_0,
+				false, false
+		}},
+		{Render_SBS_PM_PORTER_DUFF, {
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE_MINUS_SRC_ALPHA},
+				{TheForge_BC_ONE},
+				{TheForge_BC_ONE},
+				{TheForge_BM_ADD},
+				{TheForge_BM_ADD},
+				{0xF},
+				TheForge_BST_0,
+				false, false
+		}},
+};
+
+constexpr StockDepthState StockDepthStates[] = {
+		{Render_SDS_IGNORE, {false, false, TheForge_CMP_ALWAYS}},
+		{Render_SDS_READONLY_LESS, {true, false, TheForge_CMP_LESS}},
+		{Render_SDS_READWRITE_LESS, {true, true, TheForge_CMP_LESS}},
+		{Render_SDS_READONLY_GREATER, {true, false, TheForge_CMP_GREATER}},
+		{Render_SDS_READWRITE_GREATER, {true, true, TheForge_CMP_GREATER}},
+		{Render_SDS_WRITEONLY, {false, true, TheForge_CMP_ALWAYS}},
+};
+
+constexpr StockRasteriserState StockRasteriserStates[] = {
+		{Render_SRS_NOCULL, {TheForge_CM_NONE, 0, 0.0, TheForge_FM_SOLID, false, true}},
+		{Render_SRS_BACKCULL, {TheForge_CM_BACK, 0, 0.0, TheForge_FM_SOLID, false, true}},
+		{Render_SRS_FRONTCULL, {TheForge_CM_FRONT, 0, 0.0, TheForge_FM_SOLID, false, true}},
+};
+
+constexpr StockSampler StockSamplers[] = {
+		{Render_SST_POINT, {
+				TheForge_FT_NEAREST,
+				TheForge_FT_NEAREST,
+				TheForge_MM_NEAREST,
+				TheForge_AM_CLAMP_TO_EDGE,
+				TheForge_AM_CLAMP_TO_EDGE,
+				TheForge_AM_CLAMP_TO_EDGE,
+		}},
+		{Render_SST_LINEAR, {
+				TheForge_FT_LINEAR,
+				TheForge_FT_LINEAR,
+				TheForge_MM_LINEAR,
+				TheForge_AM_CLAMP_TO_EDGE,
+				TheForge_AM_CLAMP_TO_EDGE,
+				TheForge_AM_CLAMP_TO_EDGE,
+		}},
+};
+
+static constexpr TheForge_VertexLayout vertexLayout2DPackedColour{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 1, sizeof(float) * 2}
 		}
+};
 
-		case Render_SBS_PORTER_DUFF: {
-			TheForge_BlendStateDesc const desc{
-					{TheForge_BC_SRC_ALPHA},
-					{TheForge_BC_ONE_MINUS_SRC_ALPHA},
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE},
-					{TheForge_BM_ADD},
-					{TheForge_BM_ADD},
-					{0xF},
-					TheForge_BST_0,
-					false, false
-			};
-			blendDesc = &desc;
-			break;
+static constexpr TheForge_VertexLayout vertexLayout2DFloatColour{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 1, sizeof(float) * 2}
 		}
-		case Render_SBS_ADDITIVE: {
-			TheForge_BlendStateDesc const desc{
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE},
-					{TheForge_BM_ADD},
-					{TheForge_BM_ADD},
-					{0xF},
-					TheForge_BST_0,
-					false, false
-			};
-			blendDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout2DPackedColourUV{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 2},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 4}
 		}
-		case Render_SBS_PM_PORTER_DUFF: {
-			TheForge_BlendStateDesc const desc{
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE_MINUS_SRC_ALPHA},
-					{TheForge_BC_ONE},
-					{TheForge_BC_ONE},
-					{TheForge_BM_ADD},
-					{TheForge_BM_ADD},
-					{0xF},
-					TheForge_BST_0,
-					false, false
-			};
-			blendDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout2DFloatColourUV{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 2},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 2, sizeof(float) * 4}
 		}
+};
 
-		default: ASSERT(false);
-			return {0};
-	}
-
-	renderer->stockBlendState[stock] = Render_BlendStateHandleAlloc();
-	Render_BlendState *bs = Render_BlendStateHandleToPtr(renderer->stockBlendState[stock]);
-
-	TheForge_AddBlendState(renderer->renderer, blendDesc, &bs->state);
-	return renderer->stockBlendState[stock];
-
-}
-AL2O3_EXTERN_C Render_DepthStateHandle Render_GetStockDepthState(Render_RendererHandle renderer,
-																																 Render_StockDepthStateType stock) {
-	if (Render_DepthStateHandleIsValid(renderer->stockDepthState[stock])) {
-		return renderer->stockDepthState[stock];
-	}
+static constexpr TheForge_VertexLayout vertexLayout3DPackedColour{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 1, sizeof(float) * 3}
+		}
+};
 
-	TheForge_DepthStateDesc const *depthDesc;
-	switch (stock) {
-		case Render_SDS_IGNORE: {
-			TheForge_DepthStateDesc const desc{
-					false, false,
-					TheForge_CMP_ALWAYS,
-			};
-			depthDesc = &desc;
-			break;
+static constexpr TheForge_VertexLayout vertexLayout3DFloatColour{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 1, sizeof(float) * 3}
 		}
-		case Render_SDS_READONLY_LESS: {
-			TheForge_DepthStateDesc const desc{
-					true, false,
-					TheForge_CMP_LESS,
-			};
-			depthDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout3DPackedColourUV{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 5}
 		}
-		case Render_SDS_READWRITE_LESS: {
-			TheForge_DepthStateDesc const desc{
-					true, true,
-					TheForge_CMP_LESS,
-			};
-			depthDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout3DFloatColourUV{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 2, sizeof(float) * 5}
 		}
-		case Render_SDS_READONLY_GREATER: {
-			TheForge_DepthStateDesc const desc{
-					true, false,
-					TheForge_CMP_GREATER,
-			};
-			depthDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout3DNormal{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
 		}
-		case Render_SDS_READWRITE_GREATER: {
-			TheForge_DepthStateDesc const desc{
-					true, true,
-					TheForge_CMP_GREATER,
-			};
-			depthDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout3DNormalPackedColour{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
+				{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 6}
 		}
-		case Render_SDS_WRITEONLY: {
-			TheForge_DepthStateDesc const desc{
-					false, true,
-					TheForge_CMP_ALWAYS,
-			};
-			depthDesc = &desc;
-			break;
+};
+
+static constexpr TheForge_VertexLayout vertexLayout3DNormalUV{
+		3,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
+				{TheForge_SS_TEXCOORD0, 10, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 2, sizeof(float) * 6},
 		}
+};
 
-		default: ASSERT(false);
-			return {0};
+static constexpr TheForge_VertexLayout vertexLayout3DUV{
+		2,
+		{
+				{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
+				{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
+		}
+};
+
+
+constexpr StockVertexLayout StockVertexLayouts[] = {
+		{Render_SVL_2D_COLOUR, &vertexLayout2DPackedColour},
+		{Render_SVL_2D_FLOATCOLOUR, &vertexLayout2DFloatColour},
+		{Render_SVL_2D_COLOUR_UV, &vertexLayout2DPackedColourUV},
+		{Render_SVL_2D_FLOATCOLOUR_UV, &vertexLayout2DFloatColourUV},
+		{Render_SVL_3D_COLOUR, &vertexLayout3DPackedColour},
+		{Render_SVL_3D_FLOATCOLOUR, &vertexLayout3DFloatColour},
+		{Render_SVL_3D_COLOUR_UV, &vertexLayout3DPackedColourUV},
+		{Render_SVL_3D_FLOATCOLOUR_UV, &vertexLayout3DFloatColourUV},
+		{Render_SVL_3D_NORMAL, &vertexLayout3DNormal},
+		{Render_SVL_3D_NORMAL_COLOUR, &vertexLayout3DNormalPackedColour},
+		{Render_SVL_3D_NORMAL_UV, &vertexLayout3DNormalUV},
+		{Render_SVL_3D_UV, &vertexLayout3DUV},
+};
+
+template<typename Entry, size_t Count>
+constexpr bool IndexedByType(Entry const (&table)[Count]) {
+	for (size_t i = 0; i < Count; ++i) {
+		if ((size_t) table[i].type != i) {
+			return false;
+		}
 	}
+	return true;
+}
 
-	renderer->stockDepthState[stock] = Render_DepthStateHandleAlloc();
-	Render_DepthState *ds = Render_DepthStateHandleToPtr(renderer->stockDepthState[stock]);
+static_assert(sizeof(StockBlendStates) / sizeof(StockBlendStates[0]) == Render_SBS_COUNT, "Stock blend state missing");
+static_assert(IndexedByType(StockBlendStates), "StockBlendStates isn't in Render_StockBlendStateType order");
+static_assert(sizeof(StockDepthStates) / sizeof(StockDepthStates[0]) == Render_SDS_COUNT, "Stock depth state missing");
+static_assert(IndexedByType(StockDepthStates), "StockDepthStates isn't in Render_StockDepthStateType order");
+static_assert(sizeof(StockRasteriserStates) / sizeof(StockRasteriserStates[0]) == Render_SRS_COUNT,
+							"Stock rasteriser state missing");
+static_assert(IndexedByType(StockRasteriserStates), "StockRasteriserStates isn't in Render_StockRasterState order");
+static_assert(sizeof(StockSamplers) / sizeof(StockSamplers[0]) == Render_SST_COUNT, "Stock sampler missing");
+static_assert(IndexedByType(StockSamplers), "StockSamplers isn't in Render_StockSamplerType order");
+static_assert(sizeof(StockVertexLayouts) / sizeof(StockVertexLayouts[0]) == Render_SVL_COUNT,
+							"Stock vertex layout missing");
+static_assert(IndexedByType(StockVertexLayouts), "StockVertexLayouts isn't in Render_StockVertexLayouts order");
+
+} // end anon namespace
+
+// stock objects are only released with the renderer so a non zero handle is
+// enough, after the first call (or Render_RendererPrewarmStock) this is an index
+AL2O3_EXTERN_C Render_BlendStateHandle Render_GetStockBlendState(Render_RendererHandle renderer,
+																																 Render_StockBlendStateType stock) {
+	ASSERT(stock < Render_SBS_COUNT);
+	if (renderer->stockBlendState[stock].handle == 0) {
+		renderer->stockBlendState[stock] = Render_BlendStateCreate(renderer, &StockBlendStates[stock].desc);
+	}
+	return renderer->stockBlendState[stock];
+}
 
-	TheForge_AddDepthState(renderer->renderer, depthDesc, &ds->state);
+AL2O3_EXTERN_C Render_DepthStateHandle Render_GetStockDepthState(Render_RendererHandle renderer,
+																																 Render_StockDepthStateType stock) {
+	ASSERT(stock < Render_SDS_COUNT);
+	if (renderer->stockDepthState[stock].handle == 0) {
+		renderer->stockDepthState[stock] = Render_DepthStateCreate(renderer, &StockDepthStates[stock].desc);
+	}
 	return renderer->stockDepthState[stock];
-
 }
 
 AL2O3_EXTERN_C Render_RasteriserStateHandle Render_GetStockRasterisationState(Render_RendererHandle renderer,
 																																							Render_StockRasterState stock) {
-	if (Render_RasteriserStateHandleIsValid(renderer->stockRasteriserState[stock])) {
-		return renderer->stockRasteriserState[stock];
-	}
-
-	TheForge_RasterizerStateDesc const *rasterizerStateDesc;
-	switch (stock) {
-		case Render_SRS_NOCULL: {
-			TheForge_RasterizerStateDesc const desc{
-					TheForge_CM_NONE,
-					0,
-					0.0,
-					TheForge_FM_SOLID,
-					false,
-					true,
-			};
-			rasterizerStateDesc = &desc;
-			break;
-		}
-		case Render_SRS_BACKCULL: {
-			TheForge_RasterizerStateDesc const desc{
-					TheForge_CM_BACK,
-					0,
-					0.0,
-					TheForge_FM_SOLID,
-					false,
-					true,
-			};
-			rasterizerStateDesc = &desc;
-			break;
-		}
-
-		case Render_SRS_FRONTCULL: {
-			TheForge_RasterizerStateDesc const desc{
-					TheForge_CM_FRONT,
-					0,
-					0.0,
-					TheForge_FM_SOLID,
-					false,
-					true,
-			};
-			rasterizerStateDesc = &desc;
-			break;
-		}
-
-		default: ASSERT(false);
-			return {0};
+	ASSERT(stock < Render_SRS_COUNT);
+	if (renderer->stockRasteriserState[stock].handle == 0) {
+		renderer->stockRasteriserState[stock] = Render_RasteriserStateCreate(renderer, &StockRasteriserStates[stock].desc);
 	}
-
-	renderer->stockRasteriserState[stock] = Render_RasteriserStateHandleAlloc();
-	Render_RasteriserState *rs = Render_RasteriserStateHandleToPtr(renderer->stockRasteriserState[stock]);
-
-	TheForge_AddRasterizerState(renderer->renderer, rasterizerStateDesc, &rs->state);
 	return renderer->stockRasteriserState[stock];
-
 }
 
 AL2O3_EXTERN_C Render_SamplerHandle Render_GetStockSampler(Render_RendererHandle renderer,
 																													 Render_StockSamplerType stock) {
-	if (Render_SamplerHandleIsValid(renderer->stockSamplers[stock])) {
-		return renderer->stockSamplers[stock];
-	}
-
-	TheForge_SamplerDesc const *samplerDesc;
-	switch (stock) {
-		case Render_SST_POINT: {
-			TheForge_SamplerDesc const desc{
-					TheForge_FT_NEAREST,
-					TheForge_FT_NEAREST,
-					TheForge_MM_NEAREST,
-					TheForge_AM_CLAMP_TO_EDGE,
-					TheForge_AM_CLAMP_TO_EDGE,
-					TheForge_AM_CLAMP_TO_EDGE,
-			};
-			samplerDesc = &desc;
-			break;
-		}
-		case Render_SST_LINEAR: {
-			TheForge_SamplerDesc const desc{
-					TheForge_FT_LINEAR,
-					TheForge_FT_LINEAR,
-					TheForge_MM_LINEAR,
-					TheForge_AM_CLAMP_TO_EDGE,
-					TheForge_AM_CLAMP_TO_EDGE,
-					TheForge_AM_CLAMP_TO_EDGE,
-			};
-			samplerDesc = &desc;
-			break;
-		}
-		default: ASSERT(false);
-			return {0};
+	ASSERT(stock < Render_SST_COUNT);
+	if (renderer->stockSamplers[stock].handle == 0) {
+		renderer->stockSamplers[stock] = Render_SamplerCreate(renderer, &StockSamplers[stock].desc);
 	}
-
-	renderer->stockSamplers[stock] = Render_SamplerHandleAlloc();
-	Render_Sampler* sampler = Render_SamplerHandleToPtr(renderer->stockSamplers[stock]);
-
-	TheForge_AddSampler(renderer->renderer, samplerDesc, &sampler->sampler);
 	return renderer->stockSamplers[stock];
 }
 
-
 AL2O3_EXTERN_C Render_VertexLayoutHandle Render_GetStockVertexLayout(Render_RendererHandle renderer,
 																																		 Render_StockVertexLayouts stock) {
-	if (renderer->stockVertexLayouts[stock] != nullptr) {
-		return renderer->stockVertexLayouts[stock];
+	ASSERT(stock < Render_SVL_COUNT);
+	if (renderer->stockVertexLayouts[stock] == nullptr) {
+		renderer->stockVertexLayouts[stock] = StockVertexLayouts[stock].layout;
+		Render_RendererRegisterVertexLayout(renderer, renderer->stockVertexLayouts[stock]);
 	}
-
-	static TheForge_VertexLayout const vertexLayout2DPackedColour{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 1, sizeof(float) * 2}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout2DFloatColour{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 1, sizeof(float) * 2}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout2DPackedColourUV{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 2},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 4}
-			}
-	};
-	static TheForge_VertexLayout const vertexLayout2DFloatColourUV{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 2},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 2, sizeof(float) * 4}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DPackedColour{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 1, sizeof(float) * 3}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DFloatColour{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 1, sizeof(float) * 3}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DPackedColourUV{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 5}
-			}
-	};
-	static TheForge_VertexLayout const vertexLayout3DFloatColourUV{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R32G32B32A32_SFLOAT, 0, 2, sizeof(float) * 5}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DNormal{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DNormalPackedColour{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
-					{TheForge_SS_COLOR, 5, "COLOR", TinyImageFormat_R8G8B8A8_UNORM, 0, 2, sizeof(float) * 6}
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DNormalUV{
-			3,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_NORMAL, 9, "NORMAL", TinyImageFormat_R32G32B32_SFLOAT, 0, 1, sizeof(float) * 3},
-					{TheForge_SS_TEXCOORD0, 10, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 2, sizeof(float) * 6},
-			}
-	};
-
-	static TheForge_VertexLayout const vertexLayout3DUV{
-			2,
-			{
-					{TheForge_SS_POSITION, 8, "POSITION", TinyImageFormat_R32G32B32_SFLOAT, 0, 0, 0},
-					{TheForge_SS_TEXCOORD0, 9, "TEXCOORD", TinyImageFormat_R32G32_SFLOAT, 0, 1, sizeof(float) * 3},
-			}
-	};
-
-
-	switch (stock) {
-		case Render_SVL_2D_COLOUR: renderer->stockVertexLayouts[stock] = &vertexLayout2DPackedColour;
-			break;
-		case Render_SVL_2D_FLOATCOLOUR: renderer->stockVertexLayouts[stock] = &vertexLayout2DFloatColour;
-			break;
-		case Render_SVL_2D_COLOUR_UV: renderer->stockVertexLayouts[stock] = &vertexLayout2DPackedColourUV;
-			break;
-		case Render_SVL_2D_FLOATCOLOUR_UV: renderer->stockVertexLayouts[stock] = &vertexLayout2DFloatColourUV;
-			break;
-		case Render_SVL_3D_COLOUR: renderer->stockVertexLayouts[stock] = &vertexLayout3DPackedColour;
-			break;
-		case Render_SVL_3D_FLOATCOLOUR: renderer->stockVertexLayouts[stock] = &vertexLayout3DFloatColour;
-			break;
-		case Render_SVL_3D_COLOUR_UV: renderer->stockVertexLayouts[stock] = &vertexLayout3DPackedColourUV;
-			break;
-		case Render_SVL_3D_FLOATCOLOUR_UV: renderer->stockVertexLayouts[stock] = &vertexLayout3DFloatColourUV;
-			break;
-		case Render_SVL_3D_NORMAL: renderer->stockVertexLayouts[stock] = &vertexLayout3DNormal;
-			break;
-		case Render_SVL_3D_NORMAL_COLOUR: renderer->stockVertexLayouts[stock] = &vertexLayout3DNormalPackedColour;
-			break;
-		case Render_SVL_3D_NORMAL_UV: renderer->stockVertexLayouts[stock] = &vertexLayout3DNormalUV;
-			break;
-		case Render_SVL_3D_UV: renderer->stockVertexLayouts[stock] = &vertexLayout3DUV;
-			break;
-		case Render_SVL_COUNT: ASSERT(false);
-			return nullptr;
-	}
-
 	return renderer->stockVertexLayouts[stock];
+}
 
-}
\ No newline at end of file
+AL2O3_EXTERN_C void Render_RendererPrewarmStock(Render_RendererHandle renderer) {
+	for (uint32_t i = 0; i < Render_SBS_COUNT; ++i) {
+		Render_GetStockBlendState(renderer, (Render_StockBlendStateType) i);
+	}
+	for (uint32_t i = 0; i < Render_SDS_COUNT; ++i) {
+		Render_GetStockDepthState(renderer, (Render_StockDepthStateType) i);
+	}
+	for (uint32_t i = 0; i < Render_SRS_COUNT; ++i) {
+		Render_GetStockRasterisationState(renderer, (Render_StockRasterState) i);
+	}
+	for (uint32_t i = 0; i < Render_SST_COUNT; ++i) {
+		Render_GetStockSampler(renderer, (Render_StockSamplerType) i);
+	}
+	for (uint32_t i = 0; i < Render_SVL_COUNT; ++i) {
+		Render_GetStockVertexLayout(renderer, (Render_StockVertexLayouts) i);
+	}
+}
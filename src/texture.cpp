@@ -5,6 +5,7 @@
 #include "render_basics/theforge/api.h"
 #include "render_basics/api.h"
 #include "render_basics/texture.h"
+#include "framebuffer.hpp"
 #include "render_basics/theforge/handlemanager.h"
 
 TheForge_DescriptorType Render_TextureUsageFlagsToDescriptorType(Render_TextureUsageFlags tuf) {
@@ -27,6 +28,8 @@ AL2O3_EXTERN_C Render_TextureHandle Render_TextureSyncCreate(Render_RendererHand
 		return {0};
 	}
 	Render_Texture* texture = Render_TextureHandleToPtr(handle);
+	texture->renderer = renderer;
+	texture->frameBuffer = {0};
 
 	// the forge has seperate textures and render targets, whereas we just define it via ROP_READ/WRITE
 	// split creation if ROP_WRITE is defined
@@ -133,7 +136,7 @@ AL2O3_EXTERN_C void Render_TextureSyncUpdate(Render_TextureHandle handle, Render
 			true
 	};
 
-	Render_Texture* texture = Render_TextureHandleToPtr(handle);
+	Render_Texture* texture = RenderTF_TextureAcquire(handle);
 
 	TheForge_TextureUpdateDesc updateDesc{
 			texture->texture,
@@ -141,24 +144,27 @@ AL2O3_EXTERN_C void Render_TextureSyncUpdate(Render_TextureHandle handle, Render
 	};
 
 	TheForge_UpdateTexture(&updateDesc, false);
+	if (texture->renderer) {
+		texture->renderer->resourceUpdateCount++;
+	}
 }
 
 
 AL2O3_EXTERN_C uint32_t Render_TextureGetWidth(Render_TextureHandle handle) {
-	return TheForge_TextureGetWidth(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetWidth(RenderTF_TextureAcquire(handle)->texture);
 }
 AL2O3_EXTERN_C uint32_t Render_TextureGetHeight(Render_TextureHandle handle) {
-	return TheForge_TextureGetHeight(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetHeight(RenderTF_TextureAcquire(handle)->texture);
 }
 AL2O3_EXTERN_C uint32_t Render_TextureGetDepth(Render_TextureHandle handle) {
-	return TheForge_TextureGetDepth(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetDepth(RenderTF_TextureAcquire(handle)->texture);
 }
 AL2O3_EXTERN_C uint32_t Render_TextureGetSliceCount(Render_TextureHandle handle) {
-	return TheForge_TextureGetArraySize(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetArraySize(RenderTF_TextureAcquire(handle)->texture);
 }
 AL2O3_EXTERN_C uint32_t Render_TextureGetMipLevelCount(Render_TextureHandle handle) {
-	return TheForge_TextureGetMipLevels(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetMipLevels(RenderTF_TextureAcquire(handle)->texture);
 }
 AL2O3_EXTERN_C TinyImageFormat Render_TextureGetFormat(Render_TextureHandle handle) {
-	return TheForge_TextureGetFormat(Render_TextureHandleToPtr(handle)->texture);
+	return TheForge_TextureGetFormat(RenderTF_TextureAcquire(handle)->texture);
 }
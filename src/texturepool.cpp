@@ -0,0 +1,182 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/api.h"
+#include "render_basics/theforge/texturepool.h"
+#include "texturepool.hpp"
+#include "hash.hpp"
+
+namespace {
+
+uint32_t const DefaultEvictionAge = 60;
+
+struct Entry {
+	uint64_t key;
+	Render_TextureCreateDesc desc; ///< compared on a key match, initialData and debugName aren't kept
+	Render_TextureHandle texture;
+	bool inUse;
+	uint64_t releaseFrame;       ///< renderer frame count when released
+	TheForge_FenceHandle fence;  ///< first submit after the release, not owned
+};
+
+} // end anon namespace
+
+struct RenderTF_TexturePool {
+	uint32_t evictionAge;
+	CADT_VectorHandle entries; // Entry, pools are small so lookups are linear
+};
+
+namespace {
+
+// the gpu has finished with a released texture once the next submit's fence has
+// signalled. Fences are reused every maxFramesAhead frames, by then the frame buffer
+// has waited on them so age alone is enough
+bool IsRetired(Render_RendererHandle renderer, Entry const &entry) {
+	if (renderer->frameCount - entry.releaseFrame > renderer->maxFramesAhead) {
+		return true;
+	}
+	if (!entry.fence) {
+		return false;
+	}
+	// waiting resets a fence to not submitted, so anything but incomplete has finished
+	TheForge_FenceStatus fenceStatus;
+	TheForge_GetFenceStatus(renderer->renderer, entry.fence, &fenceStatus);
+	return fenceStatus != TheForge_FS_INCOMPLETE;
+}
+
+// the key is a hash so a match still has to be checked
+bool DescsMatch(Render_TextureCreateDesc const *a, Render_TextureCreateDesc const *b) {
+	return a->format == b->format &&
+			a->width == b->width &&
+			a->height == b->height &&
+			a->depth == b->depth &&
+			a->slices == b->slices &&
+			a->mipLevels == b->mipLevels &&
+			a->sampleCount == b->sampleCount &&
+			a->sampleQuality == b->sampleQuality &&
+			a->usageflags == b->usageflags &&
+			memcmp(&a->renderTargetClearValue, &b->renderTargetClearValue, sizeof(a->renderTargetClearValue)) == 0;
+}
+
+// destroys released entries older than the eviction age or, when trimming, every one
+// the gpu is done with. Order isn't preserved
+void RemoveReleased(Render_RendererHandle renderer, RenderTF_TexturePool *pool, bool trim) {
+	uint64_t const maxAge = pool->evictionAge > renderer->maxFramesAhead ? pool->evictionAge : renderer->maxFramesAhead;
+	size_t i = 0;
+	while (i < CADT_VectorSize(pool->entries)) {
+		auto entries = (Entry *) CADT_VectorData(pool->entries);
+		bool const remove = !entries[i].inUse &&
+				(trim ? IsRetired(renderer, entries[i]) : renderer->frameCount - entries[i].releaseFrame > maxAge);
+		if (remove) {
+			Render_TextureDestroy(renderer, entries[i].texture);
+			size_t const last = CADT_VectorSize(pool->entries) - 1;
+			entries[i] = entries[last];
+			CADT_VectorResize(pool->entries, last);
+		} else {
+			++i;
+		}
+	}
+}
+
+} // end anon namespace
+
+RenderTF_TexturePool *RenderTF_TexturePoolCreate(Render_RendererHandle renderer) {
+	auto pool = (RenderTF_TexturePool *) MEMORY_CALLOC(1, sizeof(RenderTF_TexturePool));
+	if (!pool) {
+		return nullptr;
+	}
+	pool->evictionAge = DefaultEvictionAge;
+	pool->entries = CADT_VectorCreate(sizeof(Entry));
+	return pool;
+}
+
+void RenderTF_TexturePoolDestroy(Render_RendererHandle renderer, RenderTF_TexturePool *pool) {
+	if (!pool) {
+		return;
+	}
+	auto entries = (Entry *) CADT_VectorData(pool->entries);
+	for (size_t i = 0; i < CADT_VectorSize(pool->entries); ++i) {
+		if (entries[i].inUse) {
+			LOGWARNING("Transient texture still acquired at renderer destroy");
+		}
+		Render_TextureDestroy(renderer, entries[i].texture);
+	}
+	CADT_VectorDestroy(pool->entries);
+	MEMORY_FREE(pool);
+}
+
+uint64_t RenderTF_TextureDescKey(Render_TextureCreateDesc const *desc) {
+	uint64_t hash = RenderTF_HashU64(desc->format);
+	hash = RenderTF_HashU64(((uint64_t) desc->width << 32) | desc->height, hash);
+	hash = RenderTF_HashU64(((uint64_t) desc->depth << 32) | desc->slices, hash);
+	hash = RenderTF_HashU64(((uint64_t) desc->mipLevels << 32) | desc->sampleCount, hash);
+	hash = RenderTF_HashU64(((uint64_t) desc->sampleQuality << 32) | desc->usageflags, hash);
+	return RenderTF_Hash(&desc->renderTargetClearValue, sizeof(desc->renderTargetClearValue), hash);
+}
+
+void RenderTF_TexturePoolNewFrame(Render_RendererHandle renderer) {
+	RemoveReleased(renderer, renderer->texturePool, false);
+}
+
+void RenderTF_TexturePoolFrameSubmitted(Render_RendererHandle renderer, TheForge_FenceHandle fence) {
+	RenderTF_TexturePool *pool = renderer->texturePool;
+	auto entries = (Entry *) CADT_VectorData(pool->entries);
+	for (size_t i = 0; i < CADT_VectorSize(pool->entries); ++i) {
+		if (!entries[i].inUse && !entries[i].fence) {
+			entries[i].fence = fence;
+		}
+	}
+}
+
+AL2O3_EXTERN_C Render_TextureHandle Render_TextureAcquireTransient(Render_RendererHandle renderer,
+																																	 Render_TextureCreateDesc const *desc) {
+	ASSERT(desc->initialData == nullptr);
+	RenderTF_TexturePool *pool = renderer->texturePool;
+	uint64_t const key = RenderTF_TextureDescKey(desc);
+
+	auto entries = (Entry *) CADT_VectorData(pool->entries);
+	for (size_t i = 0; i < CADT_VectorSize(pool->entries); ++i) {
+		if (!entries[i].inUse && entries[i].key == key && DescsMatch(&entries[i].desc, desc) &&
+				IsRetired(renderer, entries[i])) {
+			entries[i].inUse = true;
+			return entries[i].texture;
+		}
+	}
+
+	Entry entry{key, *desc, Render_TextureSyncCreate(renderer, desc), true, 0, nullptr};
+	if (!Render_TextureHandleIsValid(entry.texture)) {
+		return {0};
+	}
+	entry.desc.initialData = nullptr;
+	entry.desc.debugName = nullptr;
+	CADT_VectorPushElement(pool->entries, (void *) &entry);
+	return entry.texture;
+}
+
+AL2O3_EXTERN_C void Render_TextureReleaseTransient(Render_RendererHandle renderer, Render_TextureHandle handle) {
+	if (!renderer || !Render_TextureHandleIsValid(handle)) {
+		return;
+	}
+	RenderTF_TexturePool *pool = renderer->texturePool;
+	auto entries = (Entry *) CADT_VectorData(pool->entries);
+	for (size_t i = 0; i < CADT_VectorSize(pool->entries); ++i) {
+		if (entries[i].inUse && entries[i].texture.handle == handle.handle) {
+			entries[i].inUse = false;
+			entries[i].releaseFrame = renderer->frameCount;
+			entries[i].fence = nullptr;
+			return;
+		}
+	}
+	LOGERROR("Render_TextureReleaseTransient called on a texture that isn't an acquired transient");
+}
+
+AL2O3_EXTERN_C void Render_TexturePoolSetEvictionAge(Render_RendererHandle renderer, uint32_t frames) {
+	renderer->texturePool->evictionAge = frames;
+}
+
+AL2O3_EXTERN_C void Render_TexturePoolTrim(Render_RendererHandle renderer) {
+	RemoveReleased(renderer, renderer->texturePool, true);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/texture.h"
+
+struct RenderTF_TexturePool *RenderTF_TexturePoolCreate(Render_RendererHandle renderer);
+void RenderTF_TexturePoolDestroy(Render_RendererHandle renderer, struct RenderTF_TexturePool *pool);
+
+// everything that makes two textures interchangeable
+uint64_t RenderTF_TextureDescKey(Render_TextureCreateDesc const *desc);
+
+// called by the renderer when the frame changes, evicts old released textures
+void RenderTF_TexturePoolNewFrame(Render_RendererHandle renderer);
+// called by every submit (frame buffer or Render_QueueSubmit) with its fence
+void RenderTF_TexturePoolFrameSubmitted(Render_RendererHandle renderer, TheForge_FenceHandle fence);
@@ -31,15 +31,9 @@ struct RenderTF_VisualDebug {
 	Render_PipelineHandle solidTriPipeline;
 
 	Render_DescriptorSetHandle descriptorSet;
-	Render_BufferHandle uniformBuffer;
 
 	Thread_Mutex addPrimMutex;
 
-	union {
-		Render_GpuView view;
-		uint8_t spacer[UNIFORM_BUFFER_MIN_SIZE];
-	} uniforms;
-
 	AL2O3_VisualDebugging_t backup;
 };
 
@@ -47,10 +41,13 @@ RenderTF_VisualDebug *RenderTF_VisualDebugCreate(Render_RendererHandle renderer,
 void RenderTF_VisualDebugDestroy(RenderTF_VisualDebug *vd);
 
 void RenderTF_VisualDebugRender(RenderTF_VisualDebug *vd, Render_GraphicsEncoderHandle encoder);
+// anything added since the last render
+bool RenderTF_VisualDebugHasPrimitives(RenderTF_VisualDebug *vd);
 
 bool RenderTF_PlatonicSolidsCreate(RenderTF_VisualDebug* vd);
 void RenderTF_PlatonicSolidsDestroy(RenderTF_VisualDebug* vd);
 void RenderTF_PlatonicSolidsRender(RenderTF_VisualDebug *vd, Render_GraphicsEncoderHandle encoder);
+bool RenderTF_PlatonicSolidsHasInstances(RenderTF_VisualDebug const *vd);
 void RenderTF_PlatonicSolidsAddTetrahedron(RenderTF_VisualDebug* vd, Math_Mat4F transform);
 void RenderTF_PlatonicSolidsAddCube(RenderTF_VisualDebug* vd, Math_Mat4F transform);
 void RenderTF_PlatonicSolidsAddOctahedron(RenderTF_VisualDebug* vd, Math_Mat4F transform);
@@ -4,6 +4,7 @@
 #include "al2o3_thread/thread.hpp"
 #include "render_basics/theforge/api.h"
 #include "render_basics/theforge/handlemanager.h"
+#include "render_basics/theforge/latelatch.h"
 #include "render_basics/buffer.h"
 #include "render_basics/descriptorset.h"
 #include "render_basics/framebuffer.h"
@@ -11,6 +12,7 @@
 #include "render_basics/pipeline.h"
 #include "render_basics/rootsignature.h"
 #include "visdebug.hpp"
+#include "embeddedshaders.hpp"
 #include <cstdint>
 
 namespace {
@@ -22,58 +24,7 @@ struct Vertex {
 RenderTF_VisualDebug *currentTarget = nullptr;
 
 static bool CreateShaders(RenderTF_VisualDebug *vd) {
-	static char const *const VertexShader = "cbuffer uniformBlock : register(b0, space1)\n"
-																					"{\n"
-																					"\tfloat4x4 worldToViewMatrix;\n"
-																					"\tfloat4x4 viewToNDCMatrix;\n"
-																					"\tfloat4x4 worldToNDCMatrix;\n"
-																					"};\n"
-																					"struct VSInput\n"
-																					"{\n"
-																					"\tfloat4 Position : POSITION;\n"
-																					"\tfloat4 Colour   : COLOR;\n"
-																					"};\n"
-																					"\n"
-																					"struct VSOutput {\n"
-																					"\tfloat4 Position : SV_POSITION;\n"
-																					"\tfloat4 Colour   : COLOR;\n"
-																					"};\n"
-																					"\n"
-																					"VSOutput VS_main(VSInput input)\n"
-																					"{\n"
-																					"    VSOutput result;\n"
-																					"\n"
-																					"\tresult.Position = mul(worldToNDCMatrix, input.Position);\n"
-																					"\tresult.Colour = input.Colour;\n"
-																					"\treturn result;\n"
-																					"}";
-
-	static char const *const FragmentShader = "struct FSInput {\n"
-																						"\tfloat4 Position : SV_POSITION;\n"
-																						"\tfloat4 Colour   : COLOR;\n"
-																						"};\n"
-																						"\n"
-																						"float4 FS_main(FSInput input) : SV_Target\n"
-																						"{\n"
-																						"\treturn input.Colour;\n"
-																						"}\n";
-
-	static char const *const vertEntryPoint = "VS_main";
-	static char const *const fragEntryPoint = "FS_main";
-
-	VFile_Handle vfile = VFile_FromMemory(VertexShader, strlen(VertexShader) + 1, false);
-	if (!vfile) {
-		return false;
-	}
-	VFile_Handle ffile = VFile_FromMemory(FragmentShader, strlen(FragmentShader) + 1, false);
-	if (!ffile) {
-		VFile_Close(vfile);
-		return false;
-	}
-	vd->shader = Render_CreateShaderFromVFile(vd->renderer, vfile, "VS_main", ffile,"FS_main");
-
-	VFile_Close(vfile);
-	VFile_Close(ffile);
+	vd->shader = RenderTF_ShaderCreateEmbedded(vd->renderer, "visualdebug_vertex", "copycolour_fragment");
 
 	return Render_ShaderHandleIsValid(vd->shader);
 }
@@ -430,21 +381,13 @@ RenderTF_VisualDebug *RenderTF_VisualDebugCreate(Render_RendererHandle renderer,
 		return nullptr;
 	}
 
-	static Render_BufferUniformDesc const ubDesc{
-			sizeof(vd->uniforms),
-			true
-	};
-
-	vd->uniformBuffer = Render_BufferCreateUniform(vd->renderer, &ubDesc);
-	if (!Render_BufferHandleIsValid(vd->uniformBuffer)) {
-		return nullptr;
-	}
+	// the view is the frame buffers late latched constants, written just before submit
 	Render_DescriptorDesc params[1];
 	params[0].name = "uniformBlock";
 	params[0].type = Render_DT_BUFFER;
-	params[0].buffer = vd->uniformBuffer;
+	params[0].buffer = Render_FrameBufferViewConstants(vd->target);
 	params[0].offset = 0;
-	params[0].size = sizeof(vd->uniforms);
+	params[0].size = sizeof(Render_GpuView);
 	Render_DescriptorPresetFrequencyUpdated(vd->descriptorSet, 0, 1, params);
 
 	if(!RenderTF_PlatonicSolidsCreate(vd)){
@@ -474,9 +417,6 @@ RenderTF_VisualDebug *RenderTF_VisualDebugCreate(Render_RendererHandle renderer,
 void RenderTF_VisualDebugDestroy(RenderTF_VisualDebug *vd) {
 	RenderTF_PlatonicSolidsDestroy(vd);
 
-	if (Render_BufferHandleIsValid(vd->uniformBuffer)) {
-		Render_BufferDestroy(vd->renderer, vd->uniformBuffer);
-	}
 	if (Render_DescriptorSetHandleIsValid(vd->descriptorSet)) {
 		Render_DescriptorSetDestroy(vd->renderer, vd->descriptorSet);
 	}
@@ -524,17 +464,6 @@ void RenderTF_VisualDebugRender(RenderTF_VisualDebug *vd, Render_GraphicsEncoder
 
 	Thread::MutexLock lock(&vd->addPrimMutex);
 
-	Render_FrameBuffer const *fb = Render_FrameBufferHandleToPtr(vd->target);
-
-	// upload the uniforms
-	memcpy(&vd->uniforms, fb->debugGpuView, sizeof(Render_GpuView));
-	Render_BufferUpdateDesc uniformUpdate = {
-			&vd->uniforms,
-			0,
-			sizeof(vd->uniforms)
-	};
-	Render_BufferUpload(vd->uniformBuffer, &uniformUpdate);
-
 	RenderTF_PlatonicSolidsRender(vd, encoder);
 
 	if (CADT_VectorSize(vd->vertexData) == 0) {
@@ -631,4 +560,9 @@ void RenderTF_VisualDebugRender(RenderTF_VisualDebug *vd, Render_GraphicsEncoder
 
 	CADT_VectorResize(vd->vertexData, 0);
 
-}
\ No newline at end of file
+}
+
+bool RenderTF_VisualDebugHasPrimitives(RenderTF_VisualDebug *vd) {
+	Thread::MutexLock lock(&vd->addPrimMutex);
+	return CADT_VectorSize(vd->vertexData) != 0 || RenderTF_PlatonicSolidsHasInstances(vd);
+}
@@ -0,0 +1,158 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "../src/framegraphcompile.hpp"
+
+namespace {
+
+uint32_t const READ = 0x1;
+uint32_t const WRITE = 0x2;
+uint32_t const UNORDERED = 0x4;
+
+// compiled output is big, keep it off the stack
+RenderTF_FrameGraphCompiled compiled;
+
+void Access(RenderTF_FrameGraphPassDecl &pass, uint32_t resource, uint32_t state, bool write) {
+	pass.accesses[pass.accessCount++] = RenderTF_FrameGraphAccess{resource, state, write};
+}
+
+bool PassBarrier(uint32_t orderedPass, uint32_t resource, uint32_t state) {
+	for (uint32_t b = compiled.barrierStart[orderedPass]; b < compiled.barrierStart[orderedPass + 1]; ++b) {
+		if (compiled.barriers[b].resource == resource && compiled.barriers[b].state == state) {
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t PassBarrierCount(uint32_t orderedPass) {
+	return compiled.barrierStart[orderedPass + 1] - compiled.barrierStart[orderedPass];
+}
+
+} // end anon namespace
+
+TEST_CASE("Frame graph culls passes that don't reach an output", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[3] = {};
+	resources[0].transient = true;
+	resources[1].transient = true;
+	resources[2].output = true;
+
+	RenderTF_FrameGraphPassDecl passes[3] = {};
+	Access(passes[0], 0, WRITE, true);
+	Access(passes[1], 1, WRITE, true);  // nothing reads resource 1
+	Access(passes[2], 0, READ, false);
+	Access(passes[2], 2, WRITE, true);
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 3, resources, 3, &compiled));
+	REQUIRE(compiled.passCount == 2);
+	REQUIRE(compiled.passes[0] == 0);
+	REQUIRE(compiled.passes[1] == 2);
+	REQUIRE(compiled.aliasSlot[1] == RENDERTF_FRAMEGRAPH_NO_SLOT);
+}
+
+TEST_CASE("Frame graph keeps side effect passes and their inputs", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[1] = {};
+	resources[0].transient = true;
+
+	RenderTF_FrameGraphPassDecl passes[2] = {};
+	Access(passes[0], 0, WRITE, true);
+	Access(passes[1], 0, READ, false);
+	passes[1].sideEffects = true;
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 2, resources, 1, &compiled));
+	REQUIRE(compiled.passCount == 2);
+}
+
+TEST_CASE("Frame graph only emits barriers on state changes", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[2] = {};
+	resources[0].initialState = READ;
+	resources[1].output = true;
+	resources[1].initialState = WRITE;
+
+	RenderTF_FrameGraphPassDecl passes[2] = {};
+	Access(passes[0], 0, READ, false);
+	Access(passes[0], 1, WRITE, true);
+	Access(passes[1], 0, READ, false);
+	Access(passes[1], 1, READ, false);
+	Access(passes[1], 1, WRITE, true);
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 2, resources, 2, &compiled));
+	REQUIRE(compiled.passCount == 2);
+	// both imported resources are already in the right state
+	REQUIRE(PassBarrierCount(0) == 0);
+	// read + write of the same resource in one pass is a single combined barrier
+	REQUIRE(PassBarrierCount(1) == 1);
+	REQUIRE(PassBarrier(1, 1, READ | WRITE));
+	REQUIRE(compiled.finalState[1] == (READ | WRITE));
+}
+
+TEST_CASE("Frame graph barriers unordered writes without a state change", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[1] = {};
+	resources[0].output = true;
+	resources[0].initialState = UNORDERED;
+	resources[0].unorderedState = UNORDERED;
+
+	RenderTF_FrameGraphPassDecl passes[2] = {};
+	Access(passes[0], 0, UNORDERED, true);
+	Access(passes[1], 0, UNORDERED, false);
+	Access(passes[1], 0, UNORDERED, true);
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 2, resources, 1, &compiled));
+	REQUIRE(PassBarrierCount(0) == 0);
+	REQUIRE(PassBarrier(1, 0, UNORDERED));
+}
+
+TEST_CASE("Frame graph aliases transients with disjoint lifetimes", "[render_basics_impl_theforge framegraph]") {
+	// a post chain: 0 -> 1 -> 2 -> 3 (output), 0 and 2 can share, 1 has a different desc
+	RenderTF_FrameGraphResourceDecl resources[4] = {};
+	resources[0].transient = true;
+	resources[0].aliasKey = 1;
+	resources[1].transient = true;
+	resources[1].aliasKey = 2;
+	resources[2].transient = true;
+	resources[2].aliasKey = 1;
+	resources[3].output = true;
+
+	RenderTF_FrameGraphPassDecl passes[4] = {};
+	Access(passes[0], 0, WRITE, true);
+	Access(passes[1], 0, READ, false);
+	Access(passes[1], 1, WRITE, true);
+	Access(passes[2], 1, READ, false);
+	Access(passes[2], 2, WRITE, true);
+	Access(passes[3], 2, READ, false);
+	Access(passes[3], 3, WRITE, true);
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 4, resources, 4, &compiled));
+	REQUIRE(compiled.passCount == 4);
+	REQUIRE(compiled.aliasSlotCount == 2);
+	REQUIRE(compiled.aliasSlot[0] == compiled.aliasSlot[2]);
+	REQUIRE(compiled.aliasSlot[1] != compiled.aliasSlot[0]);
+	REQUIRE(compiled.aliasSlot[3] == RENDERTF_FRAMEGRAPH_NO_SLOT);
+	// a reused transient always starts with a barrier as its contents are undefined
+	REQUIRE(PassBarrier(2, 2, WRITE));
+}
+
+TEST_CASE("Frame graph doesn't alias overlapping transients", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[3] = {};
+	resources[0].transient = true;
+	resources[1].transient = true;
+	resources[2].output = true;
+
+	RenderTF_FrameGraphPassDecl passes[3] = {};
+	Access(passes[0], 0, WRITE, true);
+	Access(passes[1], 1, WRITE, true);
+	Access(passes[2], 0, READ, false);
+	Access(passes[2], 1, READ, false);
+	Access(passes[2], 2, WRITE, true);
+
+	REQUIRE(RenderTF_FrameGraphCompile(passes, 3, resources, 3, &compiled));
+	REQUIRE(compiled.aliasSlotCount == 2);
+	REQUIRE(compiled.aliasSlot[0] != compiled.aliasSlot[1]);
+}
+
+TEST_CASE("Frame graph rejects invalid declarations", "[render_basics_impl_theforge framegraph]") {
+	RenderTF_FrameGraphResourceDecl resources[1] = {};
+	RenderTF_FrameGraphPassDecl passes[1] = {};
+	Access(passes[0], 1, WRITE, true);
+
+	REQUIRE_FALSE(RenderTF_FrameGraphCompile(passes, 1, resources, 1, &compiled));
+}
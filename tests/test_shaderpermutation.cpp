@@ -0,0 +1,153 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_thread/thread.h"
+#include "al2o3_vfile/vfile.h"
+#include "render_basics/theforge/api.h"
+#include "render_basics/theforge/handlemanager.h"
+#include "render_basics/shader.h"
+#include "../src/shader.hpp"
+
+namespace {
+
+uint32_t const ThreadCount = 4;
+uint32_t const KeyCount = 32;
+
+char const Source[] =
+		"float4 main() : SV_Target {\n"
+		"	return float4(RED / 7.0, GREEN / 3.0, 0.0, USE_ALPHA ? 0.5 : 1.0);\n"
+		"}\n";
+
+Render_ShaderPermutationDefine const Defines[] = {
+		{"RED", 3},
+		{"GREEN", 2},
+		{"USE_ALPHA", 1},
+};
+
+struct Worker {
+	Render_ShaderPermutationSetHandle sets[2];
+	uint32_t index;
+	Render_ShaderObjectHandle objects[KeyCount];
+};
+
+// every thread asks for every key in a different order, alternating between two sets of
+// the same source, so the same permutation is wanted by several threads at once
+void PermutationWorker(void *data) {
+	auto worker = (Worker *) data;
+	for (uint32_t i = 0; i < KeyCount; ++i) {
+		uint32_t const key = (i * 7 + worker->index * 5) % KeyCount;
+		worker->objects[key] = Render_ShaderPermutationGet(worker->sets[(i + worker->index) & 1], key);
+	}
+}
+
+Render_ShaderPermutationSetHandle CreateSet(Render_RendererHandle renderer) {
+	VFile_Handle file = VFile_FromMemory((void *) Source, sizeof(Source), false);
+	REQUIRE(file);
+
+	Render_ShaderPermutationSetDesc desc{};
+	desc.shader.shaderType = Render_ST_FRAGMENTSHADER;
+	desc.shader.file = file;
+	desc.shader.entryPoint = "main";
+	desc.defineCount = sizeof(Defines) / sizeof(Defines[0]);
+	desc.defines = Defines;
+	Render_ShaderPermutationSetHandle set = Render_ShaderPermutationSetCreate(renderer, &desc);
+	VFile_Close(file);
+	return set;
+}
+
+} // end anon namespace
+
+// key packing is cpu only, a zeroed set is enough
+TEST_CASE("Shader permutation defines pack from bit 0", "[render_basics_impl_theforge shaderpermutation]") {
+	Render_ShaderPermutationDefine const defines[] = {
+			{"A", 1},
+			{"B", 3},
+			{"C", 2},
+	};
+	Render_ShaderPermutationSet set{};
+	REQUIRE(RenderTF_ShaderPermutationPackDefines(&set, 3, defines));
+	REQUIRE(set.defineCount == 3);
+	REQUIRE(set.defines[0].shift == 0);
+	REQUIRE(set.defines[1].shift == 1);
+	REQUIRE(set.defines[2].shift == 4);
+	REQUIRE(set.defines[1].mask == 0x7);
+
+	uint64_t key = 0;
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 0, 1);
+	REQUIRE(key == 0x1);
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 1, 5);
+	REQUIRE(key == 0xB);
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 2, 3);
+	REQUIRE(key == 0x3B);
+	// replacing a value leaves its neighbours alone
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 1, 2);
+	REQUIRE(key == 0x35);
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 0, 0);
+	REQUIRE(key == 0x34);
+}
+
+TEST_CASE("Shader permutation defines fit in 64 bits", "[render_basics_impl_theforge shaderpermutation]") {
+	Render_ShaderPermutationSet set{};
+
+	Render_ShaderPermutationDefine const full[] = {{"LOW", 32}, {"HIGH", 32}};
+	REQUIRE(RenderTF_ShaderPermutationPackDefines(&set, 2, full));
+	uint64_t key = Render_ShaderPermutationSetKeyValue(&set, 0, 1, 0xFFFFFFFFu);
+	REQUIRE(key == 0xFFFFFFFF00000000ull);
+	key = Render_ShaderPermutationSetKeyValue(&set, key, 0, 0x12345678u);
+	REQUIRE(key == 0xFFFFFFFF12345678ull);
+
+	Render_ShaderPermutationDefine const overflow[] = {{"LOW", 32}, {"HIGH", 32}, {"EXTRA", 1}};
+	REQUIRE_FALSE(RenderTF_ShaderPermutationPackDefines(&set, 3, overflow));
+
+	Render_ShaderPermutationDefine const empty[] = {{"NONE", 0}};
+	REQUIRE_FALSE(RenderTF_ShaderPermutationPackDefines(&set, 1, empty));
+	Render_ShaderPermutationDefine const wide[] = {{"WIDE", 33}};
+	REQUIRE_FALSE(RenderTF_ShaderPermutationPackDefines(&set, 1, wide));
+}
+
+// needs a device, the shader compiler is shared by the whole renderer
+TEST_CASE("Shader permutations compile concurrently", "[render_basics_impl_theforge shaderpermutation]") {
+	Render_RendererHandle renderer = Render_RendererCreate(nullptr);
+	REQUIRE(renderer);
+
+	Render_ShaderPermutationSetHandle sets[2] = {CreateSet(renderer), CreateSet(renderer)};
+	REQUIRE(sets[0]);
+	REQUIRE(sets[1]);
+
+	Worker workers[ThreadCount] = {};
+	Thread_Thread threads[ThreadCount];
+	uint32_t threadsStarted = 0;
+	for (uint32_t i = 0; i < ThreadCount; ++i) {
+		workers[i].sets[0] = sets[0];
+		workers[i].sets[1] = sets[1];
+		workers[i].index = i;
+		if (i == 0) {
+			continue;
+		}
+		REQUIRE(Thread_ThreadCreate(&threads[i], &PermutationWorker, &workers[i]));
+		threadsStarted++;
+	}
+	// the calling thread works as well
+	PermutationWorker(&workers[0]);
+	for (uint32_t i = 1; i <= threadsStarted; ++i) {
+		Thread_ThreadJoin(&threads[i]);
+		Thread_ThreadDestroy(&threads[i]);
+	}
+
+	// one compiled object per key, shared by both sets and every thread
+	for (uint32_t key = 0; key < KeyCount; ++key) {
+		REQUIRE(Render_ShaderObjectHandleIsValid(workers[0].objects[key]));
+		for (uint32_t i = 1; i < ThreadCount; ++i) {
+			REQUIRE(workers[i].objects[key].handle == workers[0].objects[key].handle);
+		}
+	}
+
+	// the other set still references every permutation
+	Render_ShaderPermutationSetDestroy(renderer, sets[0]);
+	for (uint32_t key = 0; key < KeyCount; ++key) {
+		REQUIRE(Render_ShaderObjectHandleIsValid(workers[0].objects[key]));
+		REQUIRE(Render_ShaderPermutationGet(sets[1], key).handle == workers[0].objects[key].handle);
+	}
+	Render_ShaderPermutationSetDestroy(renderer, sets[1]);
+
+	Render_RendererDestroy(renderer);
+}